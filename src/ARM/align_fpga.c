@@ -20,6 +20,18 @@
 #define OUT_SCORES_AXIDMA_ID XPAR_AXI_DMA_3_DEVICE_ID
 #define ALIGN_ID             XPAR_ALIGN_0_DEVICE_ID
 
+// Number of buffer descriptors in the scatter-gather ring of each channel,
+// and the maximal number of rows and scores covered by one batch.
+#define SG_BDS_PER_CHANNEL   1024
+#define SG_MAX_ROWS          SG_BDS_PER_CHANNEL
+#define SG_MAX_SCORES        (1u << 20)
+
+
+// Buffer descriptor memory. The DMA driver flushes/invalidates
+// descriptors itself, so these may live in cached memory.
+static u8 sg_bd_space[DMA_NUM_CHANNELS][SG_BDS_PER_CHANNEL * XAXIDMA_BD_MINIMUM_ALIGNMENT]
+	__attribute__((aligned(XAXIDMA_BD_MINIMUM_ALIGNMENT)));
+
 
 static void init_align(XAlign *instance, u32 device_id)
 {
@@ -35,7 +47,72 @@ static void init_axidma(XAxiDma *instance, u32 device_id)
 	XAxiDma_IntrDisable(instance, XAXIDMA_IRQ_ALL_MASK, XAXIDMA_DMA_TO_DEVICE);
 }
 
-void init_align_system(AlignSystem *align_sys, score_type scoring_offset, score_type gap_penalty)
+static XAxiDma *channel_axidma(AlignSystem *align_sys, DmaChannel chan)
+{
+	switch (chan) {
+	case DMA_CHAN_VER:        return &align_sys->ver_axidma;
+	case DMA_CHAN_HOR:        return &align_sys->hor_axidma;
+	case DMA_CHAN_HOR_SIZES:  return &align_sys->hor_sizes_axidma;
+	case DMA_CHAN_OUT_SCORES: return &align_sys->out_scores_axidma;
+	default:                  return NULL;
+	}
+}
+
+// Only the output channel moves data from the device to memory
+static XAxiDma_BdRing *channel_bd_ring(AlignSystem *align_sys, DmaChannel chan)
+{
+	XAxiDma *axidma = channel_axidma(align_sys, chan);
+	return chan == DMA_CHAN_OUT_SCORES ? XAxiDma_GetRxRing(axidma) : XAxiDma_GetTxRing(axidma);
+}
+
+static bool init_sg_ring(XAxiDma_BdRing *bd_ring, void *bd_space, size_t bd_space_size)
+{
+	u32 bd_count = XAxiDma_BdRingCntCalc(XAXIDMA_BD_MINIMUM_ALIGNMENT, bd_space_size);
+
+	int status = XAxiDma_BdRingCreate(
+		bd_ring,
+		(UINTPTR)bd_space,
+		(UINTPTR)bd_space,
+		XAXIDMA_BD_MINIMUM_ALIGNMENT,
+		bd_count
+	);
+
+	if (status != XST_SUCCESS) {
+		return false;
+	}
+
+	XAxiDma_Bd template_bd;
+	XAxiDma_BdClear(&template_bd);
+
+	if (XAxiDma_BdRingClone(bd_ring, &template_bd) != XST_SUCCESS) {
+		return false;
+	}
+
+	return XAxiDma_BdRingStart(bd_ring) == XST_SUCCESS;
+}
+
+// Scatter-gather is used only if every DMA engine was built with it.
+static bool init_sg(AlignSystem *align_sys)
+{
+	for (int chan = 0; chan < DMA_NUM_CHANNELS; chan++) {
+		if (!XAxiDma_HasSg(channel_axidma(align_sys, chan))) {
+			return false;
+		}
+	}
+
+	for (int chan = 0; chan < DMA_NUM_CHANNELS; chan++) {
+		align_sys->sg_pending[chan] = 0;
+
+		if (!init_sg_ring(channel_bd_ring(align_sys, chan), sg_bd_space[chan], sizeof sg_bd_space[chan])) {
+			printf("*** could not set up scatter-gather ring #%d\r\n", chan);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void init_align_system(AlignSystem *align_sys, score_type scoring_offset, score_type gap_penalty, index_type band_width)
 {
 	init_align (&align_sys->align,             ALIGN_ID);
 	init_axidma(&align_sys->ver_axidma,        VER_AXIDMA_ID);
@@ -45,6 +122,10 @@ void init_align_system(AlignSystem *align_sys, score_type scoring_offset, score_
 
 	XAlign_Set_scoring_offset(&align_sys->align, scoring_offset);
 	XAlign_Set_gap_penalty   (&align_sys->align, gap_penalty);
+	XAlign_Set_band_width    (&align_sys->align, band_width);
+
+	align_sys->use_sg = init_sg(align_sys);
+	align_sys->sg_error = false;
 }
 
 static void flush_cache(const void *addr, size_t elem_size, size_t num_elems)
@@ -99,6 +180,110 @@ static XTime get_time(void)
 	return t;
 }
 
+// Program the core for one row and start it. Also accumulates the time
+// the core spent idle since the previous row was found to be finished,
+// which is the per-row overhead of driving the core from the CPU.
+static void start_core(AlignSystem *align_sys, index_type len_ver, seq_count_type num_seqs_hor)
+{
+	XAlign_Set_stream_size_ver(&align_sys->align, len_ver);
+	XAlign_Set_num_streams_hor(&align_sys->align, num_seqs_hor);
+	XAlign_Start(&align_sys->align);
+
+	if (align_sys->core_idle_since != 0) {
+		align_sys->core_idle_t += get_time() - align_sys->core_idle_since;
+		align_sys->core_idle_rows++;
+	}
+}
+
+/*
+ * Scatter-gather backend of dma_batch_run()
+ */
+
+static bool sg_submit(void *ctx, DmaChannel chan, const DmaRing *ring)
+{
+	AlignSystem *align_sys = ctx;
+	XAxiDma_BdRing *bd_ring = channel_bd_ring(align_sys, chan);
+	bool to_device = chan != DMA_CHAN_OUT_SCORES;
+	XAxiDma_Bd *first_bd = NULL;
+
+	if (XAxiDma_BdRingAlloc(bd_ring, ring->count, &first_bd) != XST_SUCCESS) {
+		return false;
+	}
+
+	XAxiDma_Bd *bd = first_bd;
+
+	for (size_t k = 0; k < ring->count; k++) {
+		const DmaDesc *desc = &ring->descs[k];
+		u32 ctrl = 0;
+
+		if (to_device && (desc->flags & DMA_DESC_SOF)) {
+			ctrl |= XAXIDMA_BD_CTRL_TXSOF_MASK;
+		}
+
+		if (to_device && (desc->flags & DMA_DESC_EOF)) {
+			ctrl |= XAXIDMA_BD_CTRL_TXEOF_MASK;
+		}
+
+		XAxiDma_BdSetBufAddr(bd, desc->addr);
+		XAxiDma_BdSetLength(bd, desc->length, bd_ring->MaxTransferLen);
+		XAxiDma_BdSetCtrl(bd, ctrl);
+		XAxiDma_BdSetId(bd, desc->addr);
+
+		bd = (XAxiDma_Bd *)XAxiDma_BdRingNext(bd_ring, bd);
+	}
+
+	if (XAxiDma_BdRingToHw(bd_ring, ring->count, first_bd) != XST_SUCCESS) {
+		XAxiDma_BdRingUnAlloc(bd_ring, ring->count, first_bd);
+		return false;
+	}
+
+	align_sys->sg_pending[chan] += ring->count;
+	return true;
+}
+
+static bool sg_channel_busy(void *ctx, DmaChannel chan)
+{
+	AlignSystem *align_sys = ctx;
+	XAxiDma_BdRing *bd_ring = channel_bd_ring(align_sys, chan);
+	XAxiDma_Bd *bd = NULL;
+	int num_done = XAxiDma_BdRingFromHw(bd_ring, XAXIDMA_ALL_BDS, &bd);
+
+	if (num_done > 0) {
+		XAxiDma_Bd *cur = bd;
+
+		for (int k = 0; k < num_done; k++) {
+			if (XAxiDma_BdGetSts(cur) & XAXIDMA_BD_STS_ALL_ERR_MASK) {
+				align_sys->sg_error = true;
+			}
+
+			cur = (XAxiDma_Bd *)XAxiDma_BdRingNext(bd_ring, cur);
+		}
+
+		XAxiDma_BdRingFree(bd_ring, num_done, bd);
+		align_sys->sg_pending[chan] -= num_done;
+	}
+
+	return align_sys->sg_pending[chan] > 0;
+}
+
+static void sg_start_row(void *ctx, const DmaRowArgs *args)
+{
+	start_core(ctx, args->stream_size_ver, args->num_streams_hor);
+}
+
+static bool sg_core_busy(void *ctx)
+{
+	AlignSystem *align_sys = ctx;
+
+	// ap_idle, unlike ap_done, is not cleared on read
+	if (XAlign_IsIdle(&align_sys->align)) {
+		align_sys->core_idle_since = get_time();
+		return false;
+	}
+
+	return true;
+}
+
 size_t total_seq_len(const index_type *seq_lens, seq_count_type num_seqs)
 {
 	size_t len = 0;
@@ -110,37 +295,238 @@ size_t total_seq_len(const index_type *seq_lens, seq_count_type num_seqs)
 	return len;
 }
 
+// Align a row using one simple (non-scatter-gather) transfer per channel.
+// The caller is responsible for the coherence of the score buffer.
+static bool align_row_simple(AlignSystem *align_sys, const DmaRow *row, XTime *delta_t)
+{
+	// Actually send the data
+	u32 status = XST_SUCCESS;
+
+#define CHECK(str) do { if (status != XST_SUCCESS) { printf("%s: status = %lu\r\n", str, status); return false; } } while (0)
+
+	status = axidma_write(
+		&align_sys->ver_axidma,
+		row->seq_ver,
+		sizeof row->seq_ver[0],
+		row->len_ver
+	);
+	CHECK("vertical sequence data");
+
+	status = axidma_write(
+		&align_sys->hor_axidma,
+		row->seqs_hor,
+		sizeof row->seqs_hor[0],
+		row->len_hor
+	);
+	CHECK("horizontal sequence data");
+
+	status = axidma_write(
+		&align_sys->hor_sizes_axidma,
+		row->lens_hor,
+		sizeof row->lens_hor[0],
+		row->num_hor
+	);
+	CHECK("horizontal sequence lengths");
+
+	status = axidma_read(
+		&align_sys->out_scores_axidma,
+		row->out_scores,
+		sizeof row->out_scores[0],
+		row->num_hor
+	);
+	CHECK("out scores");
+
+#undef CHECK
+
+	// Set stream lengths and start alignment block
+	start_core(align_sys, row->len_ver, row->num_hor);
+
+	// Wait for them to finish using polling.
+	// Measure the elapsed time.
+	XTime t_begin = get_time();
+
+	while (
+	     axidma_busy_writing(&align_sys->ver_axidma)
+	  || axidma_busy_writing(&align_sys->hor_axidma)
+	  || axidma_busy_writing(&align_sys->hor_sizes_axidma)
+	  || axidma_busy_reading(&align_sys->out_scores_axidma)
+	  || align_busy(&align_sys->align)
+	) {
+		// NOP
+	}
+
+	XTime t_end = get_time();
+	*delta_t += t_end - t_begin;
+	align_sys->core_idle_since = t_end;
+
+	return true;
+}
+
+// Run every row of a scatter-gather batch. Returns false on error.
+static bool run_batch(AlignSystem *align_sys, const DmaBatch *batch, XTime *delta_t)
+{
+	const DmaBackend backend = {
+		.ctx = align_sys,
+		.submit = sg_submit,
+		.channel_busy = sg_channel_busy,
+		.start_row = sg_start_row,
+		.core_busy = sg_core_busy,
+	};
+
+	XTime t_begin = get_time();
+	bool ok = dma_batch_run(&backend, batch);
+	XTime t_end = get_time();
+
+	*delta_t += t_end - t_begin;
+
+	if (!ok || align_sys->sg_error) {
+		printf("scatter-gather batch: transfer failed\r\n");
+		return false;
+	}
+
+	return true;
+}
+
+// Run as many rows as fit into one scatter-gather batch, starting at 'first_row'.
+// Returns the number of rows processed, or 0 on error.
+static size_t align_rows_sg(
+	AlignSystem *align_sys,
+	DmaBatch *batch,
+	const Sequences *seqs,
+	seq_count_type first_row,
+	const Dihedral *seq_ver,
+	score_type *out_scores,
+	XTime *delta_t
+)
+{
+	size_t num_rows = dma_batch_build(batch, seqs, first_row, seq_ver, out_scores);
+
+	if (num_rows == 0) {
+		printf("row %" PRIu32 " does not fit into the descriptor rings\r\n", first_row);
+		return 0;
+	}
+
+	invalidate_cache(out_scores, sizeof out_scores[0], batch->num_scores);
+
+	return run_batch(align_sys, batch, delta_t) ? num_rows : 0;
+}
+
+// Run the rows queued by queue_row(), if any
+static bool flush_rows(AlignSystem *align_sys, DmaBatch *batch, XTime *delta_t)
+{
+	if (!align_sys->use_sg || batch->num_rows == 0) {
+		return true;
+	}
+
+	bool ok = run_batch(align_sys, batch, delta_t);
+	dma_batch_clear(batch);
+	return ok;
+}
+
+// Align a row right away using simple transfers, or queue it into the
+// scatter-gather batch, which is run whenever it is full, and by flush_rows().
+static bool queue_row(AlignSystem *align_sys, DmaBatch *batch, const DmaRow *row, XTime *delta_t)
+{
+	if (!align_sys->use_sg) {
+		return align_row_simple(align_sys, row, delta_t);
+	}
+
+	if (dma_batch_add_row(batch, row)) {
+		return true;
+	}
+
+	if (!flush_rows(align_sys, batch, delta_t)) {
+		return false;
+	}
+
+	if (dma_batch_add_row(batch, row)) {
+		return true;
+	}
+
+	printf("row does not fit into the descriptor rings\r\n");
+	return false;
+}
+
+static void log_scores(seq_count_type i, const score_type *scores, size_t num_scores)
+{
+#if USART_LOG_SCORES
+	printf("#%" PRIu32 ".\t", i);
+
+	for (size_t j = 0; j < num_scores; j++) {
+		printf(" %" PRIi32, scores[j]);
+	}
+
+	printf("\r\n");
+#else
+	(void)i;
+	(void)scores;
+	(void)num_scores;
+#endif
+}
+
 bool run_align(
 	AlignSystem *align_sys,
 	Sequences *seqs,
 	FIL *out_file,
-	double *elapsed_time
+	double *elapsed_time,
+	double *row_overhead
 )
 {
 	// Initialize timing info needed for benchmarking
 	XTime total_delta_t = 0;
 	*elapsed_time = 0.0; // just in case there's an error or some other early return
+	*row_overhead = 0.0;
+
+	align_sys->core_idle_since = 0;
+	align_sys->core_idle_t = 0;
+	align_sys->core_idle_rows = 0;
 
 	// Compute total length of sequences
 	size_t seq_len = total_seq_len(seqs->sequence_lengths, seqs->num_sequences);
 
-	// Needed for computing the padding at the end of the output file
-	size_t total_bytes_written = 0;
-
-	// Write number of sequences to output file
-	CHK_FOP(f_write_chk(out_file, &seqs->num_sequences, sizeof seqs->num_sequences));
-	total_bytes_written += sizeof seqs->num_sequences;
-
 	// Flush/invalidate caches under buffers explicitly for coherence
 	flush_cache(seqs->buffer,           sizeof seqs->buffer[0],           seq_len);
 	flush_cache(seqs->sequence_lengths, sizeof seqs->sequence_lengths[0], seqs->num_sequences);
 
+	// Set up the descriptor rings if the DMA engines support scatter-gather
+	DmaBatch batch;
+	size_t max_scores = seqs->num_sequences;
+
+	if (align_sys->use_sg) {
+		XAxiDma_BdRing *bd_ring = channel_bd_ring(align_sys, DMA_CHAN_HOR);
+		max_scores = max_scores > SG_MAX_SCORES ? max_scores : SG_MAX_SCORES;
+
+		if (!dma_batch_init(&batch, SG_MAX_ROWS, SG_BDS_PER_CHANNEL, max_scores, bd_ring->MaxTransferLen)) {
+			printf("could not allocate descriptor rings\r\n");
+			return false;
+		}
+	}
+
 	// Allocate memory for results
-	score_type *out_scores = malloc(seqs->num_sequences * sizeof out_scores[0]);
+	score_type *out_scores = malloc(max_scores * sizeof out_scores[0]);
+
+	if (out_scores == NULL) {
+		printf("could not allocate %lu scores\r\n", (unsigned long)max_scores);
+
+		if (align_sys->use_sg) {
+			dma_batch_free(&batch);
+		}
+
+		return false;
+	}
+
+	printf("*** Using %s DMA transfers\r\n", align_sys->use_sg ? "scatter-gather" : "simple");
+
+	// Scores are collected into large, sector-aligned chunks
+	// before they are written to the output file
+	ScoreWriter writer;
+	CHK_FOP(score_writer_open(&writer, out_file, SCORE_WRITER_SECTORS));
+
+	// Write number of sequences to output file
+	CHK_FOP(score_writer_write(&writer, &seqs->num_sequences, sizeof seqs->num_sequences));
 
 	// Initialize indices, pointers and lengths that determine the range
 	// of the vertical (resident) sequence and that of the horizontal (volatile) sequences
-	size_t num_seqs_hor = seqs->num_sequences;
 	size_t len_hor = seq_len;
 	Dihedral *seq_ver = seqs->buffer;
 
@@ -150,106 +536,261 @@ bool run_align(
 	// Then, pointers, indices and lengths are updated so that sequence #1 becomes
 	// the vertical one and it's being compared to seqs #2...n-1.
 	// This repeats until the vertical sequence would be seq. #n-1, which is when the computation ends.
-	for (seq_count_type i = 0; i < seqs->num_sequences - 1; i++) {
-		index_type len_ver = seqs->sequence_lengths[i];
-		Dihedral *seqs_hor = seq_ver + len_ver;
-
-		len_hor -= len_ver;
-		num_seqs_hor--;
-
-		// invalidate part of cache where scores will be written
-		invalidate_cache(out_scores, sizeof out_scores[0], num_seqs_hor);
-
-		// Set stream lengths
-		XAlign_Set_stream_size_ver(&align_sys->align, len_ver);
-		XAlign_Set_num_streams_hor(&align_sys->align, num_seqs_hor);
-
-		// Actually send the data
-		u32 status = XST_SUCCESS;
-
-#define CHECK(str) do { if (status != XST_SUCCESS) { printf("%s: status = %lu\r\n", str, status); free(out_scores); return false; } } while (0)
-
-		status = axidma_write(
-			&align_sys->ver_axidma,
-			seq_ver,
-			sizeof seq_ver[0],
-			len_ver
-		);
-		CHECK("vertical sequence data");
-
-		status = axidma_write(
-			&align_sys->hor_axidma,
-			seqs_hor,
-			sizeof seqs_hor[0],
-			len_hor
-		);
-		CHECK("horizontal sequence data");
-
-		status = axidma_write(
-			&align_sys->hor_sizes_axidma,
-			&seqs->sequence_lengths[i + 1],
-			sizeof seqs->sequence_lengths[i + 1],
-			num_seqs_hor
-		);
-		CHECK("horizontal sequence lengths");
-
-		status = axidma_read(
-			&align_sys->out_scores_axidma,
-			out_scores,
-			sizeof out_scores[0],
-			num_seqs_hor
-		);
-		CHECK("out scores");
+	// In scatter-gather mode, a whole batch of such rows is processed in one go.
+	bool success = true;
+
+	for (seq_count_type i = 0; i < seqs->num_sequences - 1; ) {
+		size_t num_rows = 0;
+
+		if (align_sys->use_sg) {
+			num_rows = align_rows_sg(align_sys, &batch, seqs, i, seq_ver, out_scores, &total_delta_t);
+		} else {
+			DmaRow row;
+			row.seq_ver = seq_ver;
+			row.len_ver = seqs->sequence_lengths[i];
+			row.seqs_hor = seq_ver + row.len_ver;
+			row.len_hor = len_hor - row.len_ver;
+			row.lens_hor = &seqs->sequence_lengths[i + 1];
+			row.num_hor = seqs->num_sequences - 1 - i;
+			row.out_scores = out_scores;
+
+			// invalidate part of cache where scores will be written
+			invalidate_cache(out_scores, sizeof out_scores[0], row.num_hor);
+
+			if (align_row_simple(align_sys, &row, &total_delta_t)) {
+				num_rows = 1;
+			}
+		}
 
-#undef CHECK
+		if (num_rows == 0) {
+			success = false;
+			break;
+		}
+
+		// Dump scores via USART if necessary, and write scores to file
+		score_type *row_scores = out_scores;
+
+		for (size_t r = 0; r < num_rows; r++, i++) {
+			size_t num_seqs_hor = seqs->num_sequences - 1 - i;
 
-		// Start alignment block
-		XAlign_Start(&align_sys->align);
+			log_scores(i, row_scores, num_seqs_hor);
 
-		// Wait for them to finish using polling.
-		// Measure the elapsed time.
-		XTime t_begin = get_time();
+			CHK_FOP(score_writer_write(&writer, row_scores, num_seqs_hor * sizeof row_scores[0]));
+			row_scores += num_seqs_hor;
 
-		while (
-		     axidma_busy_writing(&align_sys->ver_axidma)
-		  || axidma_busy_writing(&align_sys->hor_axidma)
-		  || axidma_busy_writing(&align_sys->hor_sizes_axidma)
-		  || axidma_busy_reading(&align_sys->out_scores_axidma)
-		  || align_busy(&align_sys->align)
-		) {
-			// NOP
+			len_hor -= seqs->sequence_lengths[i];
+			seq_ver += seqs->sequence_lengths[i];
 		}
+	}
 
-		XTime t_end = get_time();
-		total_delta_t += t_end - t_begin;
+	// Flush the last (padded) chunk of scores
+	CHK_FOP(score_writer_close(&writer));
+	CHK_FOP(f_sync(out_file));
 
-		// Dump scores via USART if necessary
-#if USART_LOG_SCORES
-		printf("#%" PRIu32 ".\t", i);
+	// Write performance info to out parameters
+	*elapsed_time = total_delta_t * 1.0 / COUNTS_PER_SECOND;
+
+	if (align_sys->core_idle_rows > 0) {
+		*row_overhead = align_sys->core_idle_t * 1.0 / COUNTS_PER_SECOND / align_sys->core_idle_rows;
+	}
+
+	if (align_sys->use_sg) {
+		dma_batch_free(&batch);
+	}
+
+	free(out_scores);
+	return success;
+}
+
+// Rows [begin, end) are a row block, holding the data of its vertical
+// sequences and the scores of its rows. Every row block has at least one row.
+static seq_count_type row_block_end(const Sequences *seqs, seq_count_type begin, size_t budget)
+{
+	seq_count_type end = begin;
+	size_t size = 0;
+
+	while (end + 1 < seqs->num_sequences) {
+		size_t row_size = seqs->sequence_lengths[end] * sizeof(Dihedral)
+		                + (seqs->num_sequences - 1 - end) * sizeof(score_type);
 
-		for (size_t j = 0; j < num_seqs_hor; j++) {
-			printf(" %" PRIi32, out_scores[j]);
+		if (end > begin && size + row_size > budget) {
+			break;
 		}
 
-		printf("\r\n");
-#endif
+		size += row_size;
+		end++;
+	}
 
-		// Write scores to file
-		size_t score_bufsize = num_seqs_hor * sizeof out_scores[0];
-		CHK_FOP(f_write_chk(out_file, out_scores, score_bufsize));
-		total_bytes_written += score_bufsize;
+	return end;
+}
 
-		seq_ver += len_ver;
+// Columns [begin, end) are a column block, holding the data of its
+// horizontal sequences. Every column block has at least one column.
+static seq_count_type col_block_end(const Sequences *seqs, seq_count_type begin, size_t budget)
+{
+	seq_count_type end = begin;
+	size_t size = 0;
+
+	while (end < seqs->num_sequences) {
+		size_t col_size = seqs->sequence_lengths[end] * sizeof(Dihedral);
+
+		if (end > begin && size + col_size > budget) {
+			break;
+		}
+
+		size += col_size;
+		end++;
+	}
+
+	return end;
+}
+
+bool run_align_blocked(
+	AlignSystem *align_sys,
+	FIL *in_file,
+	const Sequences *seqs,
+	size_t memory_budget,
+	FIL *out_file,
+	double *elapsed_time,
+	double *row_overhead
+)
+{
+	XTime total_delta_t = 0;
+	*elapsed_time = 0.0;
+	*row_overhead = 0.0;
+
+	align_sys->core_idle_since = 0;
+	align_sys->core_idle_t = 0;
+	align_sys->core_idle_rows = 0;
+
+	// Half of the budget goes to the row block, the other half to the column block
+	size_t block_budget = memory_budget / 2;
+
+	// Every horizontal length is sent straight from the array of lengths
+	flush_cache(seqs->sequence_lengths, sizeof seqs->sequence_lengths[0], seqs->num_sequences);
+
+	DmaBatch batch;
+
+	if (align_sys->use_sg) {
+		XAxiDma_BdRing *bd_ring = channel_bd_ring(align_sys, DMA_CHAN_HOR);
+
+		if (!dma_batch_init(&batch, SG_MAX_ROWS, SG_BDS_PER_CHANNEL, 0, bd_ring->MaxTransferLen)) {
+			printf("could not allocate descriptor rings\r\n");
+			return false;
+		}
+	}
+
+	printf("*** Using %s DMA transfers, %lu byte memory budget\r\n",
+		align_sys->use_sg ? "scatter-gather" : "simple", (unsigned long)memory_budget);
+
+	ScoreWriter writer;
+	CHK_FOP(score_writer_open(&writer, out_file, SCORE_WRITER_SECTORS));
+	CHK_FOP(score_writer_write(&writer, &seqs->num_sequences, sizeof seqs->num_sequences));
+
+	bool success = true;
+
+	for (seq_count_type row_begin = 0; success && row_begin + 1 < seqs->num_sequences; ) {
+		seq_count_type row_end = row_block_end(seqs, row_begin, block_budget);
+		size_t num_scores = 0;
+
+		for (seq_count_type i = row_begin; i < row_end; i++) {
+			num_scores += seqs->num_sequences - 1 - i;
+		}
+
+		size_t rows_len = total_seq_len(&seqs->sequence_lengths[row_begin], row_end - row_begin);
+		Dihedral *rows_buf = malloc(rows_len * sizeof rows_buf[0]);
+		score_type *scores = malloc(num_scores * sizeof scores[0]);
+
+		if ((rows_buf == NULL && rows_len > 0) || scores == NULL) {
+			printf("out of memory for rows %" PRIu32 "...%" PRIu32 "\r\n", row_begin, row_end - 1);
+			free(rows_buf);
+			free(scores);
+			success = false;
+			break;
+		}
+
+		CHK_FOP(read_sequence_block(in_file, seqs, row_begin, row_end, rows_buf));
+		flush_cache(rows_buf, sizeof rows_buf[0], rows_len);
+		invalidate_cache(scores, sizeof scores[0], num_scores);
+
+		// Stream horizontal sequences through the row block
+		for (seq_count_type col_begin = row_begin + 1; success && col_begin < seqs->num_sequences; ) {
+			seq_count_type col_end = col_block_end(seqs, col_begin, block_budget);
+			size_t cols_len = total_seq_len(&seqs->sequence_lengths[col_begin], col_end - col_begin);
+			Dihedral *cols_buf = malloc(cols_len * sizeof cols_buf[0]);
+
+			if (cols_buf == NULL && cols_len > 0) {
+				printf("out of memory for columns %" PRIu32 "...%" PRIu32 "\r\n", col_begin, col_end - 1);
+				success = false;
+				break;
+			}
+
+			CHK_FOP(read_sequence_block(in_file, seqs, col_begin, col_end, cols_buf));
+			flush_cache(cols_buf, sizeof cols_buf[0], cols_len);
+
+			const Dihedral *seq_ver = rows_buf;
+			score_type *row_scores = scores;
+
+			for (seq_count_type i = row_begin; success && i < row_end; i++) {
+				seq_count_type first_hor = col_begin > i + 1 ? col_begin : i + 1;
+
+				if (first_hor < col_end) {
+					size_t skipped_len = total_seq_len(&seqs->sequence_lengths[col_begin], first_hor - col_begin);
+
+					DmaRow row;
+					row.seq_ver = seq_ver;
+					row.len_ver = seqs->sequence_lengths[i];
+					row.seqs_hor = cols_buf + skipped_len;
+					row.len_hor = cols_len - skipped_len;
+					row.lens_hor = &seqs->sequence_lengths[first_hor];
+					row.num_hor = col_end - first_hor;
+					row.out_scores = row_scores + (first_hor - (i + 1));
+
+					success = queue_row(align_sys, &batch, &row, &total_delta_t);
+				}
+
+				seq_ver += seqs->sequence_lengths[i];
+				row_scores += seqs->num_sequences - 1 - i;
+			}
+
+			// The column block must not be released while still being transferred
+			success = success && flush_rows(align_sys, &batch, &total_delta_t);
+
+			free(cols_buf);
+			col_begin = col_end;
+		}
+
+		// Rows of the block are complete now, write them out in order
+		invalidate_cache(scores, sizeof scores[0], num_scores);
+
+		const score_type *row_scores = scores;
+
+		for (seq_count_type i = row_begin; success && i < row_end; i++) {
+			size_t num_seqs_hor = seqs->num_sequences - 1 - i;
+
+			log_scores(i, row_scores, num_seqs_hor);
+
+			CHK_FOP(score_writer_write(&writer, row_scores, num_seqs_hor * sizeof row_scores[0]));
+			row_scores += num_seqs_hor;
+		}
+
+		free(rows_buf);
+		free(scores);
+		row_begin = row_end;
 	}
 
-	// Must pad file by rounding up to the maximal sector size,
-	// otherwise nothing is written to the file whatsoever
-	CHK_FOP(pad_file(out_file, total_bytes_written));
+	CHK_FOP(score_writer_close(&writer));
 	CHK_FOP(f_sync(out_file));
 
-	// Write performance info to out parameter
 	*elapsed_time = total_delta_t * 1.0 / COUNTS_PER_SECOND;
 
-	free(out_scores);
-	return true;
+	if (align_sys->core_idle_rows > 0) {
+		*row_overhead = align_sys->core_idle_t * 1.0 / COUNTS_PER_SECOND / align_sys->core_idle_rows;
+	}
+
+	if (align_sys->use_sg) {
+		dma_batch_free(&batch);
+	}
+
+	return success;
 }
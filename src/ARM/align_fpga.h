@@ -17,8 +17,11 @@
 #include <stddef.h>
 
 #include "platform.h"
+#include "seq_types.h"
+#include "dma_ring.h"
 #include "xalign.h"
 #include "xaxidma.h"
+#include "xtime_l.h"
 #include "ff.h"
 
 
@@ -29,35 +32,30 @@
 #define USART_LOG_SCORES 1
 
 
-typedef  int16_t index_type;
-typedef uint16_t size_type;
-
-typedef  int16_t angle_type;
-typedef  int32_t score_type;
-
-typedef uint32_t seq_count_type;
-
-typedef struct Dihedral {
-	angle_type phi;
-	angle_type psi;
-} Dihedral;
-
-typedef struct Sequences {
-	Dihedral *buffer;             // Raw sequence data, contiguously (owning pointer)
-	index_type *sequence_lengths; // Number of dihedrals in each sequence (owning pointer)
-	seq_count_type num_sequences; // Number of sequences
-} Sequences;
-
 typedef struct AlignSystem {
 	XAxiDma ver_axidma;
 	XAxiDma hor_axidma;
 	XAxiDma hor_sizes_axidma;
 	XAxiDma out_scores_axidma;
 	XAlign align;
+
+	// Scatter-gather state, only used if every DMA engine supports it
+	bool use_sg;
+	bool sg_error;
+	size_t sg_pending[DMA_NUM_CHANNELS]; // descriptors handed to, but not yet retired by, each engine
+
+	// Time the core spent waiting for the CPU between consecutive rows
+	XTime core_idle_since;
+	XTime core_idle_t;
+	seq_count_type core_idle_rows;
 } AlignSystem;
 
 
-void init_align_system(AlignSystem *align_sys, score_type scoring_offset, score_type gap_penalty);
+// A negative band_width aligns the whole matrix; otherwise, only cells within
+// that many residues of the main diagonal are computed. The core reports
+// pairs whose best cell lies on the edge of the band in TUSER, which the
+// DMA doesn't transfer, so only scores are available here.
+void init_align_system(AlignSystem *align_sys, score_type scoring_offset, score_type gap_penalty, index_type band_width);
 
 size_t total_seq_len(const index_type *seq_lens, seq_count_type num_seqs);
 
@@ -65,7 +63,22 @@ bool run_align(
 	AlignSystem *align_sys,
 	Sequences *seqs,
 	FIL *out_file,
-	double *elapsed_time
+	double *elapsed_time,
+	double *row_overhead
+);
+
+// Same as run_align(), but for databases that don't fit into memory.
+// 'seqs' only holds the sequence lengths; the sequence data is read from
+// 'in_file' in blocks, and at most about 'memory_budget' bytes are used
+// for sequence data and scores at any time.
+bool run_align_blocked(
+	AlignSystem *align_sys,
+	FIL *in_file,
+	const Sequences *seqs,
+	size_t memory_budget,
+	FIL *out_file,
+	double *elapsed_time,
+	double *row_overhead
 );
 
 #endif /* ALIGN_FPGA_H_ */
@@ -0,0 +1,211 @@
+/*
+ * dma_ring.c
+ *
+ *  Created on: Oct 18, 2026
+ *
+ * Scatter-gather descriptor rings covering many rows of the triangle
+ */
+
+#include <stdlib.h>
+
+#include "dma_ring.h"
+
+
+static size_t descs_needed(size_t length, uint32_t max_desc_len)
+{
+	return (length + max_desc_len - 1) / max_desc_len;
+}
+
+// Split a buffer into descriptors of at most 'max_desc_len' bytes each.
+// The caller must have checked that the ring has enough free descriptors.
+static void ring_append(DmaRing *ring, const void *buf, size_t length, uint32_t max_desc_len)
+{
+	uintptr_t addr = (uintptr_t)buf;
+	uint32_t flags = DMA_DESC_SOF;
+
+	while (length > 0) {
+		uint32_t chunk = length < max_desc_len ? length : max_desc_len;
+
+		length -= chunk;
+
+		if (length == 0) {
+			flags |= DMA_DESC_EOF;
+		}
+
+		DmaDesc *desc = &ring->descs[ring->count++];
+		desc->addr = addr;
+		desc->length = chunk;
+		desc->flags = flags;
+
+		addr += chunk;
+		flags = 0;
+	}
+}
+
+bool dma_batch_init(DmaBatch *batch, size_t max_rows, size_t max_descs, size_t max_scores, uint32_t max_desc_len)
+{
+	bool ok = max_desc_len >= sizeof(Dihedral);
+
+	batch->rows = malloc(max_rows * sizeof batch->rows[0]);
+	batch->num_rows = 0;
+	batch->max_rows = max_rows;
+	batch->num_scores = 0;
+	batch->max_scores = max_scores;
+
+	// round down to a whole number of elements, so that no element
+	// is ever split across two descriptors
+	batch->max_desc_len = max_desc_len - max_desc_len % sizeof(Dihedral);
+
+	ok = ok && batch->rows != NULL;
+
+	for (int chan = 0; chan < DMA_NUM_CHANNELS; chan++) {
+		DmaRing *ring = &batch->rings[chan];
+		ring->descs = malloc(max_descs * sizeof ring->descs[0]);
+		ring->count = 0;
+		ring->capacity = max_descs;
+		ok = ok && ring->descs != NULL;
+	}
+
+	if (!ok) {
+		dma_batch_free(batch);
+	}
+
+	return ok;
+}
+
+void dma_batch_free(DmaBatch *batch)
+{
+	free(batch->rows);
+	batch->rows = NULL;
+
+	for (int chan = 0; chan < DMA_NUM_CHANNELS; chan++) {
+		free(batch->rings[chan].descs);
+		batch->rings[chan].descs = NULL;
+		batch->rings[chan].capacity = 0;
+	}
+}
+
+void dma_batch_clear(DmaBatch *batch)
+{
+	batch->num_rows = 0;
+	batch->num_scores = 0;
+
+	for (int chan = 0; chan < DMA_NUM_CHANNELS; chan++) {
+		batch->rings[chan].count = 0;
+	}
+}
+
+bool dma_batch_add_row(DmaBatch *batch, const DmaRow *row)
+{
+	uint32_t max_len = batch->max_desc_len;
+
+	size_t lengths[DMA_NUM_CHANNELS];
+	lengths[DMA_CHAN_VER]        = row->len_ver * sizeof row->seq_ver[0];
+	lengths[DMA_CHAN_HOR]        = row->len_hor * sizeof row->seqs_hor[0];
+	lengths[DMA_CHAN_HOR_SIZES]  = row->num_hor * sizeof row->lens_hor[0];
+	lengths[DMA_CHAN_OUT_SCORES] = row->num_hor * sizeof row->out_scores[0];
+
+	// Only add the row if every part of it fits
+	bool fits = batch->num_rows < batch->max_rows;
+
+	for (int chan = 0; chan < DMA_NUM_CHANNELS; chan++) {
+		const DmaRing *ring = &batch->rings[chan];
+		fits = fits && ring->count + descs_needed(lengths[chan], max_len) <= ring->capacity;
+	}
+
+	if (!fits) {
+		return false;
+	}
+
+	ring_append(&batch->rings[DMA_CHAN_VER],        row->seq_ver,    lengths[DMA_CHAN_VER],        max_len);
+	ring_append(&batch->rings[DMA_CHAN_HOR],        row->seqs_hor,   lengths[DMA_CHAN_HOR],        max_len);
+	ring_append(&batch->rings[DMA_CHAN_HOR_SIZES],  row->lens_hor,   lengths[DMA_CHAN_HOR_SIZES],  max_len);
+	ring_append(&batch->rings[DMA_CHAN_OUT_SCORES], row->out_scores, lengths[DMA_CHAN_OUT_SCORES], max_len);
+
+	DmaRowArgs *args = &batch->rows[batch->num_rows++];
+	args->stream_size_ver = row->len_ver;
+	args->num_streams_hor = row->num_hor;
+
+	batch->num_scores += row->num_hor;
+
+	return true;
+}
+
+size_t dma_batch_build(
+	DmaBatch *batch,
+	const Sequences *seqs,
+	seq_count_type first_row,
+	const Dihedral *seq_ver,
+	score_type *out_scores
+)
+{
+	dma_batch_clear(batch);
+
+	// Total length of the horizontal tail of 'first_row'
+	size_t len_hor = 0;
+
+	for (seq_count_type j = first_row + 1; j < seqs->num_sequences; j++) {
+		len_hor += seqs->sequence_lengths[j];
+	}
+
+	for (seq_count_type i = first_row; i + 1 < seqs->num_sequences; i++) {
+		DmaRow row;
+		row.seq_ver = seq_ver;
+		row.len_ver = seqs->sequence_lengths[i];
+		row.seqs_hor = seq_ver + row.len_ver;
+		row.len_hor = len_hor;
+		row.lens_hor = &seqs->sequence_lengths[i + 1];
+		row.num_hor = seqs->num_sequences - 1 - i;
+		row.out_scores = out_scores + batch->num_scores;
+
+		if (batch->num_scores + row.num_hor > batch->max_scores || !dma_batch_add_row(batch, &row)) {
+			break;
+		}
+
+		len_hor -= seqs->sequence_lengths[i + 1];
+		seq_ver += row.len_ver;
+	}
+
+	return batch->num_rows;
+}
+
+bool dma_batch_run(const DmaBackend *backend, const DmaBatch *batch)
+{
+	// The output channel is armed first, so that it never stalls the core
+	static const DmaChannel order[DMA_NUM_CHANNELS] = {
+		DMA_CHAN_OUT_SCORES,
+		DMA_CHAN_HOR_SIZES,
+		DMA_CHAN_HOR,
+		DMA_CHAN_VER,
+	};
+
+	for (int k = 0; k < DMA_NUM_CHANNELS; k++) {
+		const DmaRing *ring = &batch->rings[order[k]];
+
+		if (ring->count > 0 && !backend->submit(backend->ctx, order[k], ring)) {
+			return false;
+		}
+	}
+
+	// The engines now run through their rings on their own;
+	// the only per-row work left for the CPU is restarting the core.
+	for (size_t r = 0; r < batch->num_rows; r++) {
+		while (backend->core_busy(backend->ctx)) {
+			// NOP
+		}
+
+		backend->start_row(backend->ctx, &batch->rows[r]);
+	}
+
+	bool busy = true;
+
+	while (busy) {
+		busy = backend->core_busy(backend->ctx);
+
+		for (int chan = 0; chan < DMA_NUM_CHANNELS; chan++) {
+			busy = busy || backend->channel_busy(backend->ctx, chan);
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,126 @@
+/*
+ * dma_ring.h
+ *
+ *  Created on: Oct 18, 2026
+ *
+ * Scatter-gather descriptor rings covering many rows of the triangle.
+ *
+ * A batch describes, for a run of consecutive vertical sequences (rows),
+ * every buffer the four DMA channels need to move: the vertical sequence,
+ * the horizontal tail, the horizontal sizes and the score destination.
+ * The whole batch is handed to the DMA engines at once, so the CPU only
+ * needs to restart the alignment core between rows.
+ *
+ * This file only depends on plain C, so that the ring building and the
+ * batch scheduling logic can be exercised on Linux with a mock backend.
+ */
+
+#ifndef DMA_RING_H_
+#define DMA_RING_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "seq_types.h"
+
+
+// Descriptor control flags: start and end of a frame (one row on one channel)
+#define DMA_DESC_SOF 0x1u
+#define DMA_DESC_EOF 0x2u
+
+typedef enum DmaChannel {
+	DMA_CHAN_VER,
+	DMA_CHAN_HOR,
+	DMA_CHAN_HOR_SIZES,
+	DMA_CHAN_OUT_SCORES,
+	DMA_NUM_CHANNELS
+} DmaChannel;
+
+typedef struct DmaDesc {
+	uintptr_t addr;  // Bus address of the buffer
+	uint32_t length; // Length of the buffer in bytes
+	uint32_t flags;  // Bitwise OR of DMA_DESC_* flags
+} DmaDesc;
+
+typedef struct DmaRing {
+	DmaDesc *descs;  // Descriptors in submission order (owning pointer)
+	size_t count;    // Number of descriptors in use
+	size_t capacity; // Number of allocated descriptors
+} DmaRing;
+
+// Buffers of one row: a vertical sequence against consecutive horizontal ones
+typedef struct DmaRow {
+	const Dihedral *seq_ver;
+	index_type len_ver;
+	const Dihedral *seqs_hor;     // contiguous data of all horizontal sequences
+	size_t len_hor;               // total length of the horizontal sequences
+	const index_type *lens_hor;   // length of each horizontal sequence
+	seq_count_type num_hor;       // number of horizontal sequences
+	score_type *out_scores;       // destination of 'num_hor' scores
+} DmaRow;
+
+// Values of the alignment core's AXI-Lite registers for a single row
+typedef struct DmaRowArgs {
+	index_type stream_size_ver;
+	seq_count_type num_streams_hor;
+} DmaRowArgs;
+
+typedef struct DmaBatch {
+	DmaRing rings[DMA_NUM_CHANNELS];
+	DmaRowArgs *rows;       // Per-row core arguments (owning pointer)
+	size_t num_rows;        // Number of rows in the batch
+	size_t max_rows;        // Capacity of 'rows'
+	size_t num_scores;      // Number of scores written by the whole batch
+	size_t max_scores;      // Capacity of the score destination buffer
+	uint32_t max_desc_len;  // Maximal transfer length of one descriptor
+} DmaBatch;
+
+// A DMA backend: either the real AXI DMA engines, or a software mock.
+// Every function receives 'ctx' as its first argument.
+typedef struct DmaBackend {
+	void *ctx;
+
+	// Hand a complete ring over to a channel. Returns false on error.
+	bool (*submit)(void *ctx, DmaChannel chan, const DmaRing *ring);
+
+	// True while the channel still has outstanding descriptors.
+	bool (*channel_busy)(void *ctx, DmaChannel chan);
+
+	// Program the core registers for one row and start the core.
+	void (*start_row)(void *ctx, const DmaRowArgs *args);
+
+	// True while the core is processing a row.
+	bool (*core_busy)(void *ctx);
+} DmaBackend;
+
+
+bool dma_batch_init(DmaBatch *batch, size_t max_rows, size_t max_descs, size_t max_scores, uint32_t max_desc_len);
+
+void dma_batch_free(DmaBatch *batch);
+
+// Remove all rows from the batch
+void dma_batch_clear(DmaBatch *batch);
+
+// Append a row to the batch if every part of it fits. Returns false otherwise.
+// This does not account for the score capacity of the batch, since the
+// scores of the row go to an arbitrary destination.
+bool dma_batch_add_row(DmaBatch *batch, const DmaRow *row);
+
+// Fill 'batch' with as many rows of the triangle as fit, starting at 'first_row'.
+// 'seq_ver' points to the vertical sequence of 'first_row'.
+// Scores of the batch are laid out contiguously, row after row, in 'out_scores'.
+// Returns the number of rows added (0 if not even a single row fits).
+size_t dma_batch_build(
+	DmaBatch *batch,
+	const Sequences *seqs,
+	seq_count_type first_row,
+	const Dihedral *seq_ver,
+	score_type *out_scores
+);
+
+// Submit every ring, then run the core once per row, back to back.
+// Returns false if any of the submissions failed.
+bool dma_batch_run(const DmaBackend *backend, const DmaBatch *batch);
+
+#endif /* DMA_RING_H_ */
@@ -24,6 +24,11 @@
 // Parameters for the algorithm
 #define SCORING_OFFSET  65536
 #define GAP_PENALTY     (-4000)
+#define BAND_WIDTH      (-1) // whole matrix; see FULL_BAND in ../FPGA/align.hh
+
+// Memory available for sequence data and scores. Databases whose
+// sequence data doesn't fit into half of this are processed in blocks.
+#define MEMORY_BUDGET   (256u << 20)
 
 
 int main()
@@ -42,13 +47,23 @@ int main()
 	CHK_FOP(f_open(&infile, INPUT_FILENAME, FA_READ));
 	printf("*** Opened input file '%s'\r\n", INPUT_FILENAME);
 
-	// Read sequence data into memory
+	// Read sequence lengths, then sequence data if it fits into memory
 	Sequences seqs;
-	CHK_FOP(read_sequences_from_file(&infile, &seqs));
-	printf("*** Read sequence data from file\r\n");
+	CHK_FOP(read_sequence_lengths(&infile, &seqs));
+
+	size_t data_size = total_seq_len(seqs.sequence_lengths, seqs.num_sequences) * sizeof(Dihedral);
+	bool in_memory = data_size <= MEMORY_BUDGET / 2;
+
+	if (in_memory) {
+		seqs.buffer = malloc(data_size);
+		CHK_FOP(read_sequence_block(&infile, &seqs, 0, seqs.num_sequences, seqs.buffer));
+		printf("*** Read sequence data from file\r\n");
 
-	// Close input file
-	CHK_FOP(f_close(&infile));
+		// Close input file
+		CHK_FOP(f_close(&infile));
+	} else {
+		printf("*** Sequence data (%lu bytes) will be read in blocks\r\n", (unsigned long)data_size);
+	}
 
 	// Open output file
 	FIL outfile;
@@ -56,21 +71,40 @@ int main()
 
 	// Initialize FPGA hardware
 	AlignSystem align_sys;
-	init_align_system(&align_sys, SCORING_OFFSET, GAP_PENALTY);
+	init_align_system(&align_sys, SCORING_OFFSET, GAP_PENALTY, BAND_WIDTH);
 	printf("*** Initialized alignment hardware\r\n");
 
 	// Compute results
 	printf("*** Performing computations\r\n");
 
 	double dt = 0.0;
-	bool success = run_align(
-		&align_sys,
-		&seqs,
-		&outfile,
-		&dt
-	);
+	double row_overhead = 0.0;
+	bool success = false;
+
+	if (in_memory) {
+		success = run_align(
+			&align_sys,
+			&seqs,
+			&outfile,
+			&dt,
+			&row_overhead
+		);
+	} else {
+		success = run_align_blocked(
+			&align_sys,
+			&infile,
+			&seqs,
+			MEMORY_BUDGET,
+			&outfile,
+			&dt,
+			&row_overhead
+		);
+
+		CHK_FOP(f_close(&infile));
+	}
 
 	printf("*** %s! Elapsed Time: %lg seconds\r\n", success ? "Success" : "Failure", dt);
+	printf("*** Core idle time per row: %lg microseconds\r\n", row_overhead * 1e6);
 
 	// Finish writing results and close output file
 	CHK_FOP(f_close(&outfile));
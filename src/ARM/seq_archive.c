@@ -0,0 +1,134 @@
+/*
+ * seq_archive.c
+ *
+ *  Created on: Oct 18, 2026
+ *
+ * Decoder of compressed sequence archives
+ */
+
+#include "seq_archive.h"
+
+
+// A 16-bit value has at most 3 bytes, the last of which holds 2 bits.
+// Unless 'checked', at least 3 bytes must be readable at '*src'.
+static inline bool get_varint(const unsigned char **src, const unsigned char *end, bool checked, uint16_t *value)
+{
+	const unsigned char *p = *src;
+	unsigned shift = 0;
+	unsigned result = 0;
+
+	for (;;) {
+		if (checked && p == end) {
+			return false;
+		}
+
+		unsigned byte = *p++;
+		result |= (byte & 0x7fu) << shift;
+
+		if (byte < 0x80u) {
+			break;
+		}
+
+		if ((shift += 7) == 14) {
+			// third byte: no continuation, 2 bits of payload
+			if (checked && p == end) {
+				return false;
+			}
+
+			byte = *p++;
+
+			if (byte >= 4) {
+				return false;
+			}
+
+			result |= byte << 14;
+			break;
+		}
+	}
+
+	*src = p;
+	*value = (uint16_t)result;
+
+	return true;
+}
+
+static inline angle_type unzigzag(uint16_t value)
+{
+	return (angle_type)(uint16_t)((value >> 1) ^ (uint16_t)-(value & 1));
+}
+
+static const unsigned char *decode_residues(
+	const unsigned char *src,
+	const unsigned char *end,
+	bool checked,
+	index_type begin,
+	index_type length,
+	Dihedral *dst
+)
+{
+	Dihedral prev = { 0, 0 };
+
+	if (begin > 0) {
+		prev = dst[begin - 1];
+	}
+
+	for (index_type k = begin; k < length; k++) {
+		uint16_t d_phi, d_psi;
+
+		if (!get_varint(&src, end, checked, &d_phi) || !get_varint(&src, end, checked, &d_psi)) {
+			return NULL;
+		}
+
+		prev.phi = (angle_type)(uint16_t)(prev.phi + unzigzag(d_phi));
+		prev.psi = (angle_type)(uint16_t)(prev.psi + unzigzag(d_psi));
+		dst[k] = prev;
+	}
+
+	return src;
+}
+
+bool seq_archive_index_valid(const Sequences *seqs)
+{
+	const uint64_t *offsets = seqs->code_offsets;
+
+	if (offsets[0] != 0) {
+		return false;
+	}
+
+	// Every residue takes at least 2 bytes of code, and raw ones the most
+	for (seq_count_type i = 0; i < seqs->num_sequences; i++) {
+		uint64_t len = seqs->sequence_lengths[i];
+		uint64_t size = offsets[i + 1] - offsets[i];
+
+		if (seqs->sequence_lengths[i] < 0 || offsets[i + 1] < offsets[i] || size < 2 * len || size > SEQ_ARCHIVE_RAW_RESIDUE_SIZE * len) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool seq_archive_decode(const unsigned char *src, const unsigned char *end, index_type length, Dihedral *dst)
+{
+	size_t available = end - src;
+
+	if (length > 0 && available == (size_t)length * SEQ_ARCHIVE_RAW_RESIDUE_SIZE) {
+		for (index_type k = 0; k < length; k++, src += SEQ_ARCHIVE_RAW_RESIDUE_SIZE) {
+			dst[k].phi = (angle_type)(uint16_t)(src[0] | src[1] << 8);
+			dst[k].psi = (angle_type)(uint16_t)(src[2] | src[3] << 8);
+		}
+
+		return true;
+	}
+
+	// Only residues near the end of the code need bounds checks
+	size_t num_unchecked = available / SEQ_ARCHIVE_MAX_RESIDUE_SIZE;
+
+	if (num_unchecked > (size_t)length) {
+		num_unchecked = length;
+	}
+
+	src = decode_residues(src, end, false, 0, (index_type)num_unchecked, dst);
+
+	return src != NULL && decode_residues(src, end, true, (index_type)num_unchecked, length, dst) == end;
+}
@@ -0,0 +1,42 @@
+/*
+ * seq_archive.h
+ *
+ *  Created on: Oct 18, 2026
+ *
+ * Decoder of compressed sequence archives, as written by the host's
+ * pack_seqs tool (the format is described in src/FPGA/seq_archive.hh).
+ * Every angle is the zigzag-mapped difference from the same angle of the
+ * previous residue, as a base-128 varint; sequences that don't compress
+ * are stored raw, as exactly SEQ_ARCHIVE_RAW_RESIDUE_SIZE bytes per residue.
+ *
+ * This file only depends on plain C, so that it can be tested on Linux.
+ */
+
+#ifndef SEQ_ARCHIVE_H_
+#define SEQ_ARCHIVE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "seq_types.h"
+
+
+#define SEQ_ARCHIVE_MAGIC 0x5a535753u // "SWSZ", instead of a sequence count
+
+// Bytes of varint code, and of raw data, per residue
+#define SEQ_ARCHIVE_MAX_RESIDUE_SIZE 6
+#define SEQ_ARCHIVE_RAW_RESIDUE_SIZE 4
+
+// Byte offset of the offset index, and of the code, in an archive
+#define SEQ_ARCHIVE_INDEX_OFFSET(num_seqs) (2 * sizeof(uint32_t) + (size_t)(num_seqs) * sizeof(index_type))
+#define SEQ_ARCHIVE_DATA_OFFSET(num_seqs)  (SEQ_ARCHIVE_INDEX_OFFSET(num_seqs) + ((size_t)(num_seqs) + 1) * sizeof(uint64_t))
+
+// Checks the offset index read from an archive against the lengths
+bool seq_archive_index_valid(const Sequences *seqs);
+
+// Decodes the code of one sequence of 'length' residues, [src, end), into 'dst'.
+// Returns false if it's not a valid code.
+bool seq_archive_decode(const unsigned char *src, const unsigned char *end, index_type length, Dihedral *dst);
+
+#endif /* SEQ_ARCHIVE_H_ */
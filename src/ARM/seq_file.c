@@ -7,6 +7,8 @@
  * Driver for reading sequences from / writing results to the SD Card
  */
 
+#include <string.h>
+
 #include "seq_file.h"
 
 
@@ -68,32 +70,103 @@ FRESULT f_write_chk(FIL *file, const void *buf, size_t size)
 	return bytes_written == size ? FR_OK : FR_INT_ERR;
 }
 
-FRESULT pad_file(FIL *file, size_t total_bytes_written)
+FRESULT score_writer_open(ScoreWriter *writer, FIL *file, size_t num_sectors)
 {
-	size_t sector_size = sizeof file->fs->win;
-	size_t last_partial_chunk_size = total_bytes_written % sector_size;
+	writer->file = file;
+	writer->sector_size = sizeof file->fs->win;
+	writer->capacity = num_sectors * writer->sector_size;
+	writer->size = 0;
+	writer->buffer = malloc(writer->capacity);
 
-	if (last_partial_chunk_size) {
-		size_t trailing_size = sector_size - last_partial_chunk_size;
-		unsigned char zeros[trailing_size];
-		memset(zeros, 0, sizeof zeros);
-		return f_write_chk(file, zeros, sizeof zeros);
+	return writer->buffer ? FR_OK : FR_NOT_ENOUGH_CORE;
+}
+
+FRESULT score_writer_write(ScoreWriter *writer, const void *buf, size_t size)
+{
+	const unsigned char *ptr = buf;
+	FRESULT fresult = FR_OK;
+
+	while (size > 0) {
+		// If nothing is buffered, whole sectors can go to the file directly
+		if (writer->size == 0 && size >= writer->capacity) {
+			size_t direct_size = size - size % writer->capacity;
+
+			if ((fresult = f_write_chk(writer->file, ptr, direct_size)) != FR_OK) {
+				return fresult;
+			}
+
+			ptr += direct_size;
+			size -= direct_size;
+			continue;
+		}
+
+		size_t chunk = writer->capacity - writer->size;
+
+		if (chunk > size) {
+			chunk = size;
+		}
+
+		memcpy(writer->buffer + writer->size, ptr, chunk);
+		writer->size += chunk;
+		ptr += chunk;
+		size -= chunk;
+
+		if (writer->size == writer->capacity) {
+			if ((fresult = f_write_chk(writer->file, writer->buffer, writer->size)) != FR_OK) {
+				return fresult;
+			}
+
+			writer->size = 0;
+		}
 	}
 
 	return FR_OK;
 }
 
-FRESULT read_sequences_from_file(FIL *file, Sequences *seqs)
+FRESULT score_writer_close(ScoreWriter *writer)
 {
 	FRESULT fresult = FR_OK;
+	size_t last_partial_chunk_size = writer->size % writer->sector_size;
+
+	// The buffer is a whole number of sectors, so the padding always fits
+	if (last_partial_chunk_size) {
+		size_t trailing_size = writer->sector_size - last_partial_chunk_size;
+		memset(writer->buffer + writer->size, 0, trailing_size);
+		writer->size += trailing_size;
+	}
+
+	if (writer->size > 0) {
+		fresult = f_write_chk(writer->file, writer->buffer, writer->size);
+	}
+
+	free(writer->buffer);
+	writer->buffer = NULL;
+	writer->size = 0;
+
+	return fresult;
+}
 
-	// First, read the number of sequences in the file
+FRESULT read_sequence_lengths(FIL *file, Sequences *seqs)
+{
+	FRESULT fresult = FR_OK;
+
+	// First, read the number of sequences in the file,
+	// which is preceded by a magic number in archives
 	seq_count_type num_seqs = 0;
+	bool archive = false;
 
 	if ((fresult = f_read_chk(file, &num_seqs, sizeof num_seqs)) != FR_OK) {
 		return fresult;
 	}
 
+	if (num_seqs == SEQ_ARCHIVE_MAGIC) {
+		archive = true;
+
+		if ((fresult = f_read_chk(file, &num_seqs, sizeof num_seqs)) != FR_OK) {
+			return fresult;
+		}
+	}
+
 	// Then read the length of each sequence
 	index_type *seq_lens = NULL;
 	size_t seq_lens_bufsize = num_seqs * sizeof seq_lens[0];
@@ -104,21 +177,141 @@ FRESULT read_sequences_from_file(FIL *file, Sequences *seqs)
 		return fresult;
 	}
 
+	// And the offset index of an archive
+	uint64_t *code_offsets = NULL;
+
+	if (archive) {
+		size_t offsets_bufsize = (num_seqs + 1) * sizeof code_offsets[0];
+		code_offsets = malloc(offsets_bufsize);
+
+		if (code_offsets == NULL) {
+			free(seq_lens);
+			return FR_NOT_ENOUGH_CORE;
+		}
+
+		if ((fresult = f_read_chk(file, code_offsets, offsets_bufsize)) != FR_OK) {
+			free(seq_lens);
+			free(code_offsets);
+			return fresult;
+		}
+	}
+
+	// Populate out parameter
+	seqs->buffer = NULL;
+	seqs->sequence_lengths = seq_lens;
+	seqs->num_sequences = num_seqs;
+	seqs->code_offsets = code_offsets;
+
+	if (archive && !seq_archive_index_valid(seqs)) {
+		free_sequences(seqs);
+		return FR_INT_ERR;
+	}
+
+	return FR_OK;
+}
+
+// Reads the code of sequences [begin, end) in chunks of whole sequences,
+// and decodes it into 'buf'
+static FRESULT read_archive_block(FIL *file, const Sequences *seqs, seq_count_type begin, seq_count_type end, Dihedral *buf)
+{
+	FRESULT fresult = FR_OK;
+	const uint64_t *offsets = seqs->code_offsets;
+	size_t offset = SEQ_ARCHIVE_DATA_OFFSET(seqs->num_sequences) + offsets[begin];
+
+	if (f_tell(file) != offset && (fresult = f_lseek(file, offset)) != FR_OK) {
+		return fresult;
+	}
+
+	// A single sequence may take more than a chunk
+	size_t capacity = ARCHIVE_READ_CHUNK;
+
+	for (seq_count_type i = begin; i < end; i++) {
+		if (offsets[i + 1] - offsets[i] > capacity) {
+			capacity = offsets[i + 1] - offsets[i];
+		}
+	}
+
+	unsigned char *code = malloc(capacity);
+
+	if (code == NULL) {
+		return FR_NOT_ENOUGH_CORE;
+	}
+
+	for (seq_count_type first = begin; first < end && fresult == FR_OK; ) {
+		seq_count_type last = first + 1;
+
+		while (last < end && offsets[last + 1] - offsets[first] <= capacity) {
+			last++;
+		}
+
+		size_t size = offsets[last] - offsets[first];
+
+		if ((fresult = f_read_chk(file, code, size)) != FR_OK) {
+			break;
+		}
+
+		for (seq_count_type i = first; i < last; i++) {
+			const unsigned char *src = code + (offsets[i] - offsets[first]);
+			const unsigned char *src_end = code + (offsets[i + 1] - offsets[first]);
+
+			if (!seq_archive_decode(src, src_end, seqs->sequence_lengths[i], buf)) {
+				fresult = FR_INT_ERR;
+				break;
+			}
+
+			buf += seqs->sequence_lengths[i];
+		}
+
+		first = last;
+	}
+
+	free(code);
+
+	return fresult;
+}
+
+FRESULT read_sequence_block(FIL *file, const Sequences *seqs, seq_count_type begin, seq_count_type end, Dihedral *buf)
+{
+	FRESULT fresult = FR_OK;
+
+	if (seqs->code_offsets != NULL) {
+		return read_archive_block(file, seqs, begin, end, buf);
+	}
+
+	// Sequence data starts right after the count and the lengths
+	size_t offset = sizeof seqs->num_sequences
+	              + seqs->num_sequences * sizeof seqs->sequence_lengths[0]
+	              + total_seq_len(seqs->sequence_lengths, begin) * sizeof buf[0];
+
+	size_t size = total_seq_len(&seqs->sequence_lengths[begin], end - begin) * sizeof buf[0];
+
+	if (f_tell(file) != offset && (fresult = f_lseek(file, offset)) != FR_OK) {
+		return fresult;
+	}
+
+	return f_read_chk(file, buf, size);
+}
+
+FRESULT read_sequences_from_file(FIL *file, Sequences *seqs)
+{
+	FRESULT fresult = FR_OK;
+
+	if ((fresult = read_sequence_lengths(file, seqs)) != FR_OK) {
+		return fresult;
+	}
+
 	// Finally, read actual sequence data
 	Dihedral *buf = NULL;
-	size_t seq_bufsize = total_seq_len(seq_lens, num_seqs) * sizeof buf[0];
+	size_t seq_bufsize = total_seq_len(seqs->sequence_lengths, seqs->num_sequences) * sizeof buf[0];
 	buf = malloc(seq_bufsize);
 
-	if ((fresult = f_read_chk(file, buf, seq_bufsize)) != FR_OK) {
-		free(seq_lens);
+	if ((fresult = read_sequence_block(file, seqs, 0, seqs->num_sequences, buf)) != FR_OK) {
+		free_sequences(seqs);
 		free(buf);
 		return fresult;
 	}
 
-	// Populate out parameter
 	seqs->buffer = buf;
-	seqs->sequence_lengths = seq_lens;
-	seqs->num_sequences = num_seqs;
 
 	return FR_OK;
 }
@@ -127,4 +320,5 @@ void free_sequences(Sequences *seqs)
 {
 	free(seqs->buffer);
 	free(seqs->sequence_lengths);
+	free(seqs->code_offsets);
 }
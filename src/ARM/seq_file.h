@@ -17,6 +17,7 @@
 #include <stddef.h>
 
 #include "align_fpga.h"
+#include "seq_archive.h"
 #include "ff.h"
 
 
@@ -30,6 +31,24 @@
   } while (0)
 
 
+// Number of sectors buffered by a ScoreWriter before they are written out
+#define SCORE_WRITER_SECTORS 256
+
+// Archive code is read this many bytes (or at least one sequence) at a time
+#define ARCHIVE_READ_CHUNK (64u << 10)
+
+
+// Buffered writer that only ever hands whole sectors to FatFs,
+// so that the file system never has to read-modify-write a sector.
+typedef struct ScoreWriter {
+	FIL *file;
+	unsigned char *buffer; // owning pointer
+	size_t capacity;       // size of 'buffer', a multiple of the sector size
+	size_t size;           // number of bytes currently buffered
+	size_t sector_size;
+} ScoreWriter;
+
+
 extern const char *const fresult_strings[];
 
 
@@ -39,7 +58,21 @@ FRESULT unmount_fat_fs(void);
 FRESULT f_read_chk(FIL *file, void *buf, size_t size);
 FRESULT f_write_chk(FIL *file, const void *buf, size_t size);
 
-FRESULT pad_file(FIL *file, size_t total_bytes_written);
+FRESULT score_writer_open(ScoreWriter *writer, FIL *file, size_t num_sectors);
+FRESULT score_writer_write(ScoreWriter *writer, const void *buf, size_t size);
+
+// Pads the output by rounding up to a whole number of sectors,
+// otherwise nothing is written to the file whatsoever; then flushes
+// the remaining data and releases the buffer.
+FRESULT score_writer_close(ScoreWriter *writer);
+
+// Read only the header (count and lengths) of a sequence file, either raw
+// or a compressed archive (then its offset index as well, see seq_archive.h).
+// The data of the sequences is left on the card; seqs->buffer is NULL.
+FRESULT read_sequence_lengths(FIL *file, Sequences *seqs);
+
+// Read the data of sequences [begin, end) into 'buf', decoding it if need be
+FRESULT read_sequence_block(FIL *file, const Sequences *seqs, seq_count_type begin, seq_count_type end, Dihedral *buf);
 
 FRESULT read_sequences_from_file(FIL *file, Sequences *seqs);
 
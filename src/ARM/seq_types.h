@@ -0,0 +1,37 @@
+/*
+ * seq_types.h
+ *
+ *  Created on: Oct 18, 2026
+ *
+ * Plain data types describing sequences and scores.
+ * This header must not depend on any Xilinx header,
+ * so that it can be used for Linux-side testing as well.
+ */
+
+#ifndef SEQ_TYPES_H_
+#define SEQ_TYPES_H_
+
+#include <stdint.h>
+
+
+typedef  int16_t index_type;
+typedef uint16_t size_type;
+
+typedef  int16_t angle_type;
+typedef  int32_t score_type;
+
+typedef uint32_t seq_count_type;
+
+typedef struct Dihedral {
+	angle_type phi;
+	angle_type psi;
+} Dihedral;
+
+typedef struct Sequences {
+	Dihedral *buffer;             // Raw sequence data, contiguously (owning pointer)
+	index_type *sequence_lengths; // Number of dihedrals in each sequence (owning pointer)
+	seq_count_type num_sequences; // Number of sequences
+	uint64_t *code_offsets;       // Archives only: offset of the code of each sequence, n + 1 elements (owning pointer)
+} Sequences;
+
+#endif /* SEQ_TYPES_H_ */
@@ -0,0 +1,222 @@
+/*
+ * dma_mock.c
+ *
+ *  Created on: Oct 18, 2026
+ *
+ * Software model of the DMA engines and the alignment core
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "dma_mock.h"
+
+
+// Horizontal sequences can't be longer than this
+#define MOCK_MAX_SEQ_LEN 32768
+
+
+static bool channel_drained(const DmaMock *mock, DmaChannel chan)
+{
+	return mock->desc_index[chan] == mock->rings[chan].count;
+}
+
+// Move 'size' bytes between 'buf' and the channel's descriptors,
+// in the direction of the channel.
+static void mock_transfer(DmaMock *mock, DmaChannel chan, void *buf, size_t size)
+{
+	unsigned char *ptr = buf;
+	const DmaRing *ring = &mock->rings[chan];
+
+	while (size > 0) {
+		if (channel_drained(mock, chan)) {
+			mock->error = true;
+			return;
+		}
+
+		const DmaDesc *desc = &ring->descs[mock->desc_index[chan]];
+		size_t offset = mock->desc_offset[chan];
+		size_t chunk = desc->length - offset;
+		unsigned char *addr = (unsigned char *)desc->addr + offset;
+
+		if (chunk > size) {
+			chunk = size;
+		}
+
+		if (chan == DMA_CHAN_OUT_SCORES) {
+			memcpy(addr, ptr, chunk);
+		} else {
+			memcpy(ptr, addr, chunk);
+		}
+
+		ptr += chunk;
+		size -= chunk;
+
+		if (offset + chunk == desc->length) {
+			mock->desc_index[chan]++;
+			mock->desc_offset[chan] = 0;
+		} else {
+			mock->desc_offset[chan] += chunk;
+		}
+	}
+}
+
+// Every channel that moved data during a row must have stopped
+// exactly at the end of a frame, i.e. of a descriptor flagged EOF.
+static void check_end_of_row(DmaMock *mock, const size_t *desc_index_before)
+{
+	for (int chan = 0; chan < DMA_NUM_CHANNELS; chan++) {
+		size_t index = mock->desc_index[chan];
+
+		if (index == desc_index_before[chan] && mock->desc_offset[chan] == 0) {
+			continue; // nothing was transferred
+		}
+
+		if (mock->desc_offset[chan] != 0 || !(mock->rings[chan].descs[index - 1].flags & DMA_DESC_EOF)) {
+			mock->error = true;
+		}
+	}
+}
+
+static bool mock_submit(void *ctx, DmaChannel chan, const DmaRing *ring)
+{
+	DmaMock *mock = ctx;
+
+	// A channel must retire all of its descriptors before it is handed new ones
+	if (!channel_drained(mock, chan)) {
+		return false;
+	}
+
+	// Like the real engines, take a copy of the descriptors,
+	// so that the caller is free to reuse its ring afterwards.
+	DmaRing *own = &mock->rings[chan];
+
+	if (ring->count > own->capacity) {
+		DmaDesc *descs = realloc(own->descs, ring->count * sizeof descs[0]);
+
+		if (descs == NULL) {
+			return false;
+		}
+
+		own->descs = descs;
+		own->capacity = ring->count;
+	}
+
+	memcpy(own->descs, ring->descs, ring->count * sizeof own->descs[0]);
+	own->count = ring->count;
+
+	mock->desc_index[chan] = 0;
+	mock->desc_offset[chan] = 0;
+	mock->num_submits++;
+
+	return true;
+}
+
+static bool mock_channel_busy(void *ctx, DmaChannel chan)
+{
+	DmaMock *mock = ctx;
+	mock->num_polls++;
+
+	// The mock core runs synchronously, so leftover descriptors
+	// would never be consumed. Report them instead of hanging.
+	if (!channel_drained(mock, chan)) {
+		mock->error = true;
+		mock->desc_index[chan] = mock->rings[chan].count;
+	}
+
+	return false;
+}
+
+static double now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Runs the whole row synchronously, so the core is never busy afterwards
+static void mock_start_row(void *ctx, const DmaRowArgs *args)
+{
+	static Dihedral seq_ver[MOCK_MAX_SEQ_LEN];
+	static Dihedral seq_hor[MOCK_MAX_SEQ_LEN];
+
+	DmaMock *mock = ctx;
+	size_t desc_index_before[DMA_NUM_CHANNELS];
+
+	double t_begin = now();
+
+	mock->num_starts++;
+	memcpy(desc_index_before, mock->desc_index, sizeof desc_index_before);
+
+	mock_transfer(mock, DMA_CHAN_VER, seq_ver, args->stream_size_ver * sizeof seq_ver[0]);
+
+	for (seq_count_type j = 0; j < args->num_streams_hor; j++) {
+		index_type len_hor = 0;
+
+		mock_transfer(mock, DMA_CHAN_HOR_SIZES, &len_hor, sizeof len_hor);
+
+		if (len_hor < 0) {
+			mock->error = true;
+			break;
+		}
+
+		mock_transfer(mock, DMA_CHAN_HOR, seq_hor, len_hor * sizeof seq_hor[0]);
+
+		score_type score = dma_mock_score(seq_ver, args->stream_size_ver, seq_hor, len_hor);
+		mock_transfer(mock, DMA_CHAN_OUT_SCORES, &score, sizeof score);
+	}
+
+	check_end_of_row(mock, desc_index_before);
+
+	mock->core_seconds += now() - t_begin;
+}
+
+static bool mock_core_busy(void *ctx)
+{
+	DmaMock *mock = ctx;
+	mock->num_polls++;
+	return false;
+}
+
+void dma_mock_init(DmaMock *mock)
+{
+	memset(mock, 0, sizeof *mock);
+}
+
+void dma_mock_free(DmaMock *mock)
+{
+	for (int chan = 0; chan < DMA_NUM_CHANNELS; chan++) {
+		free(mock->rings[chan].descs);
+		mock->rings[chan].descs = NULL;
+	}
+}
+
+DmaBackend dma_mock_backend(DmaMock *mock)
+{
+	DmaBackend backend = {
+		.ctx = mock,
+		.submit = mock_submit,
+		.channel_busy = mock_channel_busy,
+		.start_row = mock_start_row,
+		.core_busy = mock_core_busy,
+	};
+
+	return backend;
+}
+
+score_type dma_mock_score(const Dihedral *seq_ver, index_type len_ver, const Dihedral *seq_hor, index_type len_hor)
+{
+	// unsigned, so that overflow wraps around instead of being undefined
+	uint32_t hash = 31u * len_ver + len_hor;
+
+	for (index_type k = 0; k < len_ver; k++) {
+		hash = hash * 7u + (uint16_t)seq_ver[k].phi;
+	}
+
+	for (index_type k = 0; k < len_hor; k++) {
+		hash = hash * 5u + (uint16_t)seq_hor[k].psi;
+	}
+
+	return (score_type)(hash & 0x7fffffff);
+}
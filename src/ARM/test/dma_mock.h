@@ -0,0 +1,47 @@
+/*
+ * dma_mock.h
+ *
+ *  Created on: Oct 18, 2026
+ *
+ * Software model of the DMA engines and the alignment core,
+ * for exercising the scatter-gather driver logic on Linux.
+ */
+
+#ifndef DMA_MOCK_H_
+#define DMA_MOCK_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "dma_ring.h"
+
+
+typedef struct DmaMock {
+	DmaRing rings[DMA_NUM_CHANNELS];        // copies of the rings submitted to each channel
+	size_t desc_index[DMA_NUM_CHANNELS];    // next descriptor to be consumed
+	size_t desc_offset[DMA_NUM_CHANNELS];   // bytes already consumed of that descriptor
+
+	// Counters of interactions between the CPU and the (mock) hardware
+	size_t num_submits;
+	size_t num_polls;
+	size_t num_starts;
+
+	// Time spent "computing" inside the mock core, which is not driver overhead
+	double core_seconds;
+
+	// Set if the core consumed or produced data inconsistently with the descriptors
+	bool error;
+} DmaMock;
+
+
+void dma_mock_init(DmaMock *mock);
+
+void dma_mock_free(DmaMock *mock);
+
+DmaBackend dma_mock_backend(DmaMock *mock);
+
+// The "alignment" computed by the mock core. It is not Smith-Waterman,
+// just a cheap function of both sequences that detects misrouted data.
+score_type dma_mock_score(const Dihedral *seq_ver, index_type len_ver, const Dihedral *seq_hor, index_type len_hor);
+
+#endif /* DMA_MOCK_H_ */
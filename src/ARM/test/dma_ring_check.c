@@ -0,0 +1,204 @@
+/*
+ * dma_ring_check.c
+ *
+ *  Created on: Oct 18, 2026
+ *
+ * Runs the scatter-gather driver logic against the mock DMA backend
+ * on a random database, checks that every score arrives where it should,
+ * and measures the per-row CPU overhead of driving the rings, i.e. the
+ * time spent building and running batches outside of the (mock) core.
+ *
+ * usage: dma_ring_check [num_seqs] [seed]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "dma_ring.h"
+#include "dma_mock.h"
+
+
+#define MAX_SEQ_LEN     511
+#define MAX_DESC_LEN    4096  // deliberately small, so that rows are split
+#define MAX_DESCS       4096
+#define NUM_REPEATS     20
+
+
+static uint64_t rng_state;
+
+static uint32_t next_random(void)
+{
+	// xorshift64*
+	rng_state ^= rng_state >> 12;
+	rng_state ^= rng_state << 25;
+	rng_state ^= rng_state >> 27;
+	return (uint32_t)((rng_state * 0x2545F4914F6CDD1Dull) >> 32);
+}
+
+static double now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void make_sequences(Sequences *seqs, seq_count_type num_seqs)
+{
+	size_t total_len = 0;
+
+	seqs->num_sequences = num_seqs;
+	seqs->sequence_lengths = malloc(num_seqs * sizeof seqs->sequence_lengths[0]);
+
+	for (seq_count_type i = 0; i < num_seqs; i++) {
+		// every 16th sequence is empty, which must not produce any descriptors
+		seqs->sequence_lengths[i] = i % 16 == 5 ? 0 : next_random() % MAX_SEQ_LEN + 1;
+		total_len += seqs->sequence_lengths[i];
+	}
+
+	seqs->buffer = malloc(total_len * sizeof seqs->buffer[0]);
+
+	for (size_t k = 0; k < total_len; k++) {
+		uint32_t r = next_random();
+		seqs->buffer[k].phi = (angle_type)(r & 0xffff);
+		seqs->buffer[k].psi = (angle_type)(r >> 16);
+	}
+}
+
+typedef struct RunStats {
+	size_t num_rows;
+	size_t num_batches;
+	size_t num_submits;
+	size_t num_polls;
+	size_t num_errors;
+	double seconds;
+} RunStats;
+
+// Compute the whole triangle with batches of at most 'max_rows' rows,
+// like run_align() does, and verify every score.
+static RunStats run_triangle(const Sequences *seqs, size_t max_rows)
+{
+	RunStats stats = { 0 };
+	DmaBatch batch;
+	DmaMock mock;
+	DmaBackend backend = dma_mock_backend(&mock);
+
+	size_t max_scores = seqs->num_sequences * 4;
+	score_type *out_scores = malloc(max_scores * sizeof out_scores[0]);
+
+	if (!dma_batch_init(&batch, max_rows, MAX_DESCS, max_scores, MAX_DESC_LEN)) {
+		fprintf(stderr, "out of memory\n");
+		exit(EXIT_FAILURE);
+	}
+
+	dma_mock_init(&mock);
+
+	const Dihedral *seq_ver = seqs->buffer;
+	seq_count_type i = 0;
+
+	while (i + 1 < seqs->num_sequences) {
+		double t_begin = now();
+		size_t num_rows = dma_batch_build(&batch, seqs, i, seq_ver, out_scores);
+		bool ok = num_rows > 0 && dma_batch_run(&backend, &batch);
+
+		stats.seconds += now() - t_begin;
+
+		if (!ok) {
+			fprintf(stderr, "batch at row %lu could not be run\n", (unsigned long)i);
+			stats.num_errors++;
+			break;
+		}
+
+		// Check scores of the batch
+		const score_type *row_scores = out_scores;
+
+		for (size_t r = 0; r < num_rows; r++, i++) {
+			const Dihedral *seq_hor = seq_ver + seqs->sequence_lengths[i];
+
+			for (seq_count_type j = i + 1; j < seqs->num_sequences; j++) {
+				score_type expected = dma_mock_score(
+					seq_ver, seqs->sequence_lengths[i],
+					seq_hor, seqs->sequence_lengths[j]
+				);
+
+				if (*row_scores++ != expected) {
+					stats.num_errors++;
+				}
+
+				seq_hor += seqs->sequence_lengths[j];
+			}
+
+			seq_ver += seqs->sequence_lengths[i];
+		}
+
+		stats.num_rows += num_rows;
+		stats.num_batches++;
+	}
+
+	stats.seconds -= mock.core_seconds;
+	stats.num_submits = mock.num_submits;
+	stats.num_polls = mock.num_polls;
+	stats.num_errors += mock.error;
+
+	dma_mock_free(&mock);
+	dma_batch_free(&batch);
+	free(out_scores);
+
+	return stats;
+}
+
+static void report(const char *name, const Sequences *seqs, size_t max_rows)
+{
+	RunStats stats = { 0 };
+	double best = 0.0;
+
+	for (int k = 0; k < NUM_REPEATS; k++) {
+		stats = run_triangle(seqs, max_rows);
+
+		if (k == 0 || stats.seconds < best) {
+			best = stats.seconds;
+		}
+	}
+
+	printf(
+		"%-16s rows: %lu  batches: %lu  submits/row: %.3f  polls/row: %.3f  "
+		"overhead/row: %.3f us  errors: %lu\n",
+		name,
+		(unsigned long)stats.num_rows,
+		(unsigned long)stats.num_batches,
+		stats.num_submits * 1.0 / stats.num_rows,
+		stats.num_polls * 1.0 / stats.num_rows,
+		best * 1e6 / stats.num_rows,
+		(unsigned long)stats.num_errors
+	);
+
+	if (stats.num_errors > 0 || stats.num_rows + 1 != seqs->num_sequences) {
+		exit(EXIT_FAILURE);
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	seq_count_type num_seqs = argc > 1 ? strtoul(argv[1], NULL, 10) : 200;
+	rng_state = argc > 2 ? strtoull(argv[2], NULL, 10) : 42;
+	rng_state = rng_state ? rng_state : 1;
+
+	if (num_seqs < 2) {
+		fprintf(stderr, "at least 2 sequences are required\n");
+		return EXIT_FAILURE;
+	}
+
+	Sequences seqs;
+	make_sequences(&seqs, num_seqs);
+
+	// One row per batch is what the simple transfer mode amounts to:
+	// every row is a separate round trip between the CPU and the engines.
+	report("per-row", &seqs, 1);
+	report("scatter-gather", &seqs, MAX_DESCS);
+
+	free(seqs.buffer);
+	free(seqs.sequence_lengths);
+
+	return 0;
+}
@@ -0,0 +1,168 @@
+/*
+ * seq_archive_check.c
+ *
+ *  Created on: Oct 18, 2026
+ *
+ * Decodes every sequence of an archive written by pack_seqs with the
+ * board's decoder, and checks it against the raw INPUT.BIN it was packed
+ * from. With "raw" or "delta", at least one sequence must have been
+ * stored raw, or delta-coded, respectively.
+ *
+ * usage: seq_archive_check INPUT.BIN INPUT.SWZ [raw|delta]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "seq_archive.h"
+
+
+// The whole file at 'path', or NULL
+static unsigned char *read_file(const char *path, size_t *size)
+{
+	FILE *file = fopen(path, "rb");
+	unsigned char *data = NULL;
+	long end = -1;
+
+	if (file != NULL && fseek(file, 0, SEEK_END) == 0) {
+		end = ftell(file);
+	}
+
+	if (end >= 0 && fseek(file, 0, SEEK_SET) == 0) {
+		data = malloc(end > 0 ? end : 1);
+
+		if (data != NULL && fread(data, 1, end, file) != (size_t)end) {
+			free(data);
+			data = NULL;
+		}
+	}
+
+	if (file != NULL) {
+		fclose(file);
+	}
+
+	*size = end;
+	return data;
+}
+
+static int fail(const char *what, seq_count_type i)
+{
+	fprintf(stderr, "sequence #%lu: %s\n", (unsigned long)i, what);
+	return EXIT_FAILURE;
+}
+
+int main(int argc, char *argv[])
+{
+	if (argc < 3 || argc > 4 || (argc == 4 && strcmp(argv[3], "raw") != 0 && strcmp(argv[3], "delta") != 0)) {
+		fprintf(stderr, "usage: %s INPUT.BIN INPUT.SWZ [raw|delta]\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	size_t raw_size, archive_size;
+	unsigned char *raw = read_file(argv[1], &raw_size);
+	unsigned char *archive = read_file(argv[2], &archive_size);
+	uint32_t magic;
+	seq_count_type num_seqs;
+
+	if (raw == NULL || archive == NULL || raw_size < sizeof num_seqs || archive_size < 2 * sizeof magic) {
+		fprintf(stderr, "can't read '%s' and '%s'\n", argv[1], argv[2]);
+		return EXIT_FAILURE;
+	}
+
+	memcpy(&magic, archive, sizeof magic);
+	memcpy(&num_seqs, raw, sizeof num_seqs);
+
+	if (magic != SEQ_ARCHIVE_MAGIC || memcmp(archive + sizeof magic, &num_seqs, sizeof num_seqs) != 0) {
+		fprintf(stderr, "'%s' is not an archive of '%s'\n", argv[2], argv[1]);
+		return EXIT_FAILURE;
+	}
+
+	if (archive_size < SEQ_ARCHIVE_DATA_OFFSET(num_seqs) || raw_size < sizeof num_seqs + num_seqs * sizeof(index_type)) {
+		fprintf(stderr, "'%s' or '%s' is truncated\n", argv[1], argv[2]);
+		return EXIT_FAILURE;
+	}
+
+	// The index, as the loader reads it
+	Sequences seqs;
+	seqs.buffer = NULL;
+	seqs.num_sequences = num_seqs;
+	seqs.sequence_lengths = malloc(num_seqs * sizeof seqs.sequence_lengths[0]);
+	seqs.code_offsets = malloc((num_seqs + 1) * sizeof seqs.code_offsets[0]);
+
+	memcpy(seqs.sequence_lengths, archive + 2 * sizeof magic, num_seqs * sizeof seqs.sequence_lengths[0]);
+	memcpy(seqs.code_offsets, archive + SEQ_ARCHIVE_INDEX_OFFSET(num_seqs), (num_seqs + 1) * sizeof seqs.code_offsets[0]);
+
+	if (memcmp(seqs.sequence_lengths, raw + sizeof num_seqs, num_seqs * sizeof seqs.sequence_lengths[0]) != 0) {
+		fprintf(stderr, "the lengths of '%s' and '%s' differ\n", argv[1], argv[2]);
+		return EXIT_FAILURE;
+	}
+
+	if (!seq_archive_index_valid(&seqs) || archive_size != SEQ_ARCHIVE_DATA_OFFSET(num_seqs) + seqs.code_offsets[num_seqs]) {
+		fprintf(stderr, "the offset index of '%s' is invalid\n", argv[2]);
+		return EXIT_FAILURE;
+	}
+
+	const unsigned char *code = archive + SEQ_ARCHIVE_DATA_OFFSET(num_seqs);
+	const unsigned char *expected = raw + sizeof num_seqs + num_seqs * sizeof seqs.sequence_lengths[0];
+	size_t expected_size = raw_size - (expected - raw);
+	Dihedral *buf = malloc(512 * sizeof buf[0]);
+	seq_count_type num_raw = 0, num_delta = 0;
+
+	for (seq_count_type i = 0; i < num_seqs; i++) {
+		index_type length = seqs.sequence_lengths[i];
+		const unsigned char *src = code + seqs.code_offsets[i];
+		const unsigned char *src_end = code + seqs.code_offsets[i + 1];
+
+		if (length > 512 || expected_size < length * sizeof buf[0]) {
+			return fail("is longer than the raw file", i);
+		}
+
+		if (!seq_archive_decode(src, src_end, length, buf)) {
+			return fail("can't be decoded", i);
+		}
+
+		if (memcmp(buf, expected, length * sizeof buf[0]) != 0) {
+			return fail("decodes to other dihedrals than in the raw file", i);
+		}
+
+		if (length > 0 && src_end - src == length * SEQ_ARCHIVE_RAW_RESIDUE_SIZE) {
+			num_raw++;
+		} else if (length > 0) {
+			num_delta++;
+
+			// a varint code cut short must be rejected
+			if (seq_archive_decode(src, src_end - 1, length, buf)) {
+				return fail("was decoded without its last byte", i);
+			}
+		}
+
+		expected += length * sizeof buf[0];
+		expected_size -= length * sizeof buf[0];
+	}
+
+	if (expected_size != 0) {
+		fprintf(stderr, "'%s' has data beyond its sequences\n", argv[1]);
+		return EXIT_FAILURE;
+	}
+
+	if (argc == 4 && (strcmp(argv[3], "raw") == 0 ? num_raw : num_delta) == 0) {
+		fprintf(stderr, "no sequence of '%s' is stored %s\n", argv[2], argv[3]);
+		return EXIT_FAILURE;
+	}
+
+	printf(
+		"%lu sequences: %lu raw, %lu delta-coded\n",
+		(unsigned long)num_seqs,
+		(unsigned long)num_raw,
+		(unsigned long)num_delta
+	);
+
+	free(buf);
+	free(seqs.sequence_lengths);
+	free(seqs.code_offsets);
+	free(archive);
+	free(raw);
+
+	return EXIT_SUCCESS;
+}
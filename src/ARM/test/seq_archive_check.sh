@@ -0,0 +1,36 @@
+#!/bin/sh
+#
+# Packs random databases with the host's pack_seqs, and checks that the
+# board's decoder restores them: uncorrelated angles are stored raw,
+# random walks delta-coded.
+#
+# usage: ./seq_archive_check.sh [num_seqs]
+# (from src/ARM/test, after `make seq_archive_check` here
+# and `make pack_seqs gen_random_seqs` in src/FPGA)
+#
+
+set -e
+
+FPGA=../../FPGA
+NUM_SEQS=${1:-200}
+
+for TOOL in pack_seqs gen_random_seqs; do
+	if [ ! -x "$FPGA/$TOOL" ]; then
+		echo "$FPGA/$TOOL not found, run \`make $TOOL\` in src/FPGA first"
+		exit 1
+	fi
+done
+
+TMP=$(mktemp -d)
+trap 'rm -rf "$TMP"' EXIT
+
+for CASE in "0 raw" "40 delta"; do
+	set -- $CASE
+
+	"$FPGA/gen_random_seqs" genseq "$TMP/INPUT.BIN" --count "$NUM_SEQS" --seed 43 --max-len 512 --walk-step "$1"
+	"$FPGA/pack_seqs" "$TMP/INPUT.BIN" "$TMP/INPUT.SWZ" 2>/dev/null
+
+	./seq_archive_check "$TMP/INPUT.BIN" "$TMP/INPUT.SWZ" "$2"
+done
+
+echo "archive decoder check passed ($NUM_SEQS sequences)"
@@ -19,6 +19,11 @@
 
 #include "util.hh"
 #include "align.hh"
+#include "scoring.hh"
+
+#ifndef __SYNTHESIS__
+#include "stream_views.hh"
+#endif
 
 
 // The optimizer is not smart enough to realize that a loop has a constant
@@ -44,31 +49,57 @@ static T array_max(std::array<T, N> arr)
 	return result;
 }
 
-static unsigned_angle_type angle_abs_diff(angle_type x, angle_type y)
+// Score of a step from 'cell' that adds 'delta', clamped at zero: cells
+// narrower than score_type would otherwise wrap around on the large negative
+// similarities of dissimilar residues. Local alignment never goes below zero.
+template<typename Cell>
+static Cell step_score(Cell cell, score_type delta)
 {
 #pragma HLS INLINE
-	angle_type signed_diff = angle_type(unsigned_angle_type(x) - unsigned_angle_type(y));
-	// An explicit implementation of absolute value is done here inline,
-	// because std::abs<angle_type> compiles to crazy floating-point stuff.
-	return signed_diff < 0 ? -signed_diff : +signed_diff;
+	score_type sum = score_type(cell) + delta;
+	return sum < 0 ? Cell(0) : Cell(sum);
 }
 
-static score_type dihedral_score(Dihedral angle1, Dihedral angle2, score_type offset)
+// Entry of the horizontal propagation buffer for 'cell', given the cell above it
+template<typename Cell>
+static typename Boundary<Cell>::type boundary_encode(Cell cell, Cell cell_above, score_type gap_penalty)
 {
 #pragma HLS INLINE
-	score_type dphi = angle_abs_diff(angle1.phi, angle2.phi);
-	score_type dpsi = angle_abs_diff(angle1.psi, angle2.psi);
-	return offset - (dphi * dphi + dpsi * dpsi);
+#if BOUNDARY_DELTA_BITS > 0
+	return typename Boundary<Cell>::type(cell - cell_above - gap_penalty);
+#else
+	(void)cell_above;
+	(void)gap_penalty;
+	return cell;
+#endif
 }
 
-score_type align_one(
-	hls::stream<Dihedral> &stream_ver,
+// Inverse of boundary_encode(): the cell of a buffer entry, given the cell above it.
+// Rows are read from top to bottom, so the cell above has just been decoded.
+template<typename Cell>
+static Cell boundary_decode(typename Boundary<Cell>::type entry, Cell cell_above, score_type gap_penalty)
+{
+#pragma HLS INLINE
+#if BOUNDARY_DELTA_BITS > 0
+	return Cell(score_type(entry) + cell_above + gap_penalty);
+#else
+	(void)cell_above;
+	(void)gap_penalty;
+	return entry;
+#endif
+}
+
+template<typename ScoringPolicy, typename Cell, typename SeqStream>
+static Cell align_one(
+	SeqStream &stream_ver,
 	index_type stream_size_ver,
-	hls::stream<Dihedral> &stream_hor,
+	SeqStream &stream_hor,
 	index_type stream_size_hor,
 	score_type scoring_offset,
 	score_type gap_penalty,
-	bool should_read_ver_stream
+	index_type band_width,
+	bool should_read_ver_stream,
+	bool &touched_edge
 )
 {
 #pragma HLS INLINE
@@ -85,21 +116,22 @@ score_type align_one(
 #pragma HLS reset variable=seq_ver off
 #pragma HLS reset variable=seq_hor off
 
-	score_type hor_prop_buf[WIN_ROWS]; // = { 0 };
+	typename Boundary<Cell>::type hor_prop_buf[WIN_ROWS]; // = { 0 };
 
-	score_type diag_buf_old[WIN_COLS];
-	score_type diag_buf_new[WIN_COLS];
+	Cell diag_buf_old[WIN_COLS];
+	Cell diag_buf_new[WIN_COLS];
 #else
-	static std::vector<Dihedral> seq_ver(WIN_ROWS, { -1, -1 });
-	static std::vector<Dihedral> seq_hor(WIN_COLS, { -1, -1 });
+	// thread-local, so that the C simulation can run on several threads
+	static thread_local std::vector<Dihedral> seq_ver(WIN_ROWS, { -1, -1 });
+	static thread_local std::vector<Dihedral> seq_hor(WIN_COLS, { -1, -1 });
 
-	std::vector<score_type> hor_prop_buf(WIN_ROWS, -1);
+	std::vector<typename Boundary<Cell>::type> hor_prop_buf(WIN_ROWS, typename Boundary<Cell>::type(-1));
 
 	// 1000 is an arbitrarily big positive pseudo-"garbage" value that is
 	// used for checking whether boundary conditions are implemented correctly
 	// so that huge leftover values don't mess up computation of the maximum.
-	std::vector<score_type> diag_buf_old(WIN_COLS, 1000);
-	std::vector<score_type> diag_buf_new(WIN_COLS, 1000);
+	std::vector<Cell> diag_buf_old(WIN_COLS, Cell(1000));
+	std::vector<Cell> diag_buf_new(WIN_COLS, Cell(1000));
 #endif
 
 	assert(std::end(seq_ver) - std::begin(seq_ver) == WIN_ROWS);
@@ -118,9 +150,14 @@ score_type align_one(
 
 	// These are set to the appropriate fraction of the window width and height,
 	// respectively, when the sequence size is not an integer multiple thereof.
-	index_type max_valid_row;
+	index_type max_valid_row = WIN_ROWS;
 	index_type max_valid_col;
 
+	// First and last diagonal of the current window that are computed.
+	// In banded mode, the cells of the other diagonals are all outside the band.
+	index_type i_begin;
+	index_type i_last;
+
 	// +------+------+
 	// |(0, 0)|(0, 1)|
 	// +------+------+
@@ -133,13 +170,13 @@ score_type align_one(
 	// The negative powers of two serve merely as distinct-from-negative-one
 	// indicators of "uninitialized value". This window is updated in a manner
 	// so that it doesn't need to be initialized explicitly.
-	score_type lah_buf[2][2]; // = { { -128, -256 }, { -512, -1024 } };
+	Cell lah_buf[2][2]; // = { { -128, -256 }, { -512, -1024 } };
 #pragma HLS ARRAY_PARTITION variable=lah_buf complete dim=0
 
 	// we always read the next element of the diagonal buffers into
 	// registers so that they can be used as many times as necessary.
-	score_type diag_buf_old_next_cell;
-	score_type diag_buf_new_next_cell;
+	Cell diag_buf_old_next_cell;
+	Cell diag_buf_new_next_cell;
 
 	// We should not read the horizontal propagation buffer twice in an iteration,
 	// hence we created this small shift register.
@@ -149,12 +186,18 @@ score_type align_one(
 	// +---+         |  sliding downward
 	// | 1 | i - 1   v
 	// +---+
-	score_type hor_prop_buf_next_cells[2]; // = { -2048, -4096 };
+	Cell hor_prop_buf_next_cells[2]; // = { -2048, -4096 };
 #pragma HLS ARRAY_PARTITION variable=hor_prop_buf_next_cells complete dim=0
 
 	// score is always non-negative -> this is OK
-	score_type max_score = 0;
-	score_type cur_score;
+	Cell max_score = 0;
+	Cell cur_score;
+
+	// Banded mode: global column minus row of the current cell, whether it's
+	// within the band, and the maximum of the cells on the edge of the band
+	int diag_offset;
+	bool in_band;
+	Cell edge_max_score = 0;
 
 	// These registers are used for reading into seq_hor and ver_hor RAMs
 	Dihedral seq_hor_read_reg;
@@ -175,8 +218,40 @@ score_type align_one(
 hor_window_loop:
 	for (h = 0; h < WIN_COUNT_HOR; h++) {
 
+		// Set column boundary in order to handle partial windows
+		max_valid_col = WIN_COLS;
+
+		// In banded mode, cells above the band are zero, and so are their
+		// neighbors to the left on the diagonal before the first one
+		// that has a cell within the band: start from that diagonal, and
+		// stop after the last one that has. The first window reads the
+		// vertical sequence, so it goes through every row regardless.
+		i_begin = band_width < 0 ? 0 : std::max(0, h * WIN_COLS - band_width - 1);
+		i_last = stream_size_ver_orig + WIN_COLS - 1;
+
+		if (band_width >= 0 && h > 0 && h * WIN_COLS + 2 * (WIN_COLS - 1) + band_width < i_last) {
+			i_last = h * WIN_COLS + 2 * (WIN_COLS - 1) + band_width;
+		}
+
+		// The diagonals that would have read the horizontal sequence
+		// at their top row may be skipped, so read it upfront
+		if (i_begin > 0) {
+		hor_read_loop:
+			for (j = 0; j < WIN_COLS; j++) {
+#pragma HLS PIPELINE II=1
+				if (stream_size_hor == 0) {
+					if (j < max_valid_col) {
+						max_valid_col = j;
+					}
+				} else {
+					seq_hor[j] = stream_hor.read();
+					stream_size_hor--;
+				}
+			}
+		}
+
 	diag_loop:
-		for (i = 0; i < WIN_DIAGS; i++) {
+		for (i = i_begin; i < WIN_DIAGS; i++) {
 
 		col_loop:
 			for (j = 0; j < WIN_COLS; j++) {
@@ -191,16 +266,19 @@ hor_window_loop:
 
 				// read horizontal propagation buffer at the beginning of each diagonal,
 				// and update its temporary shift register
+				// In banded mode, rows below the band of the previous window's last column
+				// are not computed, so their entries are stale; those cells are zero.
 				if (j == 0 && i < WIN_ROWS) {
-					hor_prop_buf_next_cells[0] = 0 < i ? hor_prop_buf_next_cells[1] : 0;
-					hor_prop_buf_next_cells[1] = 0 < h ? hor_prop_buf[i] : 0;
-					hls_debug("hor_prop_buf_next_cells = [%d, %d]\n", hor_prop_buf_next_cells[0], hor_prop_buf_next_cells[1]);
+					bool left_in_band = band_width < 0 || i - (h * WIN_COLS - 1) <= band_width;
+					hor_prop_buf_next_cells[0] = i_begin < i ? hor_prop_buf_next_cells[1] : Cell(0);
+					hor_prop_buf_next_cells[1] = 0 < h && left_in_band ? boundary_decode(hor_prop_buf[i], hor_prop_buf_next_cells[0], gap_penalty) : Cell(0);
+					hls_debug("hor_prop_buf_next_cells = [%d, %d]\n", score_type(hor_prop_buf_next_cells[0]), score_type(hor_prop_buf_next_cells[1]));
 				}
 
 				// Update temporary registers
 				if (j == 0) {
-					lah_buf[0][0] = i < 1 ? 0 : hor_prop_buf_next_cells[0];
-					lah_buf[1][0] = i < 0 ? 0 : hor_prop_buf_next_cells[1];
+					lah_buf[0][0] = i < 1 ? Cell(0) : hor_prop_buf_next_cells[0];
+					lah_buf[1][0] = i < 0 ? Cell(0) : hor_prop_buf_next_cells[1];
 				} else {
 					lah_buf[0][0] = lah_buf[0][1];
 					lah_buf[1][0] = lah_buf[1][1];
@@ -212,27 +290,18 @@ hor_window_loop:
 				// when the sequence length is not an integer multiple of
 				// the window size) will have correct values even on the
 				// boundaries (since not all invalid elements of a partial
-				// window are out of bounds!)
-				diag_buf_old_next_cell = j <= i - 2 ? diag_buf_old[j] : 0;
-				diag_buf_new_next_cell = j <= i - 1 ? diag_buf_new[j] : 0;
+				// window are out of bounds!) Skipped diagonals are zeros.
+				diag_buf_old_next_cell = j <= i - 2 && i_begin <= i - 2 ? diag_buf_old[j] : Cell(0);
+				diag_buf_new_next_cell = j <= i - 1 && i_begin <= i - 1 ? diag_buf_new[j] : Cell(0);
 
-				lah_buf[0][1] = i < 2 ? 0 : diag_buf_old_next_cell;
-				lah_buf[1][1] = i < 1 ? 0 : diag_buf_new_next_cell;
+				lah_buf[0][1] = i < 2 ? Cell(0) : diag_buf_old_next_cell;
+				lah_buf[1][1] = i < 1 ? Cell(0) : diag_buf_new_next_cell;
 
 				// if the cell coordinates are OOB, don't try to compute them.
 				// 'c' should always be within bounds, because it's equal to j.
 				in_bounds = 0 <= r && r < WIN_ROWS /* && 0 <= c && c < WIN_COLS */;
 				assert(0 <= c && c < WIN_COLS);
 
-				// Set row and column boundaries in order to handle partial windows
-				if (i == 0 && j == 0) {
-					if (h == 0) {
-						max_valid_row = WIN_ROWS;
-					}
-
-					max_valid_col = WIN_COLS;
-				}
-
 				// Read in vertical sequence buffer if necessary,
 				// i.e. at the beginning of every horizontal row of windows,
 				// indicated by the horizontal window index being reset to 0.
@@ -267,8 +336,8 @@ hor_window_loop:
 				}
 
 				// Read in horizontal sequence buffer if necessary,
-				// i.e. at the beginning of each window
-				if (r == 0) {
+				// i.e. at the beginning of each window, unless it's been read upfront
+				if (r == 0 && i_begin == 0) {
 					// if (stream_hor.empty()) {
 					if (stream_size_hor == 0) {
 						if (c < max_valid_col) {
@@ -291,7 +360,7 @@ hor_window_loop:
 				// on previous cells (those with smaller indices) only, so
 				// calculating garbage values doesn't affect the correctness
 				// of valid, within-bounds cells.
-				if (r == 0) {
+				if (r == 0 && i_begin == 0) {
 					seq_hor_comp_reg = seq_hor_read_reg;
 				} else {
 					seq_hor_comp_reg = seq_hor[c];
@@ -303,22 +372,34 @@ hor_window_loop:
 					seq_ver_comp_reg = seq_ver[size_type(r) & WIN_ROWS_MASK];
 				}
 
-				cur_score = array_max<score_type, 4>({
-					lah_buf[0][0] /* diag neighbor */ + dihedral_score(seq_ver_comp_reg, seq_hor_comp_reg, scoring_offset),
-					lah_buf[1][0] /* left neighbor */ + gap_penalty,
-					lah_buf[1][1] /* top  neighbor */ + gap_penalty,
-					score_type(0) /* align locally */
+				cur_score = array_max<Cell, 4>({
+					step_score(lah_buf[0][0] /* diag neighbor */, ScoringPolicy::score(seq_ver_comp_reg, seq_hor_comp_reg, scoring_offset)),
+					step_score(lah_buf[1][0] /* left neighbor */, gap_penalty),
+					step_score(lah_buf[1][1] /* top  neighbor */, gap_penalty),
+					Cell(0) /* align locally */
 				});
 
+				// cells outside the band are zero, so no path leaves the band
+				diag_offset = h * WIN_COLS + c - r;
+				in_band = band_width < 0 || (-band_width <= diag_offset && diag_offset <= band_width);
+
+				if (!in_band) {
+					cur_score = 0;
+				}
+
 				// accumulate maximum if it's valid
 				if (in_bounds && r < max_valid_row && c < max_valid_col) {
 					if (cur_score > max_score) {
 						max_score = cur_score;
 					}
 
+					if ((diag_offset == band_width || diag_offset == -band_width) && cur_score > edge_max_score) {
+						edge_max_score = cur_score;
+					}
+
 					hls_debug("r=%td  c=%td\n", std::ptrdiff_t(r), std::ptrdiff_t(c));
-					hls_debug("%3d %3d\n%3d %3d\n", lah_buf[0][0], lah_buf[0][1], lah_buf[1][0], lah_buf[1][1]);
-					hls_debug("    score = %d\n", cur_score);
+					hls_debug("%3d %3d\n%3d %3d\n", score_type(lah_buf[0][0]), score_type(lah_buf[0][1]), score_type(lah_buf[1][0]), score_type(lah_buf[1][1]));
+					hls_debug("    score = %d\n", score_type(cur_score));
 				}
 
 				// Shift values in diagonal buffers
@@ -327,17 +408,18 @@ hor_window_loop:
 
 				// propagate cells in the last column of each row rightwards
 				if (c == WIN_COLS - 1) {
-					hls_debug("    rightward-propagating end of row[%td] = %d\n", std::ptrdiff_t(r), cur_score);
+					hls_debug("    rightward-propagating end of row[%td] = %d\n", std::ptrdiff_t(r), score_type(cur_score));
 
 					if (in_bounds) {
-						hor_prop_buf[r] = cur_score;
+						// the top neighbor is the cell above in the same column
+						hor_prop_buf[r] = boundary_encode(cur_score, lah_buf[1][1], gap_penalty);
 					}
 				}
 
 				hls_debug("\n");
 			}
 
-			if (i == stream_size_ver_orig + WIN_COLS - 1) {
+			if (i == i_last) {
 				break;
 			}
 		}
@@ -345,62 +427,69 @@ hor_window_loop:
 		if (stream_size_hor == 0) {
 			break;
 		}
+
+		// Windows right of the band have no cells to compute,
+		// but their residues must still be consumed
+		if (band_width >= 0 && (h + 1) * WIN_COLS > stream_size_ver_orig - 1 + band_width) {
+		hor_skip_loop:
+			for (; stream_size_hor > 0; stream_size_hor--) {
+#pragma HLS LOOP_TRIPCOUNT max=MAX_SEQ_SIZE
+#pragma HLS PIPELINE II=1
+				stream_hor.read();
+			}
+
+			break;
+		}
 	}
 
+	touched_edge = band_width >= 0 && max_score > 0 && edge_max_score == max_score;
+
 	return max_score;
 }
 
-void align(
-	hls::stream<Dihedral> &stream_ver,
+template<typename ScoringPolicy, typename Cell, typename SeqStream, typename SizeStream, typename ScoreStream>
+void align_with(
+	SeqStream &stream_ver,
 	index_type stream_size_ver,
-	hls::stream<Dihedral> &streams_hor,
-	hls::stream<index_type> &stream_sizes_hor,
+	SeqStream &streams_hor,
+	SizeStream &stream_sizes_hor,
 	seq_count_type num_streams_hor,
 	score_type scoring_offset,
 	score_type gap_penalty,
-	hls::stream<axi_out_score_type> &out_scores
+	index_type band_width,
+	ScoreStream &out_scores
 )
 {
-#pragma HLS INTERFACE s_axilite port=stream_size_ver
-#pragma HLS INTERFACE s_axilite port=num_streams_hor
-#pragma HLS INTERFACE s_axilite port=scoring_offset
-#pragma HLS INTERFACE s_axilite port=gap_penalty
-
-#pragma HLS INTERFACE axis port=stream_ver
-#pragma HLS DATA_PACK variable=stream_ver
-
-#pragma HLS INTERFACE axis port=streams_hor
-#pragma HLS DATA_PACK variable=streams_hor
-
-#pragma HLS INTERFACE axis port=stream_sizes_hor
-
-#pragma HLS INTERFACE axis port=out_scores
-
-#pragma HLS INTERFACE s_axilite port=return
+#pragma HLS INLINE
 
 	bool should_read_ver_stream = true;
 
 align_loop:
 	for (seq_count_type i = 0; i < num_streams_hor; i++) {
 		index_type stream_size_hor = stream_sizes_hor.read();
+		bool touched_edge;
 
 		// Compute score
-		score_type score = align_one(
+		Cell score = align_one<ScoringPolicy, Cell, SeqStream>(
 			stream_ver,
 			stream_size_ver,
 			streams_hor,
 			stream_size_hor,
 			scoring_offset,
 			gap_penalty,
-			should_read_ver_stream
+			band_width,
+			should_read_ver_stream,
+			touched_edge
 		);
 
 		// Convert raw numeric value to AXI streamable type with side-band signals.
 		// Set the TLAST bit so that the DMA knows when to flush a potential partial burst.
 		// Set keep and strobe signals to all 1's (-1 in 2's complement)
+		// In banded mode, TUSER is set if the best cell lies on the edge of the band.
 		auto axi_score = axi_out_score_type{};
 
-		axi_score.data = score;
+		axi_score.data = score_type(score);
+		axi_score.user = touched_edge;
 		axi_score.keep = -1;
 		axi_score.strb = -1;
 		axi_score.last = i == num_streams_hor - 1;
@@ -411,3 +500,103 @@ align_loop:
 		should_read_ver_stream = false;
 	}
 }
+
+void align(
+	hls::stream<Dihedral> &stream_ver,
+	index_type stream_size_ver,
+	hls::stream<Dihedral> &streams_hor,
+	hls::stream<index_type> &stream_sizes_hor,
+	seq_count_type num_streams_hor,
+	score_type scoring_offset,
+	score_type gap_penalty,
+	index_type band_width,
+	hls::stream<axi_out_score_type> &out_scores
+)
+{
+#pragma HLS INTERFACE s_axilite port=stream_size_ver
+#pragma HLS INTERFACE s_axilite port=num_streams_hor
+#pragma HLS INTERFACE s_axilite port=scoring_offset
+#pragma HLS INTERFACE s_axilite port=gap_penalty
+#pragma HLS INTERFACE s_axilite port=band_width
+
+#pragma HLS INTERFACE axis port=stream_ver
+#pragma HLS DATA_PACK variable=stream_ver
+
+#pragma HLS INTERFACE axis port=streams_hor
+#pragma HLS DATA_PACK variable=streams_hor
+
+#pragma HLS INTERFACE axis port=stream_sizes_hor
+
+#pragma HLS INTERFACE axis port=out_scores
+
+#pragma HLS INTERFACE s_axilite port=return
+
+	align_with<SCORING_POLICY, cell_type>(
+		stream_ver,
+		stream_size_ver,
+		streams_hor,
+		stream_sizes_hor,
+		num_streams_hor,
+		scoring_offset,
+		gap_penalty,
+		band_width,
+		out_scores
+	);
+}
+
+#ifndef __SYNTHESIS__
+template<typename ScoringPolicy, typename Cell>
+void align_numeric_variant(
+	SeqStreamView &stream_ver,
+	index_type stream_size_ver,
+	SeqStreamView &streams_hor,
+	LengthStreamView &stream_sizes_hor,
+	seq_count_type num_streams_hor,
+	score_type scoring_offset,
+	score_type gap_penalty,
+	index_type band_width,
+	ScoreSinkView &out_scores
+)
+{
+	align_with<ScoringPolicy, Cell>(
+		stream_ver,
+		stream_size_ver,
+		streams_hor,
+		stream_sizes_hor,
+		num_streams_hor,
+		scoring_offset,
+		gap_penalty,
+		band_width,
+		out_scores
+	);
+}
+
+// Every policy is available to the C simulation, regardless of SCORING_POLICY,
+// and so are the numeric variants of engines.cc, regardless of CELL_TYPE;
+// all of them work on stream views
+#define INSTANTIATE_ALIGN_WITH(policy) \
+	template void align_with<policy>( \
+		SeqStreamView &, index_type, SeqStreamView &, LengthStreamView &, \
+		seq_count_type, score_type, score_type, index_type, ScoreSinkView & \
+	)
+
+#define INSTANTIATE_NUMERIC_VARIANT(policy, cell) \
+	template void align_numeric_variant<policy, cell>( \
+		SeqStreamView &, index_type, SeqStreamView &, LengthStreamView &, \
+		seq_count_type, score_type, score_type, index_type, ScoreSinkView & \
+	)
+
+INSTANTIATE_ALIGN_WITH(SquaredDistanceScore);
+INSTANTIATE_ALIGN_WITH(PhiWeightedScore);
+INSTANTIATE_ALIGN_WITH(CosineScore);
+INSTANTIATE_ALIGN_WITH(TableScore);
+
+INSTANTIATE_NUMERIC_VARIANT(SquaredDistanceScore,        score_type);
+INSTANTIATE_NUMERIC_VARIANT(Int17SquaredDistanceScore,   score_type);
+INSTANTIATE_NUMERIC_VARIANT(FloatSquaredDistanceScore,   score_type);
+INSTANTIATE_NUMERIC_VARIANT(Fixed17SquaredDistanceScore, score_type);
+INSTANTIATE_NUMERIC_VARIANT(Fixed12SquaredDistanceScore, score_type);
+INSTANTIATE_NUMERIC_VARIANT(SquaredDistanceScore,        ap_int<26>);
+INSTANTIATE_NUMERIC_VARIANT(SquaredDistanceScore,        std::int64_t);
+INSTANTIATE_NUMERIC_VARIANT(SquaredDistanceScore,        float);
+#endif // __SYNTHESIS__
@@ -14,6 +14,7 @@
 #include <cstdint>
 #include <climits>
 #include <hls_stream.h>
+#include <ap_int.h>
 #include <ap_axi_sdata.h>
 
 #include "util.hh"
@@ -39,10 +40,8 @@ static_assert(WIN_ROWS > 0 && (WIN_ROWS & (WIN_ROWS - 1)) == 0, "window height m
 #define WIN_COUNT_HOR     (MAX_SEQ_SIZE / WIN_COLS)
 #define WIN_COUNT_VER     (MAX_SEQ_SIZE / WIN_ROWS)
 
-// also try:
-// * int17? (compiles only under synthesis!)
-// * float
-// ap_fixed<17, 1, 8, 8>?
+// The type of angles in the streams and in memory; the angle differences
+// can be squared in other types, see SquaredDistanceScoreOf in scoring.hh.
 // XXX: this MUST be a signed type.
 typedef std::int16_t angle_type;
 
@@ -50,16 +49,85 @@ typedef std::uint16_t unsigned_angle_type;
 
 static_assert(sizeof(angle_type) == sizeof(unsigned_angle_type), "signed and unsigned angle types must have the same size");
 
-// TODO: what should this be? are 32 bits enough?
+// The type of scores in the output stream and on the host.
 // XXX: this MUST be a signed type.
 typedef std::int32_t score_type;
 
 static_assert(sizeof(unsigned_angle_type) < sizeof(score_type), "signed score_type must be able to represent every value of unsigned_angle_type");
 
+// The type of the cells of the dynamic programming matrix in align(),
+// which can be overridden from the command line to evaluate narrower or
+// wider cells, e.g. -DCELL_TYPE='ap_int<26>'. With offset 65536, a score
+// is at most 512 * 65536 = 2^25, so 26 bits hold every such cell.
+// Scores are output as score_type, whatever the cells are.
+#ifndef CELL_TYPE
+#define CELL_TYPE score_type
+#endif
+
+typedef CELL_TYPE cell_type;
+
 // This MUST be ap_axis<> if score_type is signed.
 // This MUST be ap_axiu<> if score_type is unsigned.
 typedef ap_axis<sizeof(score_type) * CHAR_BIT, 1, 1, 1> axi_out_score_type;
 
+// The horizontal propagation buffer holds the rightmost column of a window
+// (WIN_ROWS cells) for the next window. By default, its entries are full
+// scores. With BOUNDARY_DELTA_BITS > 0, each entry is instead the difference
+// from the cell above it, minus the gap penalty, as an unsigned integer of
+// that many bits; the next window reconstructs the scores by a running sum
+// as it reads the column from top to bottom. As long as every residue score
+// is at most scoring_offset, vertically adjacent cells differ by at least
+// gap_penalty and at most scoring_offset - gap_penalty, so 17 bits are enough
+// for e.g. offset 65536 and penalty -4000. See boundary_deltas_fit().
+#ifndef BOUNDARY_DELTA_BITS
+#define BOUNDARY_DELTA_BITS 0
+#endif
+
+#if BOUNDARY_DELTA_BITS > 0
+static_assert(BOUNDARY_DELTA_BITS < sizeof(score_type) * CHAR_BIT, "boundary deltas must be narrower than scores");
+#endif
+
+// Entry of the horizontal propagation buffer for cells of type 'Cell'
+template<typename Cell>
+struct Boundary {
+#if BOUNDARY_DELTA_BITS > 0
+	typedef ap_uint<BOUNDARY_DELTA_BITS> type;
+#else
+	typedef Cell type;
+#endif
+};
+
+// Whether the boundary buffer entries can represent every possible
+// difference of adjacent cells with these scoring parameters.
+// Always true if the buffer holds full scores.
+static inline bool boundary_deltas_fit(score_type scoring_offset, score_type gap_penalty)
+{
+#if BOUNDARY_DELTA_BITS > 0
+	return gap_penalty <= 0 && scoring_offset >= 0
+		&& std::int64_t(scoring_offset) - 2 * std::int64_t(gap_penalty) < (std::int64_t(1) << BOUNDARY_DELTA_BITS);
+#else
+	(void)scoring_offset;
+	(void)gap_penalty;
+	return true;
+#endif
+}
+
+// Banded mode: with band_width >= 0, align() only computes the cells of
+// row r and column c with |r - c| <= band_width, i.e. alignments that stay
+// within that many residues of the main diagonal; the rest count as zero,
+// and windows entirely to the right of the band are skipped. The TUSER bit
+// of a score is set if its best cell lies on the edge of the band, in
+// which case a wider band may give a higher score.
+// A negative band_width computes the full matrix.
+#define FULL_BAND (-1)
+
+// Cells above the band break the invariant that boundary deltas rely on,
+// so banded mode needs a horizontal propagation buffer of full scores.
+static inline bool band_supported(index_type band_width)
+{
+	return band_width < 0 || BOUNDARY_DELTA_BITS == 0;
+}
+
 struct Dihedral {
 	angle_type phi;
 	angle_type psi;
@@ -74,7 +142,54 @@ extern "C" void align(
 	seq_count_type num_streams_hor,
 	score_type scoring_offset,
 	score_type gap_penalty,
+	index_type band_width,
 	hls::stream<axi_out_score_type> &out_scores
 );
 
+// align() with the scoring policy (see scoring.hh) and the type of the
+// cells as template parameters. align() itself is align_with<SCORING_POLICY>;
+// in the C simulation, every policy of scoring.hh is instantiated in align.cc.
+// So are the types of the streams, which the C simulation replaces with
+// views of the sequences and the scores in memory (see stream_views.hh).
+template<
+	typename ScoringPolicy,
+	typename Cell = cell_type,
+	typename SeqStream = hls::stream<Dihedral>,
+	typename SizeStream = hls::stream<index_type>,
+	typename ScoreStream = hls::stream<axi_out_score_type>
+>
+void align_with(
+	SeqStream &stream_ver,
+	index_type stream_size_ver,
+	SeqStream &streams_hor,
+	SizeStream &stream_sizes_hor,
+	seq_count_type num_streams_hor,
+	score_type scoring_offset,
+	score_type gap_penalty,
+	index_type band_width,
+	ScoreStream &out_scores
+);
+
+#ifndef __SYNTHESIS__
+class SeqStreamView;
+class LengthStreamView;
+class ScoreSinkView;
+
+// align_with<ScoringPolicy, Cell>, for the numeric variants of the C simulation
+// (see numeric_variants() in engines.hh), which are all instantiated in
+// align.cc, including the one whose cells are the cell_type of the build
+template<typename ScoringPolicy, typename Cell>
+void align_numeric_variant(
+	SeqStreamView &stream_ver,
+	index_type stream_size_ver,
+	SeqStreamView &streams_hor,
+	LengthStreamView &stream_sizes_hor,
+	seq_count_type num_streams_hor,
+	score_type scoring_offset,
+	score_type gap_penalty,
+	index_type band_width,
+	ScoreSinkView &out_scores
+);
+#endif // __SYNTHESIS__
+
 #endif // SWPARA_ALIGN_HH
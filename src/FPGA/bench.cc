@@ -0,0 +1,317 @@
+//
+// bench.cc
+//
+// Throughput benchmark: sweeps sequence count, length distribution
+// and engine over reproducible, fixed-seed datasets, and reports
+// GCUPS, pairs/s, per-pair latency percentiles and peak RSS as JSON.
+// Engines that score a pair on several threads get --threads of them.
+// Build with `make bench NDEBUG=1`, otherwise tracing dominates the timings.
+//
+// Created on 18/10/2026
+//
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <random>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+
+#include <sys/resource.h>
+
+#include "align.hh"
+#include "engines.hh"
+#include "seq_store.hh"
+
+
+struct LengthDist {
+	const char *name;
+	index_type min_len;
+	index_type max_len;
+};
+
+// Lengths are drawn uniformly from [min_len, max_len]. Only the engines
+// that take sequences of max_len residues run on a distribution, and only
+// those up to MAX_SEQ_SIZE run by default, which every engine takes.
+static const LengthDist length_dists[] = {
+	{ "short",      16,  64 },
+	{ "fixed",     128, 128 },
+	{ "uniform",     1, MAX_SEQ_SIZE },
+	{ "long",      384, MAX_SEQ_SIZE },
+	{ "longchain", 4 * MAX_SEQ_SIZE, 8 * MAX_SEQ_SIZE },
+};
+
+static const seq_count_type default_counts[] = { 16, 64, 128 };
+
+static const std::uint64_t default_seed = 0x5eed;
+
+
+struct Result {
+	double seconds;
+	std::uint64_t pairs;
+	std::uint64_t cells;
+	double p50_us;
+	double p99_us;
+	long peak_rss_kb;
+};
+
+// The same (count, distribution, seed) always yields the same dataset,
+// independent of the platform's standard library: only the raw output
+// of mt19937_64 is used, never the implementation-defined distributions.
+static SequenceStore make_dataset(seq_count_type num_seqs, const LengthDist &dist, std::uint64_t seed)
+{
+	std::mt19937_64 rng(seed);
+	SequenceStore ds;
+
+	std::uint64_t span = dist.max_len - dist.min_len + 1;
+
+	for (seq_count_type i = 0; i < num_seqs; i++) {
+		index_type length = dist.min_len + rng() % span;
+		angle_type *phi, *psi;
+
+		ds.append(length, phi, psi);
+
+		for (index_type k = 0; k < length; k++) {
+			phi[k] = angle_type(rng() % 360) - 180;
+			psi[k] = angle_type(rng() % 360) - 180;
+		}
+	}
+
+	return ds;
+}
+
+static double percentile(std::vector<double> &sorted, double p)
+{
+	if (sorted.empty()) {
+		return 0;
+	}
+
+	std::size_t idx = static_cast<std::size_t>(p * (sorted.size() - 1) + 0.5);
+	return sorted[idx];
+}
+
+static long peak_rss_kb()
+{
+	struct rusage usage;
+
+	if (getrusage(RUSAGE_SELF, &usage) != 0) {
+		return -1;
+	}
+
+#ifdef __APPLE__
+	return usage.ru_maxrss / 1024; // bytes on macOS, KiB on Linux
+#else
+	return usage.ru_maxrss;
+#endif
+}
+
+// Scores the whole upper triangle, one pair at a time
+static Result run_case(const Engine &engine, const SequenceStore &ds, score_type scoring_offset, score_type gap_penalty, unsigned num_threads)
+{
+	typedef std::chrono::steady_clock clock;
+
+	Result res {};
+	std::vector<double> latencies;
+	seq_count_type num_seqs = ds.size();
+	volatile score_type sink = 0; // keep the scores alive
+
+	clock::time_point t_begin = clock::now();
+
+	for (seq_count_type i = 0; i < num_seqs; i++) {
+		for (seq_count_type j = i + 1; j < num_seqs; j++) {
+			clock::time_point t0 = clock::now();
+
+			if (engine.score_threaded != nullptr) {
+				sink = engine.score_threaded(ds[i], ds[j], scoring_offset, gap_penalty, num_threads);
+			} else {
+				sink = engine.score_pair(ds[i], ds[j], scoring_offset, gap_penalty);
+			}
+
+			clock::time_point t1 = clock::now();
+			latencies.push_back(std::chrono::duration<double, std::micro>(t1 - t0).count());
+
+			res.pairs++;
+			res.cells += std::uint64_t(ds[i].length) * ds[j].length;
+		}
+	}
+
+	res.seconds = std::chrono::duration<double>(clock::now() - t_begin).count();
+	(void)sink;
+
+	std::sort(latencies.begin(), latencies.end());
+	res.p50_us = percentile(latencies, 0.50);
+	res.p99_us = percentile(latencies, 0.99);
+
+	// ru_maxrss never decreases, so this is the peak of the process
+	// up to and including this case
+	res.peak_rss_kb = peak_rss_kb();
+
+	return res;
+}
+
+static void usage(const char *progname)
+{
+	std::cerr << "Usage: " << progname
+		<< " [--engine NAME]... [--dist NAME]... [--count N]... [--seed N]"
+		<< " [--offset N] [--penalty N] [--threads N]" << std::endl;
+	std::cerr << "Engines:";
+
+	for (const Engine &engine : all_engines()) {
+		std::cerr << " " << engine.name;
+	}
+
+	std::cerr << std::endl << "Distributions:";
+
+	for (const LengthDist &dist : length_dists) {
+		std::cerr << " " << dist.name;
+	}
+
+	std::cerr << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+	std::vector<const Engine *> engines;
+	std::vector<const LengthDist *> dists;
+	std::vector<seq_count_type> counts;
+	std::uint64_t seed = default_seed;
+	unsigned num_threads = std::max(1u, std::thread::hardware_concurrency());
+	score_type scoring_offset = 65536;
+	score_type gap_penalty = -4000;
+
+	for (int i = 1; i < argc; i++) {
+		if (i + 1 >= argc) {
+			usage(argv[0]);
+			return EXIT_FAILURE;
+		}
+
+		const char *value = argv[++i];
+
+		if (std::strcmp(argv[i - 1], "--engine") == 0) {
+			const Engine *engine = find_engine(value);
+
+			if (engine == nullptr) {
+				std::cerr << "unknown engine '" << value << "'" << std::endl;
+				return EXIT_FAILURE;
+			}
+
+			engines.push_back(engine);
+		} else if (std::strcmp(argv[i - 1], "--dist") == 0) {
+			const LengthDist *found = nullptr;
+
+			for (const LengthDist &dist : length_dists) {
+				if (std::strcmp(dist.name, value) == 0) {
+					found = &dist;
+				}
+			}
+
+			if (found == nullptr) {
+				std::cerr << "unknown length distribution '" << value << "'" << std::endl;
+				return EXIT_FAILURE;
+			}
+
+			dists.push_back(found);
+		} else if (std::strcmp(argv[i - 1], "--count") == 0) {
+			counts.push_back(std::strtoul(value, nullptr, 10));
+		} else if (std::strcmp(argv[i - 1], "--seed") == 0) {
+			seed = std::strtoull(value, nullptr, 0);
+		} else if (std::strcmp(argv[i - 1], "--offset") == 0) {
+			scoring_offset = std::strtol(value, nullptr, 10);
+		} else if (std::strcmp(argv[i - 1], "--penalty") == 0) {
+			gap_penalty = std::strtol(value, nullptr, 10);
+		} else if (std::strcmp(argv[i - 1], "--threads") == 0) {
+			num_threads = std::max(1ul, std::strtoul(value, nullptr, 10));
+		} else {
+			usage(argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	// as in `align`: a build with compressed boundaries only supports some parameters
+	if (!boundary_deltas_fit(scoring_offset, gap_penalty)) {
+		std::fprintf(
+			stderr,
+			"scoring offset %ld and gap penalty %ld are out of range of the %d-bit boundary deltas\n",
+			static_cast<long>(scoring_offset),
+			static_cast<long>(gap_penalty),
+			BOUNDARY_DELTA_BITS
+		);
+		return EXIT_FAILURE;
+	}
+
+	if (engines.empty()) {
+		for (const Engine &engine : all_engines()) {
+			engines.push_back(&engine);
+		}
+	}
+
+	if (dists.empty()) {
+		for (const LengthDist &dist : length_dists) {
+			if (dist.max_len <= MAX_SEQ_SIZE) {
+				dists.push_back(&dist);
+			}
+		}
+	}
+
+	if (counts.empty()) {
+		counts.assign(std::begin(default_counts), std::end(default_counts));
+	}
+
+	std::printf("{\n  \"seed\": %llu,\n  \"scoring_offset\": %ld,\n  \"gap_penalty\": %ld,\n  \"threads\": %u,\n  \"results\": [",
+		static_cast<unsigned long long>(seed),
+		static_cast<long>(scoring_offset),
+		static_cast<long>(gap_penalty),
+		num_threads
+	);
+
+	const char *sep = "\n";
+
+	for (const LengthDist *dist : dists) {
+		for (seq_count_type count : counts) {
+			SequenceStore ds = make_dataset(count, *dist, seed);
+
+			for (const Engine *engine : engines) {
+				if (dist->max_len > engine->max_length) {
+					continue;
+				}
+
+				Result res = run_case(*engine, ds, scoring_offset, gap_penalty, num_threads);
+
+				double gcups = res.seconds > 0 ? res.cells / res.seconds / 1e9 : 0;
+				double pairs_per_sec = res.seconds > 0 ? res.pairs / res.seconds : 0;
+
+				std::printf(
+					"%s    { \"engine\": \"%s\", \"dist\": \"%s\", \"num_seqs\": %lu,"
+					" \"pairs\": %llu, \"cells\": %llu, \"seconds\": %.6f,"
+					" \"gcups\": %.6f, \"pairs_per_sec\": %.3f,"
+					" \"latency_p50_us\": %.3f, \"latency_p99_us\": %.3f,"
+					" \"peak_rss_kb\": %ld }",
+					sep,
+					engine->name,
+					dist->name,
+					static_cast<unsigned long>(count),
+					static_cast<unsigned long long>(res.pairs),
+					static_cast<unsigned long long>(res.cells),
+					res.seconds,
+					gcups,
+					pairs_per_sec,
+					res.p50_us,
+					res.p99_us,
+					res.peak_rss_kb
+				);
+				std::fflush(stdout);
+
+				sep = ",\n";
+			}
+		}
+	}
+
+	std::printf("\n  ]\n}\n");
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,126 @@
+//
+// bounded_queue.hh
+//
+// Fixed-capacity lock-free queue for passing work between threads
+//
+// Created on 18/10/2026
+//
+
+#ifndef SWPARA_BOUNDED_QUEUE_HH
+#define SWPARA_BOUNDED_QUEUE_HH
+
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <utility>
+#include <cstddef>
+#include <cassert>
+
+
+// Multi-producer, multi-consumer ring buffer (after D. Vyukov).
+// Every slot has a sequence number which tells whose turn it is:
+// a producer may fill slot #pos when its sequence is 'pos', a consumer
+// may empty it when it is 'pos + 1'. The capacity must be a power of two.
+template<typename T>
+class BoundedQueue {
+public:
+	explicit BoundedQueue(std::size_t capacity) :
+		slots_(capacity),
+		mask_(capacity - 1),
+		head_(0),
+		tail_(0)
+	{
+		assert(capacity > 0 && (capacity & (capacity - 1)) == 0 && "capacity must be a power of two");
+
+		for (std::size_t i = 0; i < capacity; i++) {
+			slots_[i].sequence.store(i, std::memory_order_relaxed);
+		}
+	}
+
+	BoundedQueue(const BoundedQueue &) = delete;
+	BoundedQueue &operator=(const BoundedQueue &) = delete;
+
+	std::size_t capacity() const { return slots_.size(); }
+
+	// false if the queue is full
+	bool try_push(T &value)
+	{
+		std::size_t pos = tail_.load(std::memory_order_relaxed);
+
+		for (;;) {
+			Slot &slot = slots_[pos & mask_];
+			std::size_t sequence = slot.sequence.load(std::memory_order_acquire);
+			std::ptrdiff_t diff = std::ptrdiff_t(sequence) - std::ptrdiff_t(pos);
+
+			if (diff == 0) {
+				if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+					slot.value = std::move(value);
+					slot.sequence.store(pos + 1, std::memory_order_release);
+					return true;
+				}
+			} else if (diff < 0) {
+				return false;
+			} else {
+				pos = tail_.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	// false if the queue is empty
+	bool try_pop(T &value)
+	{
+		std::size_t pos = head_.load(std::memory_order_relaxed);
+
+		for (;;) {
+			Slot &slot = slots_[pos & mask_];
+			std::size_t sequence = slot.sequence.load(std::memory_order_acquire);
+			std::ptrdiff_t diff = std::ptrdiff_t(sequence) - std::ptrdiff_t(pos + 1);
+
+			if (diff == 0) {
+				if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+					value = std::move(slot.value);
+					slot.sequence.store(pos + mask_ + 1, std::memory_order_release);
+					return true;
+				}
+			} else if (diff < 0) {
+				return false;
+			} else {
+				pos = head_.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	// Blocking variants: these yield until there is room, or an element
+	void push(T value)
+	{
+		while (!try_push(value)) {
+			std::this_thread::yield();
+		}
+	}
+
+	T pop()
+	{
+		T value;
+
+		while (!try_pop(value)) {
+			std::this_thread::yield();
+		}
+
+		return value;
+	}
+
+private:
+	struct Slot {
+		std::atomic<std::size_t> sequence;
+		T value;
+	};
+
+	std::vector<Slot> slots_;
+	const std::size_t mask_;
+
+	// on separate cache lines, so that producers and consumers don't contend
+	alignas(64) std::atomic<std::size_t> head_;
+	alignas(64) std::atomic<std::size_t> tail_;
+};
+
+#endif // SWPARA_BOUNDED_QUEUE_HH
@@ -0,0 +1,205 @@
+//
+// checkpoint.cc
+//
+// Checkpoint and resume of long out-of-core runs
+//
+// Created on 18/10/2026
+//
+
+#include <stdexcept>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "checkpoint.hh"
+
+
+static const std::uint32_t checkpoint_magic = 0x4b435753; // "SWCK"
+static const std::uint32_t checkpoint_version = 2;
+
+struct CheckpointRecord {
+	std::uint32_t magic;
+	std::uint32_t version;
+	CheckpointIdentity identity;
+	CheckpointState state;
+	std::uint64_t checksum; // of all the preceding bytes
+};
+
+// FNV-1a
+static std::uint64_t fingerprint(const void *data, std::size_t size, std::uint64_t hash = 0xcbf29ce484222325ull)
+{
+	const unsigned char *bytes = static_cast<const unsigned char *>(data);
+
+	for (std::size_t i = 0; i < size; i++) {
+		hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+	}
+
+	return hash;
+}
+
+static std::uint64_t record_checksum(const CheckpointRecord &record)
+{
+	return fingerprint(&record, offsetof(CheckpointRecord, checksum));
+}
+
+static bool same_identity(const CheckpointIdentity &a, const CheckpointIdentity &b)
+{
+	return a.input_fingerprint == b.input_fingerprint
+		&& a.num_seqs == b.num_seqs
+		&& a.row_begin == b.row_begin
+		&& a.row_end == b.row_end
+		&& a.scoring_offset == b.scoring_offset
+		&& a.gap_penalty == b.gap_penalty;
+}
+
+// Make a rename() in the directory of 'path' durable
+static void sync_parent_dir(const std::string &path)
+{
+	std::size_t slash = path.rfind('/');
+	std::string dir = slash == std::string::npos ? "." : slash == 0 ? "/" : path.substr(0, slash);
+
+	int fd = open(dir.c_str(), O_RDONLY);
+
+	if (fd >= 0) {
+		fsync(fd);
+		close(fd);
+	}
+}
+
+std::uint64_t input_fingerprint(SeqFile &seqs)
+{
+	// sequence data is hashed this many dihedrals (or one sequence) at a time
+	const std::uint64_t chunk_length = 1 << 20;
+
+	const std::vector<index_type> &lengths = seqs.lengths();
+	std::uint64_t hash = fingerprint(lengths.data(), lengths.size() * sizeof lengths[0]);
+	SequenceStore chunk;
+
+	for (seq_count_type begin = 0, end; begin < seqs.size(); begin = end) {
+		std::uint64_t length = lengths[begin];
+
+		for (end = begin + 1; end < seqs.size() && length + lengths[end] <= chunk_length; end++) {
+			length += lengths[end];
+		}
+
+		seqs.read(begin, end, chunk);
+
+		for (seq_count_type i = 0; i < chunk.size(); i++) {
+			SeqView seq = chunk[i];
+			hash = fingerprint(seq.phi, seq.length * sizeof seq.phi[0], hash);
+			hash = fingerprint(seq.psi, seq.length * sizeof seq.psi[0], hash);
+		}
+	}
+
+	return hash;
+}
+
+bool load_checkpoint(const char *path, const CheckpointIdentity &identity, CheckpointState &state)
+{
+	std::FILE *file = std::fopen(path, "rb");
+
+	if (file == nullptr) {
+		if (errno == ENOENT) {
+			return false;
+		}
+
+		throw std::runtime_error(std::string("can't open checkpoint '") + path + "': " + std::strerror(errno));
+	}
+
+	CheckpointRecord record;
+	bool ok = std::fread(&record, sizeof record, 1, file) == 1;
+	std::fclose(file);
+
+	if (!ok || record.magic != checkpoint_magic || record.version != checkpoint_version || record.checksum != record_checksum(record)) {
+		throw std::runtime_error(std::string("checkpoint '") + path + "' is corrupt");
+	}
+
+	if (!same_identity(record.identity, identity)) {
+		throw std::runtime_error(
+			std::string("checkpoint '") + path + "' belongs to a different run "
+			"(input, parameters or shard differ); remove it to start over"
+		);
+	}
+
+	if (record.state.next_row < identity.row_begin || record.state.next_row > identity.row_end) {
+		throw std::runtime_error(std::string("checkpoint '") + path + "' is corrupt");
+	}
+
+	state = record.state;
+	return true;
+}
+
+CheckpointWriter::CheckpointWriter(ScoreFileWriter &writer, const char *path, const CheckpointIdentity &identity, double interval) :
+	writer_(writer),
+	path_(path),
+	identity_(identity),
+	interval_(std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(interval))),
+	last_save_(std::chrono::steady_clock::now()),
+	time_spent_(0),
+	num_checkpoints_(0)
+{}
+
+void CheckpointWriter::write_row(seq_count_type row, const score_type *scores, seq_count_type count)
+{
+	writer_.write_row(row, scores, count);
+
+	// one clock read per row is all the overhead between checkpoints
+	if (std::chrono::steady_clock::now() - last_save_ >= interval_) {
+		save(row + 1);
+	}
+}
+
+void CheckpointWriter::finish()
+{
+	writer_.finish();
+	writer_.sync();
+
+	// the output is complete: nothing to resume
+	if (std::remove(path_.c_str()) != 0 && errno != ENOENT) {
+		throw std::runtime_error("can't remove checkpoint '" + path_ + "': " + std::strerror(errno));
+	}
+
+	sync_parent_dir(path_);
+}
+
+void CheckpointWriter::save(seq_count_type next_row)
+{
+	auto t_begin = std::chrono::steady_clock::now();
+
+	CheckpointRecord record;
+	record.magic = checkpoint_magic;
+	record.version = checkpoint_version;
+	record.identity = identity_;
+	record.state.next_row = next_row;
+	record.state.output_size = writer_.sync(); // output first, so it's never behind the checkpoint
+	record.checksum = record_checksum(record);
+
+	// write-to-temporary, then rename, so that there's always a valid checkpoint
+	std::string tmp_path = path_ + ".tmp";
+	std::FILE *file = std::fopen(tmp_path.c_str(), "wb");
+
+	if (file == nullptr) {
+		throw std::runtime_error("can't create checkpoint '" + tmp_path + "': " + std::strerror(errno));
+	}
+
+	bool ok = std::fwrite(&record, sizeof record, 1, file) == 1
+		&& std::fflush(file) == 0
+		&& fsync(fileno(file)) == 0;
+
+	ok = std::fclose(file) == 0 && ok;
+
+	if (!ok || std::rename(tmp_path.c_str(), path_.c_str()) != 0) {
+		throw std::runtime_error("can't write checkpoint '" + path_ + "': " + std::strerror(errno));
+	}
+
+	sync_parent_dir(path_);
+
+	auto t_end = std::chrono::steady_clock::now();
+	time_spent_ += t_end - t_begin;
+	last_save_ = t_end;
+	num_checkpoints_++;
+}
@@ -0,0 +1,71 @@
+//
+// checkpoint.hh
+//
+// Checkpoint and resume of long out-of-core runs.
+// A checkpoint records which rows are already in the (fsynced) output file,
+// so that a restarted run can truncate the output to that point and carry on.
+//
+// Created on 18/10/2026
+//
+
+#ifndef SWPARA_CHECKPOINT_HH
+#define SWPARA_CHECKPOINT_HH
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+
+#include "align.hh"
+#include "seq_file.hh"
+
+
+// A checkpoint may only be resumed by a run with the same identity
+struct CheckpointIdentity {
+	std::uint64_t input_fingerprint; // of the sequences, see input_fingerprint()
+	seq_count_type num_seqs;
+	seq_count_type row_begin;
+	seq_count_type row_end;
+	score_type scoring_offset;
+	score_type gap_penalty;
+};
+
+struct CheckpointState {
+	seq_count_type next_row;   // rows [row_begin, next_row) are in the output...
+	std::uint64_t output_size; // ...which is this many bytes long
+};
+
+// Hash of the lengths and the dihedrals of every sequence. It reads the
+// whole input once, and is the same for a raw file and its archive.
+std::uint64_t input_fingerprint(SeqFile &seqs);
+
+// Returns false if there is no checkpoint at 'path'.
+// Throws if the checkpoint is corrupt or belongs to a different run.
+bool load_checkpoint(const char *path, const CheckpointIdentity &identity, CheckpointState &state);
+
+// Forwards rows to 'writer'. At most every 'interval' seconds, after a
+// complete row, it syncs the output and atomically replaces the checkpoint.
+// When the run finishes, the checkpoint is removed.
+class CheckpointWriter : public RowWriter {
+public:
+	CheckpointWriter(ScoreFileWriter &writer, const char *path, const CheckpointIdentity &identity, double interval);
+
+	void write_row(seq_count_type row, const score_type *scores, seq_count_type count) override;
+	void finish() override;
+
+	std::size_t num_checkpoints() const { return num_checkpoints_; }
+	double seconds() const { return std::chrono::duration<double>(time_spent_).count(); }
+
+private:
+	void save(seq_count_type next_row);
+
+	ScoreFileWriter &writer_;
+	std::string path_;
+	CheckpointIdentity identity_;
+	std::chrono::steady_clock::duration interval_;
+	std::chrono::steady_clock::time_point last_save_;
+	std::chrono::steady_clock::duration time_spent_;
+	std::size_t num_checkpoints_;
+};
+
+#endif // SWPARA_CHECKPOINT_HH
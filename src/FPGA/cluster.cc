@@ -0,0 +1,121 @@
+//
+// cluster.cc
+//
+// Single-linkage threshold clustering of the sequences,
+// computed from the scores as they are produced
+//
+// Created on 18/10/2026
+//
+
+#include <utility>
+#include <algorithm>
+#include <stdexcept>
+#include <cerrno>
+#include <cstring>
+#include <string>
+
+#include "cluster.hh"
+
+
+ConcurrentUnionFind::ConcurrentUnionFind(seq_count_type size) : parent_(size)
+{
+	for (seq_count_type x = 0; x < size; x++) {
+		parent_[x].store(x, std::memory_order_relaxed);
+	}
+}
+
+seq_count_type ConcurrentUnionFind::find(seq_count_type x)
+{
+	for (;;) {
+		seq_count_type parent = parent_[x].load();
+
+		if (parent == x) {
+			return x;
+		}
+
+		// path halving: if another thread has changed parent_[x]
+		// in the meantime, the CAS fails, which is harmless
+		seq_count_type grandparent = parent_[parent].load();
+
+		if (grandparent != parent) {
+			parent_[x].compare_exchange_weak(parent, grandparent);
+		}
+
+		x = grandparent;
+	}
+}
+
+void ConcurrentUnionFind::unite(seq_count_type x, seq_count_type y)
+{
+	for (;;) {
+		x = find(x);
+		y = find(y);
+
+		if (x == y) {
+			return;
+		}
+
+		if (x > y) {
+			std::swap(x, y);
+		}
+
+		// Link the larger representative below the smaller one. This fails
+		// if 'y' has stopped being a representative, in which case we retry.
+		seq_count_type expected = y;
+
+		if (parent_[y].compare_exchange_strong(expected, x)) {
+			return;
+		}
+	}
+}
+
+ClusterRowWriter::ClusterRowWriter(std::FILE *file, seq_count_type num_seqs, score_type threshold) :
+	file_(file),
+	sets_(num_seqs),
+	threshold_(threshold),
+	num_clusters_(0),
+	largest_cluster_(0)
+{
+}
+
+void ClusterRowWriter::write_row(seq_count_type row, const score_type *scores, seq_count_type count)
+{
+	for (seq_count_type j = 0; j < count; j++) {
+		if (scores[j] >= threshold_) {
+			sets_.unite(row, row + 1 + j);
+		}
+	}
+}
+
+void ClusterRowWriter::finish()
+{
+	const seq_count_type num_seqs = sets_.size();
+
+	// cluster_ids[r]: number of the cluster represented by #r;
+	// representatives come first in their clusters, so they are numbered first
+	std::vector<seq_count_type> cluster_ids(num_seqs);
+	std::vector<seq_count_type> cluster_sizes;
+
+	for (seq_count_type i = 0; i < num_seqs; i++) {
+		seq_count_type rep = sets_.find(i);
+
+		if (rep == i) {
+			cluster_ids[i] = cluster_sizes.size();
+			cluster_sizes.push_back(0);
+		}
+
+		seq_count_type id = cluster_ids[rep];
+		cluster_sizes[id]++;
+
+		if (std::fprintf(file_, "%lu %lu %lu\n", static_cast<unsigned long>(i), static_cast<unsigned long>(id), static_cast<unsigned long>(rep)) < 0) {
+			throw std::runtime_error(std::string("can't write clusters: ") + std::strerror(errno));
+		}
+	}
+
+	if (std::fflush(file_) != 0) {
+		throw std::runtime_error(std::string("can't write clusters: ") + std::strerror(errno));
+	}
+
+	num_clusters_ = cluster_sizes.size();
+	largest_cluster_ = cluster_sizes.empty() ? 0 : *std::max_element(cluster_sizes.begin(), cluster_sizes.end());
+}
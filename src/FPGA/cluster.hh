@@ -0,0 +1,66 @@
+//
+// cluster.hh
+//
+// Single-linkage threshold clustering of the sequences,
+// computed from the scores as they are produced
+//
+// Created on 18/10/2026
+//
+
+#ifndef SWPARA_CLUSTER_HH
+#define SWPARA_CLUSTER_HH
+
+#include <vector>
+#include <atomic>
+#include <cstdio>
+
+#include "align.hh"
+#include "seq_file.hh"
+
+
+// Disjoint sets of sequences. find() and unite() are lock-free and may be
+// called from several threads at once. Every set is represented by its
+// smallest element, so the result doesn't depend on the order of unions.
+class ConcurrentUnionFind {
+public:
+	explicit ConcurrentUnionFind(seq_count_type size);
+
+	seq_count_type size() const { return parent_.size(); }
+
+	seq_count_type find(seq_count_type x);
+	void unite(seq_count_type x, seq_count_type y);
+
+private:
+	// parent_[x] <= x, with equality for representatives
+	std::vector<std::atomic<seq_count_type>> parent_;
+};
+
+// Sequences #i and #j are in the same cluster if there is a chain of
+// pairs between them, each of which scores at least 'threshold'.
+// Instead of storing the rows, this unites the sequences of every pair
+// above the threshold, so only O(n) memory is needed. Rows may be
+// written concurrently, in any order.
+//
+// finish() writes one line per sequence, "<sequence> <cluster> <representative>",
+// where clusters are numbered in the order of their representatives,
+// and the representative of a cluster is its first sequence.
+class ClusterRowWriter : public RowWriter {
+public:
+	ClusterRowWriter(std::FILE *file, seq_count_type num_seqs, score_type threshold);
+
+	void write_row(seq_count_type row, const score_type *scores, seq_count_type count) override;
+	void finish() override;
+	bool concurrent() const override { return true; }
+
+	seq_count_type num_clusters() const { return num_clusters_; }
+	seq_count_type largest_cluster() const { return largest_cluster_; }
+
+private:
+	std::FILE *file_;
+	ConcurrentUnionFind sets_;
+	score_type threshold_;
+	seq_count_type num_clusters_;
+	seq_count_type largest_cluster_;
+};
+
+#endif // SWPARA_CLUSTER_HH
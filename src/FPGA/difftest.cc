@@ -0,0 +1,408 @@
+//
+// difftest.cc
+//
+// Differential test: scores random pairs of sequences with every engine
+// and with the full-matrix reference of the engine's scoring policy,
+// in parallel, and reports mismatches. A quarter of the pairs are scored
+// in banded mode, by the engines that have one, band edge flag included.
+// With --max-len beyond MAX_SEQ_SIZE, pairs can be longer than the kernel
+// takes, and are only scored by the engines that take them, such as the
+// wavefront engine, on --pair-threads threads each.
+// Every pair is derived from (seed, pair index) alone, so any failure
+// can be reproduced with `--seed S --first P --pairs 1`.
+//
+// Created on 18/10/2026
+//
+
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <limits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+
+#include "align.hh"
+#include "engines.hh"
+#include "seq_store.hh"
+#include "sweep.hh"
+#include "wavefront.hh"
+
+
+// Pairs cycle through these, from the production setting to degenerate ones
+static const ScoringParams scoring_params[] = {
+	{ 65536,   -4000 },
+	{ 100,     -50   },
+	{ 1 << 20, -1000 },
+	{ 0,       -1    },
+	{ 1 << 24, 0     },
+};
+
+// Lengths around window and buffer boundaries
+static const index_type edge_lengths[] = {
+	0, 1, 2, WIN_COLS - 1, WIN_COLS, WIN_COLS + 1, 2 * WIN_COLS - 1, 2 * WIN_COLS,
+	MAX_SEQ_SIZE / 2, MAX_SEQ_SIZE - WIN_COLS, MAX_SEQ_SIZE - 1,
+};
+
+// Lengths around the limit of the kernel and tile boundaries of the wavefront engine
+static const index_type long_edge_lengths[] = {
+	MAX_SEQ_SIZE, MAX_SEQ_SIZE + 1, 16 * WAVEFRONT_TILE_SIZE - 1, 16 * WAVEFRONT_TILE_SIZE + 1, 2 * MAX_SEQ_SIZE,
+};
+
+// Band half-widths around window boundaries and beyond the longest sequence
+static const index_type edge_band_widths[] = {
+	0, 1, 2, WIN_COLS - 1, WIN_COLS, WIN_COLS + 1, 2 * WIN_COLS, MAX_SEQ_SIZE / 2, MAX_SEQ_SIZE,
+};
+
+static const std::size_t max_reported = 10;
+static const std::uint64_t chunk_size = 64;
+
+struct Options {
+	std::uint64_t num_pairs = 100000;
+	std::uint64_t first_pair = 0;
+	std::uint64_t seed = 1;
+	index_type max_len = MAX_SEQ_SIZE;
+	unsigned num_threads = std::max(1u, std::thread::hardware_concurrency());
+	unsigned pair_threads = 1; // of each engine with a threaded mode
+	std::vector<const Engine *> engines;
+};
+
+struct Pair {
+	SequenceStore seqs; // vertical, then horizontal
+	ScoringParams params;
+	index_type band_width;
+};
+
+struct Mismatch {
+	std::uint64_t pair_index;
+	const Engine *engine;
+	score_type expected;
+	score_type actual;
+	bool expected_edge;
+	bool actual_edge;
+};
+
+// splitmix64: cheap to seed for every single pair
+class PairRng {
+public:
+	explicit PairRng(std::uint64_t seed) : state_(seed) {}
+
+	std::uint64_t next()
+	{
+		std::uint64_t z = (state_ += 0x9e3779b97f4a7c15ull);
+		z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+		z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+		return z ^ (z >> 31);
+	}
+
+	std::uint64_t below(std::uint64_t n) { return next() % n; }
+
+private:
+	std::uint64_t state_;
+};
+
+static index_type random_length(PairRng &rng, index_type max_len)
+{
+	if (rng.below(8) == 0) {
+		return edge_lengths[rng.below(ARRAY_COUNT(edge_lengths))];
+	}
+
+	// drawn only for long pairs, so that the others don't depend on max_len
+	if (max_len > MAX_SEQ_SIZE && rng.below(8) == 0) {
+		return std::min(max_len, long_edge_lengths[rng.below(ARRAY_COUNT(long_edge_lengths))]);
+	}
+
+	return rng.below(max_len);
+}
+
+static Dihedral random_dihedral(PairRng &rng)
+{
+	// occasionally use the extremes, where angle differences wrap around
+	if (rng.below(16) == 0) {
+		static const angle_type extremes[] = { -32768, 32767, 0, -1 };
+		return { extremes[rng.below(4)], extremes[rng.below(4)] };
+	}
+
+	std::uint64_t bits = rng.next();
+	return { angle_type(std::uint16_t(bits)), angle_type(std::uint16_t(bits >> 16)) };
+}
+
+static Pair make_pair(std::uint64_t seed, std::uint64_t pair_index, index_type max_len)
+{
+	PairRng rng(seed ^ (pair_index * 0xd1b54a32d192ed03ull));
+	std::vector<Dihedral> ver(random_length(rng, max_len));
+	std::vector<Dihedral> hor;
+	Pair pair;
+
+	pair.params = scoring_params[pair_index % ARRAY_COUNT(scoring_params)];
+
+	for (Dihedral &d : ver) {
+		d = random_dihedral(rng);
+	}
+
+	// a third of the pairs are similar, so that scores are large
+	// and the interesting paths through the matrix are long
+	if (rng.below(3) == 0) {
+		hor = ver;
+
+		for (Dihedral &d : hor) {
+			if (rng.below(10) == 0) {
+				d = random_dihedral(rng);
+			} else {
+				d.phi = angle_type(std::uint16_t(d.phi + rng.below(512) - 256));
+				d.psi = angle_type(std::uint16_t(d.psi + rng.below(512) - 256));
+			}
+		}
+
+		if (!hor.empty() && rng.below(2) == 0) {
+			hor.erase(hor.begin() + rng.below(hor.size()));
+		}
+	} else {
+		hor.resize(random_length(rng, max_len));
+
+		for (Dihedral &d : hor) {
+			d = random_dihedral(rng);
+		}
+	}
+
+	pair.seqs.append(ver.data(), ver.size());
+	pair.seqs.append(hor.data(), hor.size());
+
+	// drawn last, so that the sequences don't depend on it
+	if (rng.below(4) == 0) {
+		pair.band_width = rng.below(2) == 0 ? edge_band_widths[rng.below(ARRAY_COUNT(edge_band_widths))] : rng.below(4 * WIN_COLS);
+	} else {
+		pair.band_width = FULL_BAND;
+	}
+
+	return pair;
+}
+
+static void usage(const char *progname)
+{
+	std::cerr << "Usage: " << progname
+		<< " [--pairs N] [--first P] [--seed N] [--max-len N] [--threads N] [--pair-threads N] [--engine NAME]..." << std::endl;
+}
+
+static bool parse_options(int argc, char *argv[], Options &opts)
+{
+	for (int i = 1; i < argc; i += 2) {
+		if (i + 1 >= argc) {
+			return false;
+		}
+
+		const char *name = argv[i];
+		const char *value = argv[i + 1];
+
+		if (std::strcmp(name, "--pairs") == 0) {
+			opts.num_pairs = std::strtoull(value, nullptr, 10);
+		} else if (std::strcmp(name, "--first") == 0) {
+			opts.first_pair = std::strtoull(value, nullptr, 10);
+		} else if (std::strcmp(name, "--seed") == 0) {
+			opts.seed = std::strtoull(value, nullptr, 0);
+		} else if (std::strcmp(name, "--max-len") == 0) {
+			long max_len = std::strtol(value, nullptr, 10);
+
+			if (max_len < 1 || max_len > std::numeric_limits<index_type>::max()) {
+				std::cerr << "--max-len must be in [1, " << std::numeric_limits<index_type>::max() << "]" << std::endl;
+				return false;
+			}
+
+			opts.max_len = max_len;
+		} else if (std::strcmp(name, "--threads") == 0) {
+			opts.num_threads = std::max(1ul, std::strtoul(value, nullptr, 10));
+		} else if (std::strcmp(name, "--pair-threads") == 0) {
+			opts.pair_threads = std::max(1ul, std::strtoul(value, nullptr, 10));
+		} else if (std::strcmp(name, "--engine") == 0) {
+			const Engine *engine = find_engine(value);
+
+			if (engine == nullptr) {
+				std::cerr << "unknown engine '" << value << "'" << std::endl;
+				return false;
+			}
+
+			opts.engines.push_back(engine);
+		} else {
+			return false;
+		}
+	}
+
+	// by default, test every engine against the reference
+	if (opts.engines.empty()) {
+		for (const Engine &engine : all_engines()) {
+			if (&engine != reference_engine(engine.policy)) {
+				opts.engines.push_back(&engine);
+			}
+		}
+	}
+
+	return true;
+}
+
+int main(int argc, char *argv[])
+{
+	Options opts;
+
+	if (!parse_options(argc, argv, opts)) {
+		usage(argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	std::atomic<std::uint64_t> next_pair(0);
+	std::atomic<std::uint64_t> num_cells(0);
+	std::atomic<std::uint64_t> num_skipped(0);
+	std::mutex mismatch_mutex;
+	std::vector<Mismatch> mismatches;
+	std::uint64_t num_mismatches = 0;
+
+	auto worker = [&]() {
+		for (;;) {
+			std::uint64_t begin = next_pair.fetch_add(chunk_size);
+
+			if (begin >= opts.num_pairs) {
+				break;
+			}
+
+			std::uint64_t end = std::min(begin + chunk_size, opts.num_pairs);
+			std::uint64_t cells = 0;
+
+			for (std::uint64_t k = begin; k < end; k++) {
+				std::uint64_t pair_index = opts.first_pair + k;
+				Pair pair = make_pair(opts.seed, pair_index, opts.max_len);
+
+				// a build with compressed boundaries only supports some parameters
+				if (!boundary_deltas_fit(pair.params.scoring_offset, pair.params.gap_penalty)) {
+					num_skipped++;
+					continue;
+				}
+
+				if (!band_supported(pair.band_width)) {
+					num_skipped++;
+					continue;
+				}
+
+				index_type pair_max_len = std::max(pair.seqs[0].length, pair.seqs[1].length);
+
+				for (const Engine *engine : opts.engines) {
+					const Engine *reference = reference_engine(engine->policy);
+					score_type expected, actual;
+					bool expected_edge = false, actual_edge = false;
+
+					if (pair_max_len > engine->max_length) {
+						continue;
+					}
+
+					if (pair.band_width == FULL_BAND) {
+						expected = reference->score_pair(pair.seqs[0], pair.seqs[1], pair.params.scoring_offset, pair.params.gap_penalty);
+
+						if (engine->score_threaded != nullptr) {
+							actual = engine->score_threaded(
+								pair.seqs[0],
+								pair.seqs[1],
+								pair.params.scoring_offset,
+								pair.params.gap_penalty,
+								opts.pair_threads
+							);
+						} else {
+							actual = engine->score_pair(pair.seqs[0], pair.seqs[1], pair.params.scoring_offset, pair.params.gap_penalty);
+						}
+					} else if (engine->score_banded != nullptr) {
+						expected = reference->score_banded(
+							pair.seqs[0],
+							pair.seqs[1],
+							pair.params.scoring_offset,
+							pair.params.gap_penalty,
+							pair.band_width,
+							&expected_edge
+						);
+
+						actual = engine->score_banded(
+							pair.seqs[0],
+							pair.seqs[1],
+							pair.params.scoring_offset,
+							pair.params.gap_penalty,
+							pair.band_width,
+							&actual_edge
+						);
+					} else {
+						continue;
+					}
+
+					if (actual != expected || actual_edge != expected_edge) {
+						std::lock_guard<std::mutex> lock(mismatch_mutex);
+
+						if (mismatches.size() < max_reported) {
+							mismatches.push_back({ pair_index, engine, expected, actual, expected_edge, actual_edge });
+						}
+
+						num_mismatches++;
+					}
+				}
+
+				cells += pair.seqs[0].length * pair.seqs[1].length;
+			}
+
+			num_cells += cells;
+		}
+	};
+
+	auto t_begin = std::chrono::steady_clock::now();
+
+	// threaded engines split the thread budget with the workers
+	unsigned num_workers = std::max(1u, opts.num_threads / opts.pair_threads);
+	std::vector<std::thread> threads;
+
+	for (unsigned t = 0; t < num_workers; t++) {
+		threads.emplace_back(worker);
+	}
+
+	for (std::thread &thread : threads) {
+		thread.join();
+	}
+
+	auto t_end = std::chrono::steady_clock::now();
+
+	std::sort(mismatches.begin(), mismatches.end(), [](const Mismatch &a, const Mismatch &b) {
+		return a.pair_index < b.pair_index;
+	});
+
+	for (const Mismatch &m : mismatches) {
+		Pair pair = make_pair(opts.seed, m.pair_index, opts.max_len);
+
+		std::fprintf(
+			stderr,
+			"MISMATCH pair %llu (%s, lengths %d x %d, offset %ld, penalty %ld, band %d): expected %ld%s, got %ld%s\n",
+			static_cast<unsigned long long>(m.pair_index),
+			m.engine->name,
+			pair.seqs[0].length,
+			pair.seqs[1].length,
+			static_cast<long>(pair.params.scoring_offset),
+			static_cast<long>(pair.params.gap_penalty),
+			pair.band_width,
+			static_cast<long>(m.expected),
+			m.expected_edge ? " (band edge)" : "",
+			static_cast<long>(m.actual),
+			m.actual_edge ? " (band edge)" : ""
+		);
+	}
+
+	std::fprintf(
+		stderr,
+		"%llu pairs (%llu cells, %llu skipped) x %zu engine(s) on %u thread(s) (%u per threaded pair) in %lg seconds: %llu mismatch(es)\n",
+		static_cast<unsigned long long>(opts.num_pairs),
+		static_cast<unsigned long long>(num_cells.load()),
+		static_cast<unsigned long long>(num_skipped.load()),
+		opts.engines.size(),
+		num_workers,
+		opts.pair_threads,
+		std::chrono::duration<double>(t_end - t_begin).count(),
+		static_cast<unsigned long long>(num_mismatches)
+	);
+
+	return num_mismatches == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,278 @@
+//
+// engines.cc
+//
+// Interchangeable implementations of the pairwise alignment score
+//
+// Created on 18/10/2026
+//
+
+#include <cstring>
+#include <limits>
+#include <algorithm>
+
+#include <hls_stream.h>
+
+#include "engines.hh"
+#include "profile.hh"
+#include "reference.hh"
+#include "scoring.hh"
+#include "wavefront.hh"
+#include "stream_views.hh"
+
+
+// align_with() or align_numeric_variant() for some scoring policy and cell type
+typedef void (*kernel_fn)(
+	SeqStreamView &stream_ver,
+	index_type stream_size_ver,
+	SeqStreamView &streams_hor,
+	LengthStreamView &stream_sizes_hor,
+	seq_count_type num_streams_hor,
+	score_type scoring_offset,
+	score_type gap_penalty,
+	index_type band_width,
+	ScoreSinkView &out_scores
+);
+
+// Run 'kernel' on 'num_hor' horizontal sequences, 'hor[j]' being the
+// j-th one, which it reads in place; it writes the scores straight into
+// 'out' (and the band edge flags into 'touched_edges', unless it's nullptr)
+static void csim_align(
+	kernel_fn kernel,
+	SeqView seq_ver,
+	SeqRange hor,
+	seq_count_type num_hor,
+	score_type scoring_offset,
+	score_type gap_penalty,
+	index_type band_width,
+	score_type *out,
+	bool *touched_edges
+)
+{
+	SeqStreamView stream_ver(seq_ver);
+	SeqStreamView streams_hor(hor, num_hor);
+	LengthStreamView stream_sizes_hor(hor, num_hor);
+	ScoreSinkView out_scores(out, touched_edges);
+
+	PhaseTimer timer(PHASE_COMPUTE);
+
+	kernel(
+		stream_ver,
+		seq_ver.length,
+		streams_hor,
+		stream_sizes_hor,
+		num_hor,
+		scoring_offset,
+		gap_penalty,
+		band_width,
+		out_scores
+	);
+
+	std::uint64_t len_hor = 0;
+
+	for (seq_count_type j = 0; j < num_hor; j++) {
+		len_hor += hor[j].length;
+	}
+
+	timer.add_items(seq_ver.length * len_hor);
+}
+
+void csim_align_row(
+	SeqView seq_ver,
+	const SequenceStore &seqs_hor,
+	seq_count_type first_hor,
+	seq_count_type last_hor,
+	score_type scoring_offset,
+	score_type gap_penalty,
+	score_type *out
+)
+{
+	csim_align(align_with<SCORING_POLICY>, seq_ver, SeqRange(seqs_hor, first_hor), last_hor - first_hor, scoring_offset, gap_penalty, FULL_BAND, out, nullptr);
+}
+
+void csim_align_row(
+	SeqView seq_ver,
+	const SeqView *seqs_hor,
+	seq_count_type num_hor,
+	score_type scoring_offset,
+	score_type gap_penalty,
+	score_type *out,
+	index_type band_width,
+	bool *touched_edges
+)
+{
+	csim_align(align_with<SCORING_POLICY>, seq_ver, SeqRange(seqs_hor), num_hor, scoring_offset, gap_penalty, band_width, out, touched_edges);
+}
+
+void align_row_any_length(
+	SeqView seq_ver,
+	const SeqView *seqs_hor,
+	seq_count_type num_hor,
+	score_type scoring_offset,
+	score_type gap_penalty,
+	score_type *out,
+	index_type band_width,
+	bool *touched_edges,
+	unsigned num_threads
+)
+{
+	seq_count_type first = 0;
+
+	while (first < num_hor) {
+		// the longest run of pairs from 'first' on that align() can take
+		seq_count_type last = first;
+
+		if (seq_ver.length <= MAX_SEQ_SIZE) {
+			while (last < num_hor && seqs_hor[last].length <= MAX_SEQ_SIZE) {
+				last++;
+			}
+		}
+
+		if (last > first) {
+			csim_align_row(
+				seq_ver,
+				seqs_hor + first,
+				last - first,
+				scoring_offset,
+				gap_penalty,
+				out + first,
+				band_width,
+				touched_edges ? touched_edges + first : nullptr
+			);
+
+			first = last;
+			continue;
+		}
+
+		out[first] = wavefront_score<SCORING_POLICY>(seq_ver, seqs_hor[first], scoring_offset, gap_penalty, num_threads);
+
+		if (touched_edges != nullptr) {
+			touched_edges[first] = false;
+		}
+
+		first++;
+	}
+}
+
+template<typename ScoringPolicy>
+static score_type csim_score_pair(
+	SeqView seq_ver,
+	SeqView seq_hor,
+	score_type scoring_offset,
+	score_type gap_penalty
+)
+{
+	score_type score = 0;
+	csim_align(align_with<ScoringPolicy>, seq_ver, SeqRange(&seq_hor), 1, scoring_offset, gap_penalty, FULL_BAND, &score, nullptr);
+	return score;
+}
+
+template<typename ScoringPolicy>
+static score_type csim_banded_score_pair(
+	SeqView seq_ver,
+	SeqView seq_hor,
+	score_type scoring_offset,
+	score_type gap_penalty,
+	index_type band_width,
+	bool *touched_edge
+)
+{
+	score_type score = 0;
+	csim_align(align_with<ScoringPolicy>, seq_ver, SeqRange(&seq_hor), 1, scoring_offset, gap_penalty, band_width, &score, touched_edge);
+	return score;
+}
+
+template<typename ScoringPolicy, typename Cell>
+static score_type csim_variant_score_pair(
+	SeqView seq_ver,
+	SeqView seq_hor,
+	score_type scoring_offset,
+	score_type gap_penalty
+)
+{
+	score_type score = 0;
+	csim_align(align_numeric_variant<ScoringPolicy, Cell>, seq_ver, SeqRange(&seq_hor), 1, scoring_offset, gap_penalty, FULL_BAND, &score, nullptr);
+	return score;
+}
+
+// Threads are up to the caller: one here, since callers that score many
+// pairs already run them concurrently
+template<typename ScoringPolicy>
+static score_type wavefront_score_pair(
+	SeqView seq_ver,
+	SeqView seq_hor,
+	score_type scoring_offset,
+	score_type gap_penalty
+)
+{
+	return wavefront_score<ScoringPolicy>(seq_ver, seq_hor, scoring_offset, gap_penalty, 1);
+}
+
+template<typename ScoringPolicy>
+static score_type wavefront_threaded_score_pair(
+	SeqView seq_ver,
+	SeqView seq_hor,
+	score_type scoring_offset,
+	score_type gap_penalty,
+	unsigned num_threads
+)
+{
+	return wavefront_score<ScoringPolicy>(seq_ver, seq_hor, scoring_offset, gap_penalty, num_threads);
+}
+
+// Longest sequence that SeqView can describe
+static const index_type any_length = std::numeric_limits<index_type>::max();
+
+const std::vector<Engine> &all_engines()
+{
+	static const std::vector<Engine> engines {
+		{ "csim",               SquaredDistanceScore::name(), csim_score_pair<SquaredDistanceScore>,      csim_banded_score_pair<SquaredDistanceScore>,    nullptr,                                             MAX_SEQ_SIZE },
+		{ "reference",          SquaredDistanceScore::name(), reference_score,                            reference_banded_score,                          nullptr,                                             any_length   },
+		{ "wavefront",          SquaredDistanceScore::name(), wavefront_score_pair<SquaredDistanceScore>, nullptr,                                         wavefront_threaded_score_pair<SquaredDistanceScore>, any_length   },
+		{ "csim-weighted",      PhiWeightedScore::name(),     csim_score_pair<PhiWeightedScore>,          csim_banded_score_pair<PhiWeightedScore>,        nullptr,                                             MAX_SEQ_SIZE },
+		{ "reference-weighted", PhiWeightedScore::name(),     reference_policy_score<PhiWeightedScore>,   reference_policy_banded_score<PhiWeightedScore>, nullptr,                                             any_length   },
+		{ "csim-cosine",        CosineScore::name(),          csim_score_pair<CosineScore>,               csim_banded_score_pair<CosineScore>,             nullptr,                                             MAX_SEQ_SIZE },
+		{ "reference-cosine",   CosineScore::name(),          reference_policy_score<CosineScore>,        reference_policy_banded_score<CosineScore>,      nullptr,                                             any_length   },
+		{ "csim-table",         TableScore::name(),           csim_score_pair<TableScore>,                csim_banded_score_pair<TableScore>,              nullptr,                                             MAX_SEQ_SIZE },
+		{ "reference-table",    TableScore::name(),           reference_policy_score<TableScore>,         reference_policy_banded_score<TableScore>,       nullptr,                                             any_length   },
+	};
+
+	return engines;
+}
+
+const std::vector<NumericVariant> &numeric_variants()
+{
+	static const std::vector<NumericVariant> variants {
+		{ "int16/int32",   "int16",   "int32", 32, 32, csim_variant_score_pair<SquaredDistanceScore,        score_type>   },
+		{ "int17/int32",   "int17",   "int32", 17, 32, csim_variant_score_pair<Int17SquaredDistanceScore,   score_type>   },
+		{ "float/int32",   "float",   "int32", 24, 32, csim_variant_score_pair<FloatSquaredDistanceScore,   score_type>   },
+		{ "fixed17/int32", "fixed17", "int32", 17, 32, csim_variant_score_pair<Fixed17SquaredDistanceScore, score_type>   },
+		{ "fixed12/int32", "fixed12", "int32", 12, 32, csim_variant_score_pair<Fixed12SquaredDistanceScore, score_type>   },
+		{ "int16/int26",   "int16",   "int26", 32, 26, csim_variant_score_pair<SquaredDistanceScore,        ap_int<26>>   },
+		{ "int16/int64",   "int16",   "int64", 32, 64, csim_variant_score_pair<SquaredDistanceScore,        std::int64_t> },
+		{ "int16/float",   "int16",   "float", 32, 32, csim_variant_score_pair<SquaredDistanceScore,        float>        },
+	};
+
+	return variants;
+}
+
+const Engine *find_engine(const char *name)
+{
+	for (const Engine &engine : all_engines()) {
+		if (std::strcmp(engine.name, name) == 0) {
+			return &engine;
+		}
+	}
+
+	return nullptr;
+}
+
+const Engine *reference_engine(const char *policy)
+{
+	for (const Engine &engine : all_engines()) {
+		if (std::strcmp(engine.policy, policy) == 0 && std::strncmp(engine.name, "reference", 9) == 0) {
+			return &engine;
+		}
+	}
+
+	return nullptr;
+}
@@ -0,0 +1,128 @@
+//
+// engines.hh
+//
+// Interchangeable implementations of the pairwise alignment score,
+// used by the host-side tools (benchmark, differential tests, drivers)
+//
+// Created on 18/10/2026
+//
+
+#ifndef SWPARA_ENGINES_HH
+#define SWPARA_ENGINES_HH
+
+#include <vector>
+
+#include "align.hh"
+#include "seq_store.hh"
+
+
+// Smith-Waterman score of a single pair of sequences
+typedef score_type (*pair_score_fn)(
+	SeqView seq_ver,
+	SeqView seq_hor,
+	score_type scoring_offset,
+	score_type gap_penalty
+);
+
+// Score of a single pair in banded mode (see FULL_BAND in align.hh),
+// and whether its best cell lies on the edge of the band
+typedef score_type (*banded_score_fn)(
+	SeqView seq_ver,
+	SeqView seq_hor,
+	score_type scoring_offset,
+	score_type gap_penalty,
+	index_type band_width,
+	bool *touched_edge
+);
+
+// Score of a single pair on 'num_threads' threads
+typedef score_type (*threaded_score_fn)(
+	SeqView seq_ver,
+	SeqView seq_hor,
+	score_type scoring_offset,
+	score_type gap_penalty,
+	unsigned num_threads
+);
+
+struct Engine {
+	const char *name;
+	const char *policy; // name() of the scoring policy, see scoring.hh
+	pair_score_fn score_pair; // on the calling thread
+	banded_score_fn score_banded; // nullptr if the engine has no banded mode
+	threaded_score_fn score_threaded; // nullptr if the engine only runs on the calling thread
+	index_type max_length; // of either sequence
+};
+
+// Every engine built into this binary. The first one is the C simulation
+// of the hardware with the default scoring policy; each scoring policy has
+// a C simulation and a full-matrix reference engine. The C simulations take
+// sequences of up to MAX_SEQ_SIZE residues, the others of any length.
+const std::vector<Engine> &all_engines();
+
+// A numeric variant of the C simulation of align() with the squared
+// distance score: the type that angle differences are squared in (see
+// SquaredDistanceScoreOf in scoring.hh), and the type of the cells (see
+// CELL_TYPE in align.hh). Both select the variant synthesized as well.
+struct NumericVariant {
+	const char *name;
+	const char *angle_format;
+	const char *cell_format;
+	unsigned multiplier_bits; // operand width of the squares (significand for float)
+	unsigned cell_bits;
+	pair_score_fn score_pair;
+};
+
+// The first one is the baseline: int16 angles, squared and summed in
+// 32 bits as SquaredDistanceScore does, and 32-bit cells
+const std::vector<NumericVariant> &numeric_variants();
+
+// nullptr if there's no engine called 'name'
+const Engine *find_engine(const char *name);
+
+// The full-matrix engine that the engines of 'policy' are checked against
+const Engine *reference_engine(const char *policy);
+
+// Run align() (i.e. the SCORING_POLICY of the build) on one vertical sequence against sequences [first_hor, last_hor)
+// of 'seqs_hor'. Its streams read the sequences and write the scores in place.
+void csim_align_row(
+	SeqView seq_ver,
+	const SequenceStore &seqs_hor,
+	seq_count_type first_hor,
+	seq_count_type last_hor,
+	score_type scoring_offset,
+	score_type gap_penalty,
+	score_type *out
+);
+
+// The same against 'num_hor' sequences of any layout. Only the first
+// 'length' angles of each sequence are read, so they need no padding.
+// In banded mode, whether the best cell of each pair lies on the edge
+// of the band is stored to 'touched_edges' unless it's nullptr.
+void csim_align_row(
+	SeqView seq_ver,
+	const SeqView *seqs_hor,
+	seq_count_type num_hor,
+	score_type scoring_offset,
+	score_type gap_penalty,
+	score_type *out,
+	index_type band_width = FULL_BAND,
+	bool *touched_edges = nullptr
+);
+
+// csim_align_row() for sequences of any length: pairs with a sequence
+// longer than MAX_SEQ_SIZE, which align() can't take, are scored by
+// wavefront_score() on 'num_threads' threads instead. Those pairs have
+// no banded mode; they are scored in full, and never touch the band edge.
+void align_row_any_length(
+	SeqView seq_ver,
+	const SeqView *seqs_hor,
+	seq_count_type num_hor,
+	score_type scoring_offset,
+	score_type gap_penalty,
+	score_type *out,
+	index_type band_width,
+	bool *touched_edges,
+	unsigned num_threads
+);
+
+#endif // SWPARA_ENGINES_HH
@@ -1,163 +1,399 @@
 #include <string>
 #include <vector>
-#include <iostream>
 #include <algorithm>
-#include <numeric>
 #include <chrono>
+#include <memory>
 #include <cstring>
+#include <cerrno>
+#include <stdexcept>
+#include <thread>
 
-#include <hls_stream.h>
+#include <unistd.h>
 
 #include "align.hh"
+#include "seq_file.hh"
+#include "out_of_core.hh"
+#include "triangle.hh"
+#include "checkpoint.hh"
+#include "profile.hh"
+#include "seq_store.hh"
+#include "sweep.hh"
+#include "cluster.hh"
+#include "pipeline.hh"
+
+
+struct Options {
+    score_type scoring_offset = 0;
+    score_type gap_penalty = 0;
+    const char *input_path = nullptr;     // binary INPUT.BIN; text from stdin if null
+    const char *output_path = nullptr;    // binary OUTPUT.BIN; text to stdout if null
+    const char *profile_path = nullptr;   // JSON phase breakdown; stderr if null
+    std::size_t memory_budget = 256 << 20;
+    seq_count_type shard_index = 0;       // this process computes shard #shard_index...
+    seq_count_type shard_count = 0;       // ...out of shard_count; 0 if not sharded
+    const char *checkpoint_path = nullptr;
+    double checkpoint_interval = 60;      // seconds
+    unsigned num_threads = std::max(1u, std::thread::hardware_concurrency()); // compute workers
+    std::vector<ScoringParams> sweep;     // further settings, computed in the same pass
+    bool cluster = false;                 // clusters instead of scores...
+    score_type cluster_threshold = 0;     // ...of pairs scoring at least this much
+};
+
+// "OFFSET:PENALTY[,OFFSET:PENALTY...]"
+static bool parse_sweep(const char *str, std::vector<ScoringParams> &settings)
+{
+    for (;;) {
+        char *end = nullptr;
+        ScoringParams params;
+
+        params.scoring_offset = std::strtol(str, &end, 10);
+
+        if (end == str || *end != ':') {
+            return false;
+        }
+
+        str = end + 1;
+        params.gap_penalty = std::strtol(str, &end, 10);
+
+        if (end == str || (*end != ',' && *end != '\0')) {
+            return false;
+        }
+
+        settings.push_back(params);
+
+        if (*end == '\0') {
+            return true;
+        }
 
+        str = end + 1;
+    }
+}
 
-template<typename T>
-void fill_stream(hls::stream<T> &stream, const T *begin, const T *end)
+static bool parse_options(int argc, char *argv[], Options &opts)
 {
-	while (begin < end) {
-		stream.write(*begin++);
-	}
+    if (argc < 3) {
+        return false;
+    }
+
+    opts.scoring_offset = std::strtol(argv[1], nullptr, 10);
+    opts.gap_penalty    = std::strtol(argv[2], nullptr, 10);
+
+    for (int i = 3; i < argc; i++) {
+        if (i + 1 >= argc) {
+            return false;
+        }
+
+        if (std::strcmp(argv[i], "--input") == 0) {
+            opts.input_path = argv[++i];
+        } else if (std::strcmp(argv[i], "--output") == 0) {
+            opts.output_path = argv[++i];
+        } else if (std::strcmp(argv[i], "--profile") == 0) {
+            opts.profile_path = argv[++i];
+        } else if (std::strcmp(argv[i], "--memory-budget") == 0) {
+            opts.memory_budget = std::strtoull(argv[++i], nullptr, 10) << 20;
+        } else if (std::strcmp(argv[i], "--checkpoint") == 0) {
+            opts.checkpoint_path = argv[++i];
+        } else if (std::strcmp(argv[i], "--checkpoint-interval") == 0) {
+            opts.checkpoint_interval = std::strtod(argv[++i], nullptr);
+        } else if (std::strcmp(argv[i], "--threads") == 0) {
+            opts.num_threads = std::max(1ul, std::strtoul(argv[++i], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--cluster") == 0) {
+            opts.cluster = true;
+            opts.cluster_threshold = std::strtol(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--sweep") == 0) {
+            if (!parse_sweep(argv[++i], opts.sweep)) {
+                return false;
+            }
+        } else if (std::strcmp(argv[i], "--shard") == 0) {
+            unsigned long index = 0, count = 0;
+
+            if (std::sscanf(argv[++i], "%lu/%lu", &index, &count) != 2 || index >= count) {
+                return false;
+            }
+
+            opts.shard_index = index;
+            opts.shard_count = count;
+        } else {
+            return false;
+        }
+    }
+
+    // shards are always written to a shard file,
+    // and only binary output can be resumed
+    if ((opts.shard_count > 0 || opts.checkpoint_path) && opts.output_path == nullptr) {
+        return false;
+    }
+
+    // a sweep writes one binary file per setting, and can't be resumed
+    if (!opts.sweep.empty() && (opts.output_path == nullptr || opts.checkpoint_path)) {
+        return false;
+    }
+
+    // clustering needs every row of a single setting
+    if (opts.cluster && (opts.input_path == nullptr || opts.shard_count > 0 || opts.checkpoint_path || !opts.sweep.empty())) {
+        return false;
+    }
+
+    return opts.output_path == nullptr || opts.input_path != nullptr;
 }
 
-std::vector<Dihedral> read_sequences(std::istream &instream)
+// Phase breakdown table on stderr, plus the same numbers as JSON
+static void report_profile(const Options &opts, double wall_seconds)
 {
-    std::vector<Dihedral> vec;
+    profile_print_table(stderr, wall_seconds);
+
+    if (opts.profile_path == nullptr) {
+        std::fprintf(stderr, "profile: ");
+        profile_print_json(stderr, wall_seconds);
+        return;
+    }
+
+    std::FILE *file = std::fopen(opts.profile_path, "w");
+
+    if (file == nullptr) {
+        std::fprintf(stderr, "can't create '%s': %s\n", opts.profile_path, std::strerror(errno));
+        return;
+    }
+
+    profile_print_json(file, wall_seconds);
+    std::fclose(file);
+}
 
-    angle_type phi, psi;
-    while (instream >> phi >> psi) {
-        vec.push_back({ phi, psi });
+// Rows of the triangle that this process computes
+static RowRange run_rows(const Options &opts, const SeqFile &seqs)
+{
+    RowRange rows = { 0, seqs.size() - 1 };
+
+    if (opts.shard_count > 0) {
+        rows = shard_rows(seqs.lengths(), opts.shard_index, opts.shard_count);
+
+        std::fprintf(
+            stderr,
+            "Shard %lu/%lu: rows [%lu, %lu)\n",
+            static_cast<unsigned long>(opts.shard_index),
+            static_cast<unsigned long>(opts.shard_count),
+            static_cast<unsigned long>(rows.begin),
+            static_cast<unsigned long>(rows.end)
+        );
     }
 
-    return vec;
+    return rows;
 }
 
-std::vector<index_type> read_lengths(std::istream &instream)
+// Parameter sweep: the positional setting and the --sweep settings in a single
+// pass, setting #k being written to "<output>.<k>"
+static int run_sweep(const Options &opts, SeqFile &seqs)
 {
-    std::vector<index_type> vec;
+    RowRange rows = run_rows(opts, seqs);
 
-    std::string line;
-    std::getline(instream, line);
+    std::vector<ScoringParams> settings(1, ScoringParams{ opts.scoring_offset, opts.gap_penalty });
+    settings.insert(settings.end(), opts.sweep.begin(), opts.sweep.end());
 
-    const char *ptr = line.data();
-    const char *end = ptr + line.size();
+    std::vector<std::unique_ptr<RowWriter>> file_writers;
+    std::vector<RowWriter *> writers;
 
-    while (ptr < end) {
-        char *next = nullptr;
-        errno = 0;
+    for (std::size_t k = 0; k < settings.size(); k++) {
+        std::string path = std::string(opts.output_path) + "." + std::to_string(k);
 
-        index_type length = std::strtol(ptr, &next, 10);
+        std::fprintf(
+            stderr,
+            "Setting #%zu: offset %ld, penalty %ld -> %s\n",
+            k,
+            static_cast<long>(settings[k].scoring_offset),
+            static_cast<long>(settings[k].gap_penalty),
+            path.c_str()
+        );
 
-        if (length == 0 && next == ptr || errno != 0) {
-            break;
+        if (opts.shard_count > 0) {
+            file_writers.emplace_back(new ShardRowWriter(path.c_str(), seqs.size(), rows.begin, rows.end));
+        } else {
+            file_writers.emplace_back(new BinaryRowWriter(path.c_str(), seqs.size()));
         }
 
-        vec.push_back(length);
-        ptr = next;
+        writers.push_back(file_writers.back().get());
     }
 
-    return vec;
-}
+    auto t_begin = std::chrono::steady_clock::now();
 
+    align_out_of_core(seqs, opts.memory_budget, settings, rows, writers, opts.num_threads);
 
+    auto t_end = std::chrono::steady_clock::now();
+    double wall_seconds = std::chrono::duration<double>(t_end - t_begin).count();
 
-int main(int argc, char *argv[])
+    std::fprintf(stderr, "Elapsed time: %lg seconds\n", wall_seconds);
+    report_profile(opts, wall_seconds);
+
+    return 0;
+}
+
+// Clusters are written as text to the output file, or to stdout; no scores are kept
+static int run_cluster(const Options &opts, SeqFile &seqs)
 {
-    // Parse arguments
-    if (argc != 3) {
-        std::fprintf(stderr, "usage: %s <scoring_offset> <gap_penalty>\n", argv[0]);
+    std::FILE *file = opts.output_path ? std::fopen(opts.output_path, "w") : stdout;
+
+    if (file == nullptr) {
+        std::fprintf(stderr, "can't create '%s': %s\n", opts.output_path, std::strerror(errno));
         return -1;
     }
 
-    score_type scoring_offset = std::strtol(argv[1], nullptr, 10);
-    score_type gap_penalty    = std::strtol(argv[2], nullptr, 10);
+    std::unique_ptr<std::FILE, int (*)(std::FILE *)> closer(file, file == stdout ? std::fflush : std::fclose);
+    ClusterRowWriter writer(file, seqs.size(), opts.cluster_threshold);
+
+    auto t_begin = std::chrono::steady_clock::now();
+
+    align_out_of_core(seqs, opts.memory_budget, opts.scoring_offset, opts.gap_penalty, run_rows(opts, seqs), writer, opts.num_threads);
+
+    auto t_end = std::chrono::steady_clock::now();
+    double wall_seconds = std::chrono::duration<double>(t_end - t_begin).count();
+
+    std::fprintf(
+        stderr,
+        "Elapsed time: %lg seconds\nClusters: %lu (largest: %lu sequences)\n",
+        wall_seconds,
+        static_cast<unsigned long>(writer.num_clusters()),
+        static_cast<unsigned long>(writer.largest_cluster())
+    );
+    report_profile(opts, wall_seconds);
+
+    return 0;
+}
 
-    // this is here so that the input stream can be changed easily later
-    std::istream &instream = std::cin;
+// Database is streamed from a binary file, in blocks that fit the memory budget
+static int run_out_of_core(const Options &opts)
+{
+    SeqFile seqs(opts.input_path);
 
-    // throw away explicit number of sequences
-    {
-        std::string line;
-        std::getline(instream, line);
+    if (seqs.size() < 2) {
+        std::fprintf(stderr, "at least 2 sequences are required\n");
+        return -1;
     }
 
-    // Read lengths of sequences
-    auto lengths = read_lengths(instream);
+    if (!opts.sweep.empty()) {
+        return run_sweep(opts, seqs);
+    }
 
-    // Read sequence data
-    auto sequences = read_sequences(instream);
+    if (opts.cluster) {
+        return run_cluster(opts, seqs);
+    }
 
-    // Perform alignment
-    hls::stream<axi_out_score_type> out_scores;
+    RowRange rows = run_rows(opts, seqs);
+
+    // Skip the rows that a previous, interrupted run has finished
+    CheckpointIdentity identity = {
+        opts.checkpoint_path ? input_fingerprint(seqs) : 0,
+        seqs.size(),
+        rows.begin,
+        rows.end,
+        opts.scoring_offset,
+        opts.gap_penalty,
+    };
+    CheckpointState resume = { rows.begin, 0 };
+
+    if (opts.checkpoint_path && load_checkpoint(opts.checkpoint_path, identity, resume)) {
+        std::fprintf(stderr, "Resuming from row %lu\n", static_cast<unsigned long>(resume.next_row));
+    }
 
-    std::size_t ver_begin = 0;
-    double elapsed_time = 0.0;
+    std::unique_ptr<ScoreFileWriter> file_writer;
+    std::unique_ptr<CheckpointWriter> checkpoint_writer;
+    std::unique_ptr<RowWriter> text_writer;
+    RowWriter *writer = nullptr;
+
+    if (opts.shard_count > 0) {
+        file_writer.reset(new ShardRowWriter(opts.output_path, seqs.size(), rows.begin, rows.end, resume.output_size));
+        writer = file_writer.get();
+    } else if (opts.output_path) {
+        file_writer.reset(new BinaryRowWriter(opts.output_path, seqs.size(), resume.output_size));
+        writer = file_writer.get();
+    } else {
+        text_writer.reset(new TextRowWriter(stdout));
+        writer = text_writer.get();
+    }
 
-    using ull = unsigned long long;
-    ull num_cells = 0;
+    if (opts.checkpoint_path) {
+        checkpoint_writer.reset(new CheckpointWriter(*file_writer, opts.checkpoint_path, identity, opts.checkpoint_interval));
+        writer = checkpoint_writer.get();
+    }
 
-    for (std::size_t i = 0; i < lengths.size() - 1; i++) {
-        std::size_t ver_end = ver_begin + lengths[i];
-        std::size_t hor_begin = ver_end;
-        std::size_t hor_end = sequences.size();
+    rows.begin = resume.next_row;
 
-        hls::stream<Dihedral>   stream_ver;
-        hls::stream<Dihedral>   streams_hor;
-        hls::stream<index_type> stream_sizes_hor;
+    auto t_begin = std::chrono::steady_clock::now();
 
-        fill_stream(stream_ver,       &sequences[ver_begin], &sequences[ver_end]);
-        fill_stream(streams_hor,      &sequences[hor_begin], &sequences[hor_end]);
-        fill_stream(stream_sizes_hor, &lengths[i + 1],       &lengths[lengths.size()]);
+    align_out_of_core(seqs, opts.memory_budget, opts.scoring_offset, opts.gap_penalty, rows, *writer, opts.num_threads);
 
-        num_cells += (ull)(ver_end - ver_begin) * (ull) std::accumulate(&lengths[i + 1], &lengths[lengths.size()], 0ull);
+    auto t_end = std::chrono::steady_clock::now();
+    double wall_seconds = std::chrono::duration<double>(t_end - t_begin).count();
 
-        auto t_begin = std::chrono::steady_clock::now();
+    std::fprintf(stderr, "Elapsed time: %lg seconds\n", wall_seconds);
 
-        align(
-            stream_ver,
-            stream_ver.size(),
-            streams_hor,
-            stream_sizes_hor,
-            stream_sizes_hor.size(),
-            scoring_offset,
-            gap_penalty,
-            out_scores
+    if (checkpoint_writer) {
+        std::fprintf(
+            stderr,
+            "Checkpoints: %zu, %lg seconds (%.3lf%% of elapsed time)\n",
+            checkpoint_writer->num_checkpoints(),
+            checkpoint_writer->seconds(),
+            wall_seconds > 0 ? 100 * checkpoint_writer->seconds() / wall_seconds : 0.0
         );
+    }
 
-        auto t_end = std::chrono::steady_clock::now();
-        elapsed_time += std::chrono::duration<double>(t_end - t_begin).count();
+    report_profile(opts, wall_seconds);
 
-        std::fprintf(stderr, "%lg... ", elapsed_time);
-        std::fflush(stderr);
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    // Parse arguments
+    Options opts;
 
-        ver_begin = ver_end;
+    if (!parse_options(argc, argv, opts)) {
+        std::fprintf(
+            stderr,
+            "usage: %s <scoring_offset> <gap_penalty> [--input INPUT.BIN [--memory-budget MiB] [--output OUTPUT.BIN] [--shard K/N] [--checkpoint FILE [--checkpoint-interval SECONDS] | --sweep OFFSET:PENALTY[,...] | --cluster THRESHOLD]] [--threads N] [--profile PROFILE.json]\n",
+            argv[0]
+        );
+        return -1;
     }
 
-    // Dump performance counter to stderr
-    std::fprintf(stderr, "\nElapsed time: %lg seconds\nNumber of cells: %llu\n", elapsed_time, num_cells);
-
-    // Dump results
-    std::size_t group_length = lengths.size() - 1;
-    std::size_t group_index = 0;
-    std::size_t score_index = 0;
-    bool should_print_group_index = true;
-
-	while (not out_scores.empty()) {
-        if (should_print_group_index) {
-            should_print_group_index = false;
-            std::printf("#%zu.\t", group_index++);
+    if (!boundary_deltas_fit(opts.scoring_offset, opts.gap_penalty)) {
+        std::fprintf(
+            stderr,
+            "scoring offset %ld and gap penalty %ld are out of range of the %d-bit boundary deltas\n",
+            static_cast<long>(opts.scoring_offset),
+            static_cast<long>(opts.gap_penalty),
+            BOUNDARY_DELTA_BITS
+        );
+        return -1;
+    }
+
+    if (opts.input_path) {
+        try {
+            return run_out_of_core(opts);
+        } catch (const std::exception &ex) {
+            std::fprintf(stderr, "error: %s\n", ex.what());
+            return -1;
         }
+    }
 
-		std::printf(" %ld", static_cast<long>(out_scores.read().data));
+    auto t_run_begin = std::chrono::steady_clock::now();
 
-        if (++score_index == group_length) {
-            score_index = 0;
-            --group_length;
-            should_print_group_index = true;
-            std::printf("\n");
-        }
-	}
+    // Parse, align and dump results concurrently
+    TextRowWriter writer(stdout);
+    unsigned long long num_cells = 0;
 
-	std::printf("\n");
+    try {
+        TextInput input(STDIN_FILENO);
+        num_cells = align_pipelined(input, opts.scoring_offset, opts.gap_penalty, opts.num_threads, writer);
+    } catch (const std::exception &ex) {
+        std::fprintf(stderr, "error: %s\n", ex.what());
+        return -1;
+    }
+
+    auto t_run_end = std::chrono::steady_clock::now();
+    double wall_seconds = std::chrono::duration<double>(t_run_end - t_run_begin).count();
+
+    // Dump performance counter to stderr
+    std::fprintf(stderr, "\nElapsed time: %lg seconds\nNumber of cells: %llu\n", wall_seconds, num_cells);
+    report_profile(opts, wall_seconds);
 
     return 0;
 }
@@ -0,0 +1,185 @@
+//
+// merge_shards.cc
+//
+// Assembles the shard files written by `align --shard K/N` into a
+// single OUTPUT.BIN. Shards may be given in any order, but together
+// they must cover every row of the triangle exactly once.
+//
+// Created on 18/10/2026
+//
+
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <stdexcept>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+
+#include "align.hh"
+#include "seq_file.hh"
+
+
+struct Shard {
+	const char *path;
+	ShardHeader header;
+};
+
+static const std::size_t copy_buffer_size = 1 << 20; // in scores
+
+// Number of scores in rows [begin, end) of the triangle of 'num_seqs' sequences
+static std::uint64_t num_scores(seq_count_type num_seqs, seq_count_type begin, seq_count_type end)
+{
+	std::uint64_t count = 0;
+
+	for (seq_count_type i = begin; i < end; i++) {
+		count += num_seqs - 1 - i;
+	}
+
+	return count;
+}
+
+static Shard open_shard(const char *path)
+{
+	std::FILE *file = std::fopen(path, "rb");
+
+	if (file == nullptr) {
+		throw std::runtime_error(std::string("can't open '") + path + "': " + std::strerror(errno));
+	}
+
+	Shard shard = { path, {} };
+
+	try {
+		shard.header = read_shard_header(file, path);
+	} catch (...) {
+		std::fclose(file);
+		throw;
+	}
+
+	std::fclose(file);
+	return shard;
+}
+
+static void append_shard(const Shard &shard, std::FILE *out, std::vector<score_type> &buf)
+{
+	std::FILE *file = std::fopen(shard.path, "rb");
+
+	if (file == nullptr || std::fseek(file, sizeof(ShardHeader), SEEK_SET) != 0) {
+		throw std::runtime_error(std::string("can't read '") + shard.path + "': " + std::strerror(errno));
+	}
+
+	std::uint64_t remaining = num_scores(shard.header.num_seqs, shard.header.row_begin, shard.header.row_end);
+
+	while (remaining > 0) {
+		std::size_t count = std::min<std::uint64_t>(remaining, buf.size());
+
+		if (std::fread(buf.data(), sizeof buf[0], count, file) != count) {
+			std::fclose(file);
+			throw std::runtime_error(std::string("'") + shard.path + "' is truncated");
+		}
+
+		if (std::fwrite(buf.data(), sizeof buf[0], count, out) != count) {
+			std::fclose(file);
+			throw std::runtime_error(std::string("can't write scores: ") + std::strerror(errno));
+		}
+
+		remaining -= count;
+	}
+
+	// there must be nothing after the last row
+	bool trailing = std::fgetc(file) != EOF;
+	std::fclose(file);
+
+	if (trailing) {
+		throw std::runtime_error(std::string("'") + shard.path + "' has trailing data");
+	}
+}
+
+static void merge(const char *out_path, const std::vector<const char *> &paths)
+{
+	std::vector<Shard> shards;
+
+	for (const char *path : paths) {
+		shards.push_back(open_shard(path));
+	}
+
+	std::sort(shards.begin(), shards.end(), [](const Shard &a, const Shard &b) {
+		// empty shards go before non-empty ones starting at the same row
+		return a.header.row_begin != b.header.row_begin
+			? a.header.row_begin < b.header.row_begin
+			: a.header.row_end < b.header.row_end;
+	});
+
+	// Shards must be of the same database and tile the rows without gaps or overlaps
+	seq_count_type num_seqs = shards.front().header.num_seqs;
+	seq_count_type next_row = 0;
+
+	for (const Shard &shard : shards) {
+		if (shard.header.num_seqs != num_seqs) {
+			throw std::runtime_error(std::string("'") + shard.path + "' belongs to a different database");
+		}
+
+		if (shard.header.row_begin > next_row) {
+			throw std::runtime_error(
+				"rows [" + std::to_string(next_row) + ", " + std::to_string(shard.header.row_begin) + ") are missing"
+			);
+		}
+
+		if (shard.header.row_begin < next_row) {
+			throw std::runtime_error(
+				"rows [" + std::to_string(shard.header.row_begin) + ", " + std::to_string(next_row) + ") "
+				"are covered by more than one shard"
+			);
+		}
+
+		next_row = shard.header.row_end;
+	}
+
+	if (next_row != std::max<seq_count_type>(num_seqs, 1) - 1) {
+		throw std::runtime_error("rows from " + std::to_string(next_row) + " on are missing");
+	}
+
+	std::FILE *out = std::fopen(out_path, "wb");
+
+	if (out == nullptr) {
+		throw std::runtime_error(std::string("can't create '") + out_path + "': " + std::strerror(errno));
+	}
+
+	std::vector<score_type> buf(copy_buffer_size);
+
+	try {
+		if (std::fwrite(&num_seqs, sizeof num_seqs, 1, out) != 1) {
+			throw std::runtime_error(std::string("can't write '") + out_path + "': " + std::strerror(errno));
+		}
+
+		for (const Shard &shard : shards) {
+			append_shard(shard, out, buf);
+		}
+	} catch (...) {
+		std::fclose(out);
+		std::remove(out_path);
+		throw;
+	}
+
+	if (std::fclose(out) != 0) {
+		throw std::runtime_error(std::string("can't write '") + out_path + "': " + std::strerror(errno));
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	if (argc < 3) {
+		std::fprintf(stderr, "usage: %s OUTPUT.BIN SHARD...\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	try {
+		merge(argv[1], std::vector<const char *>(argv + 2, argv + argc));
+	} catch (const std::exception &ex) {
+		std::fprintf(stderr, "error: %s\n", ex.what());
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,276 @@
+//
+// numa.cc
+//
+// Placement of worker threads and of the sequence store on NUMA hosts
+//
+// Created on 18/10/2026
+//
+
+#include <string>
+#include <thread>
+#include <exception>
+#include <fstream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+
+#ifdef __linux__
+#include <dirent.h>
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "numa.hh"
+
+
+// CPUs that this process may run on; empty if unknown
+static std::vector<unsigned> allowed_cpus()
+{
+	std::vector<unsigned> cpus;
+
+#ifdef __linux__
+	cpu_set_t set;
+
+	if (sched_getaffinity(0, sizeof set, &set) == 0) {
+		for (unsigned cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+			if (CPU_ISSET(cpu, &set)) {
+				cpus.push_back(cpu);
+			}
+		}
+	}
+#endif
+
+	return cpus;
+}
+
+// "0-3,8-11" format of cpulist files
+static std::vector<unsigned> parse_cpu_list(const std::string &list)
+{
+	std::vector<unsigned> cpus;
+	const char *str = list.c_str();
+
+	while (*str != '\0' && *str != '\n') {
+		char *end = nullptr;
+		unsigned first = std::strtoul(str, &end, 10);
+		unsigned last = first;
+
+		if (end == str) {
+			break;
+		}
+
+		if (*end == '-') {
+			str = end + 1;
+			last = std::strtoul(str, &end, 10);
+		}
+
+		for (unsigned cpu = first; cpu <= last; cpu++) {
+			cpus.push_back(cpu);
+		}
+
+		str = *end == ',' ? end + 1 : end;
+	}
+
+	return cpus;
+}
+
+// Nodes of the host, with their CPUs that are in 'allowed' (if that's not empty)
+static std::vector<NumaNode> system_nodes(const std::vector<unsigned> &allowed)
+{
+	std::vector<NumaNode> nodes;
+
+#ifdef __linux__
+	DIR *dir = opendir("/sys/devices/system/node");
+
+	if (dir == nullptr) {
+		return nodes;
+	}
+
+	while (dirent *entry = readdir(dir)) {
+		unsigned id = 0;
+		char rest = 0;
+
+		if (std::sscanf(entry->d_name, "node%u%c", &id, &rest) != 1) {
+			continue;
+		}
+
+		std::ifstream file("/sys/devices/system/node/" + std::string(entry->d_name) + "/cpulist");
+		std::string list;
+		NumaNode node { id, {} };
+
+		std::getline(file, list);
+
+		for (unsigned cpu : parse_cpu_list(list)) {
+			if (allowed.empty() || std::binary_search(allowed.begin(), allowed.end(), cpu)) {
+				node.cpus.push_back(cpu);
+			}
+		}
+
+		if (!node.cpus.empty()) {
+			nodes.push_back(node);
+		}
+	}
+
+	closedir(dir);
+
+	std::sort(nodes.begin(), nodes.end(), [](const NumaNode &a, const NumaNode &b) { return a.id < b.id; });
+#else
+	(void)allowed;
+#endif
+
+	return nodes;
+}
+
+std::vector<NumaNode> numa_nodes()
+{
+	std::vector<unsigned> allowed = allowed_cpus();
+	const char *fake = std::getenv("SWPARA_NUMA_NODES");
+
+	if (fake != nullptr && std::strtoul(fake, nullptr, 10) > 0) {
+		unsigned num_nodes = std::strtoul(fake, nullptr, 10);
+		std::vector<NumaNode> nodes(num_nodes);
+
+		// contiguous, even slices of the allowed CPUs
+		for (unsigned k = 0; k < num_nodes; k++) {
+			nodes[k].id = k;
+			nodes[k].cpus.assign(allowed.begin() + allowed.size() * k / num_nodes, allowed.begin() + allowed.size() * (k + 1) / num_nodes);
+		}
+
+		return nodes;
+	}
+
+	std::vector<NumaNode> nodes = system_nodes(allowed);
+
+	if (nodes.empty()) {
+		nodes.push_back(NumaNode { 0, allowed });
+	}
+
+	return nodes;
+}
+
+WorkerPlacement place_workers(unsigned num_workers)
+{
+	std::vector<NumaNode> nodes = numa_nodes();
+	std::vector<unsigned> workers(nodes.size(), 0);
+	std::vector<std::size_t> weights(nodes.size(), 1);
+	std::size_t total_weight = nodes.size();
+	unsigned assigned = 0;
+
+	// in proportion to the CPUs of each node, if they are all known
+	if (std::none_of(nodes.begin(), nodes.end(), [](const NumaNode &node) { return node.cpus.empty(); })) {
+		total_weight = 0;
+
+		for (std::size_t k = 0; k < nodes.size(); k++) {
+			weights[k] = nodes[k].cpus.size();
+			total_weight += weights[k];
+		}
+	}
+
+	for (std::size_t k = 0; k < nodes.size(); k++) {
+		workers[k] = std::uint64_t(num_workers) * weights[k] / total_weight;
+		assigned += workers[k];
+	}
+
+	// the rest one by one, to the nodes with the fewest workers per CPU
+	for (; assigned < num_workers; assigned++) {
+		std::size_t best = 0;
+
+		for (std::size_t k = 1; k < nodes.size(); k++) {
+			if (std::uint64_t(workers[k]) * weights[best] < std::uint64_t(workers[best]) * weights[k]) {
+				best = k;
+			}
+		}
+
+		workers[best]++;
+	}
+
+	// nodes without workers play no part
+	WorkerPlacement placement;
+
+	for (std::size_t k = 0; k < nodes.size(); k++) {
+		if (workers[k] > 0) {
+			placement.nodes.push_back(nodes[k]);
+			placement.workers.push_back(workers[k]);
+		}
+	}
+
+	if (placement.nodes.empty()) {
+		placement.nodes.push_back(nodes[0]);
+		placement.workers.push_back(0);
+	}
+
+	return placement;
+}
+
+void pin_to_node(const WorkerPlacement &placement, std::size_t node)
+{
+	if (!placement.is_numa() || placement.nodes[node].cpus.empty()) {
+		return;
+	}
+
+#ifdef __linux__
+	cpu_set_t set;
+	CPU_ZERO(&set);
+
+	for (unsigned cpu : placement.nodes[node].cpus) {
+		CPU_SET(cpu, &set);
+	}
+
+	// best effort: an unpinned worker is only slower
+	pthread_setaffinity_np(pthread_self(), sizeof set, &set);
+#endif
+}
+
+void run_on_nodes(const WorkerPlacement &placement, const std::function<void(std::size_t node)> &fn)
+{
+	std::vector<std::exception_ptr> errors(placement.nodes.size());
+	std::vector<std::thread> threads;
+
+	for (std::size_t node = 0; node < placement.nodes.size(); node++) {
+		if (placement.workers[node] == 0) {
+			continue;
+		}
+
+		threads.emplace_back([&, node]() {
+			try {
+				pin_to_node(placement, node);
+				fn(node);
+			} catch (...) {
+				errors[node] = std::current_exception();
+			}
+		});
+	}
+
+	for (std::thread &thread : threads) {
+		thread.join();
+	}
+
+	for (const std::exception_ptr &error : errors) {
+		if (error) {
+			std::rethrow_exception(error);
+		}
+	}
+}
+
+StoreReplicas::StoreReplicas(const WorkerPlacement &placement, const std::vector<index_type> &lengths) :
+	replicas_(placement.nodes.size())
+{
+	std::size_t total_length = 0;
+
+	for (index_type length : lengths) {
+		total_length += length;
+	}
+
+	// zero-filled by a thread of the node, so the pages are allocated there
+	run_on_nodes(placement, [&](std::size_t node) {
+		std::unique_ptr<Replica> replica(new Replica);
+		replica->store.reserve(lengths.size(), total_length);
+
+		for (index_type length : lengths) {
+			angle_type *phi, *psi;
+			replica->store.append(length, phi, psi);
+		}
+
+		replicas_[node] = std::move(replica);
+	});
+}
@@ -0,0 +1,106 @@
+//
+// numa.hh
+//
+// Placement of worker threads and of the sequence store on multi-socket
+// (NUMA) hosts: workers are pinned to nodes, and every node reads its own
+// replica of the sequences instead of the memory of whichever node
+// happened to load them.
+//
+// The topology comes from /sys/devices/system/node on Linux; elsewhere,
+// and on single-node hosts, there is one node and nothing is pinned or
+// replicated. SWPARA_NUMA_NODES=N in the environment overrides the
+// topology with N nodes that split the CPUs of the process evenly, so that
+// NUMA placement can be exercised (and turned off with N=1) anywhere.
+//
+// Created on 18/10/2026
+//
+
+#ifndef SWPARA_NUMA_HH
+#define SWPARA_NUMA_HH
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <functional>
+#include <algorithm>
+#include <cstddef>
+
+#include "align.hh"
+#include "seq_store.hh"
+
+
+struct NumaNode {
+	unsigned id;
+	std::vector<unsigned> cpus; // that this process may run on; empty if unknown
+};
+
+// Nodes that this process has CPUs on; at least one
+std::vector<NumaNode> numa_nodes();
+
+// Where the workers of a job run: workers [0, workers[0]) on node #0,
+// the next workers[1] on node #1, and so on, in proportion to their CPUs
+struct WorkerPlacement {
+	std::vector<NumaNode> nodes;
+	std::vector<unsigned> workers; // per node
+
+	bool is_numa() const { return nodes.size() > 1; }
+
+	std::size_t node_of(unsigned worker) const
+	{
+		std::size_t node = 0;
+
+		while (node + 1 < workers.size() && worker >= workers[node]) {
+			worker -= workers[node++];
+		}
+
+		return node;
+	}
+};
+
+WorkerPlacement place_workers(unsigned num_workers);
+
+// Restricts the calling thread to the CPUs of 'node', if there's more than
+// one node; then its first touch of new memory allocates it on that node
+void pin_to_node(const WorkerPlacement &placement, std::size_t node);
+
+// Runs 'fn(node)' on a thread pinned to every node that has workers,
+// and waits for them. Rethrows the first exception of 'fn'.
+void run_on_nodes(const WorkerPlacement &placement, const std::function<void(std::size_t node)> &fn);
+
+// Copies of a read-only sequence store in the local memory of every node
+// of a NUMA placement. Replicas are laid out for all sequences up front,
+// and filled in incrementally, so that they can follow a store that is
+// still being loaded. Each costs as much memory as the original.
+class StoreReplicas {
+public:
+	StoreReplicas(const WorkerPlacement &placement, const std::vector<index_type> &lengths);
+
+	// Makes sequences [0, count) of the replica of 'node' a copy of those
+	// of 'source', where source[i] is a SeqView. Thread-safe.
+	template<typename Source>
+	void sync(std::size_t node, seq_count_type count, const Source &source)
+	{
+		Replica &replica = *replicas_[node];
+		std::lock_guard<std::mutex> lock(replica.mutex);
+
+		for (; replica.num_synced < count; replica.num_synced++) {
+			SeqView seq = source[replica.num_synced];
+			std::copy(seq.phi, seq.phi + seq.length, replica.store.phi(replica.num_synced));
+			std::copy(seq.psi, seq.psi + seq.length, replica.store.psi(replica.num_synced));
+		}
+	}
+
+	// The replica of 'node'; only the synced sequences hold angles
+	const SequenceStore &operator[](std::size_t node) const { return replicas_[node]->store; }
+
+private:
+	struct Replica {
+		SequenceStore store;
+		std::mutex mutex;
+		seq_count_type num_synced = 0;
+	};
+
+	std::vector<std::unique_ptr<Replica>> replicas_; // per node; null if it has no workers
+};
+
+#endif // SWPARA_NUMA_HH
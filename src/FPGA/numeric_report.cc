@@ -0,0 +1,280 @@
+//
+// numeric_report.cc
+//
+// Precision and throughput of the numeric variants of the kernel (see
+// numeric_variants() in engines.hh): scores the all-vs-all triangle of a
+// reproducible, fixed-seed dataset with every variant, and reports as JSON
+// how far the scores deviate from the int16/int32 baseline, how often the
+// best hit of a sequence changes, the C simulation throughput, and the
+// widths that the resources of the synthesized kernel scale with.
+// Build with `make numeric_report NDEBUG=1`, otherwise tracing dominates the timings.
+//
+// Created on 18/10/2026
+//
+
+#include <iostream>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+
+#include "align.hh"
+#include "engines.hh"
+#include "seq_store.hh"
+
+
+struct Options {
+	seq_count_type num_seqs = 48;
+	index_type max_len = MAX_SEQ_SIZE;
+	std::uint64_t seed = 0x5eed;
+	score_type scoring_offset = 65536;
+	score_type gap_penalty = -4000;
+	std::vector<const NumericVariant *> variants;
+};
+
+struct Result {
+	std::vector<score_type> scores; // upper triangle, row by row
+	double seconds;
+	std::uint64_t cells;
+};
+
+// Every other sequence is a noisy copy of an earlier one, so that there
+// are best hits to agree on. Only the raw output of mt19937_64 is used,
+// so the dataset is the same on every platform.
+static SequenceStore make_dataset(const Options &opts)
+{
+	std::mt19937_64 rng(opts.seed);
+	SequenceStore ds;
+
+	for (seq_count_type i = 0; i < opts.num_seqs; i++) {
+		std::vector<Dihedral> seq;
+
+		if (i > 0 && rng() % 2 == 0) {
+			SeqView orig = ds[rng() % i];
+
+			for (index_type k = 0; k < orig.length; k++) {
+				Dihedral d = orig[k];
+				d.phi = angle_type(std::uint16_t(d.phi + rng() % 2048 - 1024));
+				d.psi = angle_type(std::uint16_t(d.psi + rng() % 2048 - 1024));
+				seq.push_back(d);
+			}
+		} else {
+			seq.resize(1 + rng() % opts.max_len);
+
+			for (Dihedral &d : seq) {
+				d.phi = angle_type(std::uint16_t(rng()));
+				d.psi = angle_type(std::uint16_t(rng()));
+			}
+		}
+
+		ds.append(seq.data(), seq.size());
+	}
+
+	return ds;
+}
+
+static Result run_variant(const NumericVariant &variant, const SequenceStore &ds, const Options &opts)
+{
+	Result res {};
+	seq_count_type n = ds.size();
+
+	auto t_begin = std::chrono::steady_clock::now();
+
+	for (seq_count_type i = 0; i < n; i++) {
+		for (seq_count_type j = i + 1; j < n; j++) {
+			res.scores.push_back(variant.score_pair(ds[i], ds[j], opts.scoring_offset, opts.gap_penalty));
+			res.cells += std::uint64_t(ds[i].length) * ds[j].length;
+		}
+	}
+
+	res.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t_begin).count();
+
+	return res;
+}
+
+// Index of the best-scoring partner of every sequence; ties go to the first one
+static std::vector<seq_count_type> best_hits(const std::vector<score_type> &scores, seq_count_type n)
+{
+	std::vector<seq_count_type> best(n, 0);
+	std::vector<score_type> best_score(n, 0);
+	std::vector<bool> found(n, false);
+	std::size_t k = 0;
+
+	for (seq_count_type i = 0; i < n; i++) {
+		for (seq_count_type j = i + 1; j < n; j++, k++) {
+			for (seq_count_type a : { i, j }) {
+				seq_count_type b = a == i ? j : i;
+
+				if (!found[a] || scores[k] > best_score[a] || (scores[k] == best_score[a] && b < best[a])) {
+					best[a] = b;
+					best_score[a] = scores[k];
+					found[a] = true;
+				}
+			}
+		}
+	}
+
+	return best;
+}
+
+static void usage(const char *progname)
+{
+	std::cerr << "Usage: " << progname
+		<< " [--variant NAME]... [--count N] [--max-len N] [--seed N] [--offset N] [--penalty N]" << std::endl;
+	std::cerr << "Variants:";
+
+	for (const NumericVariant &variant : numeric_variants()) {
+		std::cerr << " " << variant.name;
+	}
+
+	std::cerr << std::endl;
+}
+
+static bool parse_options(int argc, char *argv[], Options &opts)
+{
+	for (int i = 1; i < argc; i += 2) {
+		if (i + 1 >= argc) {
+			return false;
+		}
+
+		const char *name = argv[i];
+		const char *value = argv[i + 1];
+
+		if (std::strcmp(name, "--variant") == 0) {
+			const NumericVariant *found = nullptr;
+
+			for (const NumericVariant &variant : numeric_variants()) {
+				if (std::strcmp(variant.name, value) == 0) {
+					found = &variant;
+				}
+			}
+
+			if (found == nullptr) {
+				std::cerr << "unknown variant '" << value << "'" << std::endl;
+				return false;
+			}
+
+			opts.variants.push_back(found);
+		} else if (std::strcmp(name, "--count") == 0) {
+			opts.num_seqs = std::strtoul(value, nullptr, 10);
+		} else if (std::strcmp(name, "--max-len") == 0) {
+			opts.max_len = std::strtol(value, nullptr, 10);
+		} else if (std::strcmp(name, "--seed") == 0) {
+			opts.seed = std::strtoull(value, nullptr, 0);
+		} else if (std::strcmp(name, "--offset") == 0) {
+			opts.scoring_offset = std::strtol(value, nullptr, 10);
+		} else if (std::strcmp(name, "--penalty") == 0) {
+			opts.gap_penalty = std::strtol(value, nullptr, 10);
+		} else {
+			return false;
+		}
+	}
+
+	if (opts.max_len < 1 || opts.max_len > MAX_SEQ_SIZE) {
+		std::cerr << "--max-len must be in [1, " << MAX_SEQ_SIZE << "]" << std::endl;
+		return false;
+	}
+
+	if (opts.variants.empty()) {
+		for (const NumericVariant &variant : numeric_variants()) {
+			opts.variants.push_back(&variant);
+		}
+	}
+
+	return true;
+}
+
+int main(int argc, char *argv[])
+{
+	Options opts;
+
+	if (!parse_options(argc, argv, opts)) {
+		usage(argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	SequenceStore ds = make_dataset(opts);
+	const NumericVariant &baseline_variant = numeric_variants().front();
+	Result baseline = run_variant(baseline_variant, ds, opts);
+	std::vector<seq_count_type> baseline_hits = best_hits(baseline.scores, ds.size());
+
+	std::printf(
+		"{\n  \"seed\": %llu,\n  \"num_seqs\": %lu,\n  \"scoring_offset\": %ld,\n  \"gap_penalty\": %ld,\n  \"baseline\": \"%s\",\n  \"variants\": [",
+		static_cast<unsigned long long>(opts.seed),
+		static_cast<unsigned long>(opts.num_seqs),
+		static_cast<long>(opts.scoring_offset),
+		static_cast<long>(opts.gap_penalty),
+		baseline_variant.name
+	);
+
+	const char *sep = "\n";
+
+	for (const NumericVariant *variant : opts.variants) {
+		Result res = variant == &baseline_variant ? baseline : run_variant(*variant, ds, opts);
+		std::vector<seq_count_type> hits = best_hits(res.scores, ds.size());
+
+		std::uint64_t differing_pairs = 0;
+		std::int64_t max_abs_dev = 0;
+		double sum_abs_dev = 0;
+		double max_rel_dev = 0;
+
+		for (std::size_t k = 0; k < res.scores.size(); k++) {
+			std::int64_t dev = std::int64_t(res.scores[k]) - baseline.scores[k];
+			std::int64_t abs_dev = dev < 0 ? -dev : dev;
+
+			differing_pairs += dev != 0;
+			max_abs_dev = std::max(max_abs_dev, abs_dev);
+			sum_abs_dev += abs_dev;
+
+			if (baseline.scores[k] > 0) {
+				max_rel_dev = std::max(max_rel_dev, double(abs_dev) / baseline.scores[k]);
+			}
+		}
+
+		std::size_t same_hits = 0;
+
+		for (std::size_t i = 0; i < hits.size(); i++) {
+			same_hits += hits[i] == baseline_hits[i];
+		}
+
+		// Each window keeps a column of WIN_ROWS cells for the next one
+		unsigned boundary_bits = BOUNDARY_DELTA_BITS > 0 ? BOUNDARY_DELTA_BITS : variant->cell_bits;
+		double gcups = res.seconds > 0 ? res.cells / res.seconds / 1e9 : 0;
+		double baseline_gcups = baseline.seconds > 0 ? baseline.cells / baseline.seconds / 1e9 : 0;
+
+		std::printf(
+			"%s    { \"name\": \"%s\", \"angle_format\": \"%s\", \"cell_format\": \"%s\","
+			" \"multiplier_bits\": %u, \"cell_bits\": %u, \"boundary_buffer_bits\": %u,"
+			" \"pairs\": %llu, \"differing_pairs\": %llu, \"max_abs_deviation\": %lld,"
+			" \"mean_abs_deviation\": %.3f, \"max_rel_deviation\": %.3g, \"best_hit_agreement\": %.4f,"
+			" \"seconds\": %.6f, \"gcups\": %.6f, \"relative_throughput\": %.3f }",
+			sep,
+			variant->name,
+			variant->angle_format,
+			variant->cell_format,
+			variant->multiplier_bits,
+			variant->cell_bits,
+			WIN_ROWS * boundary_bits,
+			static_cast<unsigned long long>(res.scores.size()),
+			static_cast<unsigned long long>(differing_pairs),
+			static_cast<long long>(max_abs_dev),
+			res.scores.empty() ? 0.0 : sum_abs_dev / res.scores.size(),
+			max_rel_dev,
+			hits.empty() ? 1.0 : double(same_hits) / hits.size(),
+			res.seconds,
+			gcups,
+			baseline_gcups > 0 ? gcups / baseline_gcups : 0
+		);
+		std::fflush(stdout);
+
+		sep = ",\n";
+	}
+
+	std::printf("\n  ]\n}\n");
+
+	return EXIT_SUCCESS;
+}
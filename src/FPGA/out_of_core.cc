@@ -0,0 +1,352 @@
+//
+// out_of_core.cc
+//
+// All-vs-all alignment of databases larger than the available memory
+//
+// Created on 18/10/2026
+//
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <exception>
+#include <algorithm>
+#include <cstdint>
+
+#include "out_of_core.hh"
+#include "engines.hh"
+#include "profile.hh"
+
+
+// Rows [begin, end) are a row block, where 'end' <= 'limit'.
+// Every row block has at least one row, and 'num_settings' scores per pair.
+static seq_count_type row_block_end(
+	const std::vector<index_type> &lengths,
+	seq_count_type begin,
+	seq_count_type limit,
+	std::size_t num_settings,
+	std::size_t budget
+)
+{
+	seq_count_type num_seqs = lengths.size();
+	seq_count_type end = begin;
+	std::size_t size = 0;
+
+	while (end < limit) {
+		std::size_t row_size = SequenceStore::bytes_for(lengths[end]) + (num_seqs - 1 - end) * num_settings * sizeof(score_type);
+
+		if (end > begin && size + row_size > budget) {
+			break;
+		}
+
+		size += row_size;
+		end++;
+	}
+
+	return end;
+}
+
+// Columns [begin, end) are a column block. Every column block has at least one column.
+static seq_count_type col_block_end(const std::vector<index_type> &lengths, seq_count_type begin, std::size_t budget)
+{
+	seq_count_type num_seqs = lengths.size();
+	seq_count_type end = begin;
+	std::size_t size = 0;
+
+	while (end < num_seqs) {
+		std::size_t col_size = SequenceStore::bytes_for(lengths[end]);
+
+		if (end > begin && size + col_size > budget) {
+			break;
+		}
+
+		size += col_size;
+		end++;
+	}
+
+	return end;
+}
+
+// Threads that run batches of independent items, the calling thread being
+// one of them. They are started once, since a small memory budget makes for
+// many small tiles.
+class WorkerPool {
+public:
+	explicit WorkerPool(unsigned num_threads) : next_(0)
+	{
+		for (unsigned t = 1; t < num_threads; t++) {
+			threads_.emplace_back([this]() { thread_main(); });
+		}
+	}
+
+	~WorkerPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			stop_ = true;
+		}
+
+		start_.notify_all();
+
+		for (std::thread &thread : threads_) {
+			thread.join();
+		}
+	}
+
+	unsigned size() const { return threads_.size() + 1; }
+
+	// Runs fn(0), ..., fn(count - 1) in any order, and waits for them.
+	// Rethrows the first exception of 'fn'; the items not yet started then aren't.
+	void run(std::size_t count, const std::function<void(std::size_t)> &fn)
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			fn_ = &fn;
+			count_ = count;
+			next_.store(0);
+			busy_ = threads_.size();
+			batch_++;
+		}
+
+		start_.notify_all();
+		claim_items();
+
+		std::unique_lock<std::mutex> lock(mutex_);
+		done_.wait(lock, [&]() { return busy_ == 0; });
+
+		std::exception_ptr error = error_;
+		error_ = nullptr;
+
+		if (error) {
+			std::rethrow_exception(error);
+		}
+	}
+
+private:
+	void thread_main()
+	{
+		std::uint64_t batch = 0;
+		std::unique_lock<std::mutex> lock(mutex_);
+
+		for (;;) {
+			start_.wait(lock, [&]() { return stop_ || batch_ != batch; });
+
+			if (stop_) {
+				return;
+			}
+
+			batch = batch_;
+
+			lock.unlock();
+			claim_items();
+			lock.lock();
+
+			if (--busy_ == 0) {
+				done_.notify_one();
+			}
+		}
+	}
+
+	void claim_items()
+	{
+		for (std::size_t k; (k = next_.fetch_add(1)) < count_; ) {
+			try {
+				(*fn_)(k);
+			} catch (...) {
+				std::lock_guard<std::mutex> lock(mutex_);
+
+				if (!error_) {
+					error_ = std::current_exception();
+				}
+
+				next_.store(count_);
+			}
+		}
+	}
+
+	std::vector<std::thread> threads_;
+	std::mutex mutex_;
+	std::condition_variable start_;
+	std::condition_variable done_;
+	const std::function<void(std::size_t)> *fn_ = nullptr; // of the current batch
+	std::size_t count_ = 0;
+	std::atomic<std::size_t> next_;                        // item to claim
+	unsigned busy_ = 0;                                    // threads still at the current batch
+	std::uint64_t batch_ = 0;
+	bool stop_ = false;
+	std::exception_ptr error_;
+};
+
+// 'align_row(seq_ver, seqs_hor, first_hor, last_hor, out)' scores one
+// vertical sequence against a slice of a column block under every
+// setting, out[k] being where the scores of setting #k go. It's called
+// from 'num_threads' threads at once, for different parts of the tile.
+template<typename AlignRow>
+static void align_blocks(
+	SeqFile &seqs,
+	std::size_t memory_budget,
+	RowRange rows,
+	const std::vector<RowWriter *> &writers,
+	unsigned num_threads,
+	AlignRow align_row
+)
+{
+	const std::vector<index_type> &lengths = seqs.lengths();
+	const seq_count_type num_seqs = seqs.size();
+	const std::size_t block_budget = memory_budget / 2;
+
+	const std::size_t num_settings = writers.size();
+
+	SequenceStore rows_buf;
+	SequenceStore cols_buf;
+	std::vector<std::vector<score_type>> scores(num_settings);
+	std::vector<std::size_t> row_offsets;
+	WorkerPool pool(num_threads);
+
+	// rows may be handed over by every thread only if every writer takes them so
+	bool concurrent_writers = std::all_of(writers.begin(), writers.end(), [](const RowWriter *writer) { return writer->concurrent(); });
+
+	std::size_t num_row_blocks = 0;
+	std::size_t num_tiles = 0;
+	std::size_t peak_size = 0;
+
+	rows.end = std::min(rows.end, num_seqs > 0 ? num_seqs - 1 : 0);
+
+	for (seq_count_type row_begin = rows.begin; row_begin < rows.end; ) {
+		seq_count_type row_end = row_block_end(lengths, row_begin, rows.end, num_settings, block_budget);
+
+		{
+			PhaseTimer timer(PHASE_PARSE, seqs.total_length(row_begin, row_end));
+			seqs.read(row_begin, row_end, rows_buf);
+		}
+
+		// Scores of row #i under setting #k start at scores[k][row_offsets[i - row_begin]]
+		row_offsets.assign(1, 0);
+
+		for (seq_count_type i = row_begin; i < row_end; i++) {
+			row_offsets.push_back(row_offsets.back() + (num_seqs - 1 - i));
+		}
+
+		for (std::vector<score_type> &setting_scores : scores) {
+			setting_scores.resize(row_offsets.back());
+		}
+
+		// Stream horizontal sequences through the row block
+		for (seq_count_type col_begin = row_begin + 1; col_begin < num_seqs; ) {
+			seq_count_type col_end = col_block_end(lengths, col_begin, block_budget);
+
+			{
+				PhaseTimer timer(PHASE_PARSE, seqs.total_length(col_begin, col_end));
+				seqs.read(col_begin, col_end, cols_buf);
+			}
+
+			// Every row of the block against a slice of the tile, so that there
+			// is work for every thread even in blocks of a few rows
+			const seq_count_type num_slices = pool.size();
+
+			pool.run(std::size_t(row_end - row_begin) * num_slices, [&](std::size_t item) {
+				seq_count_type i = row_begin + item / num_slices;
+				seq_count_type slice = item % num_slices;
+				seq_count_type width = col_end - col_begin;
+				seq_count_type first_hor = std::max<seq_count_type>(col_begin + std::uint64_t(width) * slice / num_slices, i + 1);
+				seq_count_type last_hor = col_begin + std::uint64_t(width) * (slice + 1) / num_slices;
+
+				if (first_hor >= last_hor) {
+					return;
+				}
+
+				std::vector<score_type *> out(num_settings);
+
+				for (std::size_t k = 0; k < num_settings; k++) {
+					out[k] = &scores[k][row_offsets[i - row_begin] + (first_hor - (i + 1))];
+				}
+
+				align_row(rows_buf[i - row_begin], cols_buf, first_hor - col_begin, last_hor - col_begin, out.data());
+			});
+
+			peak_size = std::max(
+				peak_size,
+				rows_buf.memory_size() + cols_buf.memory_size() + num_settings * row_offsets.back() * sizeof(score_type)
+			);
+
+			num_tiles++;
+			col_begin = col_end;
+		}
+
+		{
+			PhaseTimer timer(PHASE_FORMAT, num_settings * row_offsets.back());
+			const seq_count_type num_block_rows = row_end - row_begin;
+
+			auto write_row = [&](std::size_t item) {
+				std::size_t k = item / num_block_rows;
+				seq_count_type i = row_begin + item % num_block_rows;
+
+				writers[k]->write_row(i, &scores[k][row_offsets[i - row_begin]], num_seqs - 1 - i);
+			};
+
+			if (concurrent_writers) {
+				pool.run(num_settings * num_block_rows, write_row);
+			} else {
+				for (std::size_t item = 0; item < num_settings * num_block_rows; item++) {
+					write_row(item);
+				}
+			}
+		}
+
+		num_row_blocks++;
+		row_begin = row_end;
+	}
+
+	{
+		PhaseTimer timer(PHASE_FORMAT);
+
+		for (RowWriter *writer : writers) {
+			writer->finish();
+		}
+	}
+
+	std::fprintf(
+		stderr,
+		"Row blocks: %zu\nTiles: %zu\nPeak block memory: %zu bytes (budget: %zu bytes)\n",
+		num_row_blocks,
+		num_tiles,
+		peak_size,
+		memory_budget
+	);
+}
+
+void align_out_of_core(
+	SeqFile &seqs,
+	std::size_t memory_budget,
+	score_type scoring_offset,
+	score_type gap_penalty,
+	RowRange rows,
+	RowWriter &writer,
+	unsigned num_threads
+)
+{
+	auto align_row = [=](SeqView seq_ver, const SequenceStore &seqs_hor, seq_count_type first_hor, seq_count_type last_hor, score_type *const *out) {
+		csim_align_row(seq_ver, seqs_hor, first_hor, last_hor, scoring_offset, gap_penalty, out[0]);
+	};
+
+	align_blocks(seqs, memory_budget, rows, { &writer }, num_threads, align_row);
+}
+
+void align_out_of_core(
+	SeqFile &seqs,
+	std::size_t memory_budget,
+	const std::vector<ScoringParams> &settings,
+	RowRange rows,
+	const std::vector<RowWriter *> &writers,
+	unsigned num_threads
+)
+{
+	auto align_row = [&](SeqView seq_ver, const SequenceStore &seqs_hor, seq_count_type first_hor, seq_count_type last_hor, score_type *const *out) {
+		sweep_align_row(seq_ver, seqs_hor, first_hor, last_hor, settings, out);
+	};
+
+	align_blocks(seqs, memory_budget, rows, writers, num_threads, align_row);
+}
@@ -0,0 +1,51 @@
+//
+// out_of_core.hh
+//
+// All-vs-all alignment of databases larger than the available memory
+//
+// Created on 18/10/2026
+//
+
+#ifndef SWPARA_OUT_OF_CORE_HH
+#define SWPARA_OUT_OF_CORE_HH
+
+#include <vector>
+#include <cstddef>
+
+#include "align.hh"
+#include "seq_file.hh"
+#include "triangle.hh"
+#include "sweep.hh"
+
+
+// The triangle is computed one block of rows at a time. A row block
+// holds the data of its vertical sequences and the scores of its rows;
+// the horizontal sequences are streamed through it in column blocks.
+// Each of these two kinds of block gets half of 'memory_budget' bytes.
+// Only rows in 'rows' are computed (the whole triangle is [0, n - 1)).
+// Every tile is computed by 'num_threads' threads. Finished rows are
+// handed to 'writer' after each row block: in order, or by all threads at
+// once if the writer is concurrent() (see RowWriter in seq_file.hh).
+void align_out_of_core(
+	SeqFile &seqs,
+	std::size_t memory_budget,
+	score_type scoring_offset,
+	score_type gap_penalty,
+	RowRange rows,
+	RowWriter &writer,
+	unsigned num_threads
+);
+
+// The same for every setting in one pass: each row block and column block
+// is read once, and the sweep engine scores every pair under all settings
+// at the same time. Rows of settings[k] are handed to *writers[k].
+void align_out_of_core(
+	SeqFile &seqs,
+	std::size_t memory_budget,
+	const std::vector<ScoringParams> &settings,
+	RowRange rows,
+	const std::vector<RowWriter *> &writers,
+	unsigned num_threads
+);
+
+#endif // SWPARA_OUT_OF_CORE_HH
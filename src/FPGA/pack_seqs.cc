@@ -0,0 +1,50 @@
+//
+// pack_seqs.cc
+//
+// Converts a binary INPUT.BIN into a compressed sequence archive
+// (see seq_archive.hh), which `align --input` and the board read as well.
+//
+// Created on 18/10/2026
+//
+
+#include <stdexcept>
+#include <cstdio>
+#include <cstdlib>
+
+#include "align.hh"
+#include "seq_file.hh"
+#include "seq_archive.hh"
+
+
+// Sequence data read from the input at a time
+static const std::size_t memory_budget = 64 << 20;
+
+int main(int argc, char *argv[])
+{
+	if (argc != 3) {
+		std::fprintf(stderr, "usage: %s INPUT.BIN ARCHIVE\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	try {
+		SeqFile seqs(argv[1]);
+		std::uint64_t num_residues = seqs.total_length(0, seqs.size());
+		std::uint64_t raw_size = sizeof(seq_count_type) + seqs.size() * sizeof(index_type) + num_residues * sizeof(Dihedral);
+		std::uint64_t archive_size = write_seq_archive(seqs, argv[2], memory_budget);
+
+		std::fprintf(
+			stderr,
+			"%lu sequences, %llu residues: %llu bytes raw, %llu bytes archived (%.1lf%%)\n",
+			static_cast<unsigned long>(seqs.size()),
+			static_cast<unsigned long long>(num_residues),
+			static_cast<unsigned long long>(raw_size),
+			static_cast<unsigned long long>(archive_size),
+			raw_size > 0 ? 100.0 * archive_size / raw_size : 0.0
+		);
+	} catch (const std::exception &ex) {
+		std::fprintf(stderr, "error: %s\n", ex.what());
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,269 @@
+//
+// pipeline.cc
+//
+// All-vs-all alignment of a text database, with parsing,
+// alignment and output running concurrently
+//
+// Created on 18/10/2026
+//
+
+#include <vector>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <chrono>
+#include <algorithm>
+#include <stdexcept>
+#include <cstdio>
+
+#include "pipeline.hh"
+#include "bounded_queue.hh"
+#include "engines.hh"
+#include "numa.hh"
+#include "profile.hh"
+#include "seq_store.hh"
+#include "text_input.hh"
+
+
+// Compute workers align a row this many columns at a time,
+// so that they can start before all of its sequences are parsed
+static const seq_count_type column_chunk = 64;
+
+struct FinishedRow {
+	seq_count_type row;
+	std::vector<score_type> scores;
+};
+
+std::uint64_t align_pipelined(
+	const TextInput &input,
+	score_type scoring_offset,
+	score_type gap_penalty,
+	unsigned num_threads,
+	RowWriter &writer,
+	std::size_t max_rows_in_flight
+)
+{
+	auto t_begin = std::chrono::steady_clock::now();
+
+	std::vector<index_type> lengths;
+	std::size_t data_offset = 0;
+
+	{
+		PhaseTimer timer(PHASE_PARSE);
+		lengths = parse_text_header(input.data(), input.size(), data_offset);
+	}
+
+	const seq_count_type num_seqs = lengths.size();
+	const seq_count_type num_rows = num_seqs > 0 ? num_seqs - 1 : 0;
+
+	// Every sequence is laid out (zero-filled) in advance, so the store doesn't
+	// change shape while the workers read it; the parser only fills in angles.
+	SequenceStore seqs;
+	std::uint64_t total_length = 0;
+	std::uint64_t num_cells = 0;
+
+	for (index_type length : lengths) {
+		total_length += length;
+	}
+
+	seqs.reserve(num_seqs, total_length);
+
+	for (seq_count_type i = 0; i < num_seqs; i++) {
+		angle_type *phi, *psi;
+		seqs.append(lengths[i], phi, psi);
+
+		// sequence #i against every later one
+		total_length -= lengths[i];
+		num_cells += lengths[i] * total_length;
+	}
+
+	// A quarter of the threads parse, the rest compute. Parsing takes a
+	// small fraction of the time, so the parser thread computes as well
+	// (as the last worker) once it's done; with a single thread, it parses
+	// everything first.
+	const unsigned num_parsers = std::max(num_threads / 4, 1u);
+	const unsigned num_workers = std::max(num_threads, num_parsers) - num_parsers;
+
+	// On NUMA hosts, the workers of every node read a replica in local
+	// memory, which follows the parser a column chunk at a time
+	WorkerPlacement placement = place_workers(num_workers + 1);
+	std::unique_ptr<StoreReplicas> replicas;
+
+	if (placement.is_numa()) {
+		replicas.reset(new StoreReplicas(placement, lengths));
+	}
+
+	std::size_t window = 1;
+
+	while (window < std::max<std::size_t>(max_rows_in_flight, 1)) {
+		window *= 2;
+	}
+
+	BoundedQueue<FinishedRow> finished(window);
+
+	std::atomic<seq_count_type> num_parsed(0);   // sequences [0, num_parsed) are complete
+	std::atomic<seq_count_type> next_row(0);     // next row to be claimed by a worker
+	std::atomic<seq_count_type> num_written(0);  // rows [0, num_written) are written
+	std::atomic<seq_count_type> num_finished(0); // rows pushed to 'finished'
+	std::atomic<bool> failed(false);
+	std::string parse_error;
+
+	// Threads that wait for one of the counters above (or for a failure)
+	// block on its condition variable. Counters change under 'state_mutex',
+	// so that no wakeup is lost, but may be read without it.
+	std::mutex state_mutex;
+	std::condition_variable parsed_cv, written_cv, finished_cv;
+
+	auto signal = [&](std::condition_variable &cv, const std::function<void()> &change) {
+		{
+			std::lock_guard<std::mutex> lock(state_mutex);
+			change();
+		}
+
+		cv.notify_all();
+	};
+
+	auto fail = [&]() {
+		signal(parsed_cv, [&]() { failed.store(true); });
+		written_cv.notify_all();
+		finished_cv.notify_all();
+	};
+
+	// false if the run failed meanwhile
+	auto wait_for = [&](std::condition_variable &cv, const std::function<bool()> &done) {
+		if (!done()) {
+			std::unique_lock<std::mutex> lock(state_mutex);
+			cv.wait(lock, [&]() { return done() || failed.load(); });
+		}
+
+		return !failed.load();
+	};
+
+	auto wait_parsed = [&](seq_count_type count) {
+		return wait_for(parsed_cv, [&]() { return num_parsed.load(std::memory_order_acquire) >= count; });
+	};
+
+	auto worker = [&](unsigned index) {
+		std::size_t node = placement.node_of(index);
+		const SequenceStore &store = replicas ? (*replicas)[node] : seqs;
+
+		pin_to_node(placement, node);
+
+		for (;;) {
+			seq_count_type row = next_row.fetch_add(1);
+
+			if (row >= num_rows) {
+				return;
+			}
+
+			// don't run ahead of the writer by more than the queue can hold
+			if (!wait_for(written_cv, [&]() { return row < num_written.load(std::memory_order_acquire) + window; })) {
+				return;
+			}
+
+			FinishedRow result { row, std::vector<score_type>(num_seqs - 1 - row) };
+
+			for (seq_count_type first = row + 1; first < num_seqs; ) {
+				seq_count_type last = std::min(first + column_chunk, num_seqs);
+
+				if (!wait_parsed(last)) {
+					return;
+				}
+
+				if (replicas) {
+					replicas->sync(node, last, seqs);
+				}
+
+				csim_align_row(store[row], store, first, last, scoring_offset, gap_penalty, &result.scores[first - row - 1]);
+				first = last;
+			}
+
+			// never full: at most 'window' rows are in flight
+			finished.push(std::move(result));
+			signal(finished_cv, [&]() { num_finished++; });
+		}
+	};
+
+	auto parser = [&]() {
+		try {
+			PhaseTimer timer(PHASE_PARSE, seqs.total_length(0, num_seqs));
+
+			parse_text_angles(input.data(), data_offset, input.size(), seqs, num_parsers, [&](seq_count_type count) {
+				signal(parsed_cv, [&]() { num_parsed.store(count, std::memory_order_release); });
+			});
+		} catch (const std::exception &ex) {
+			parse_error = ex.what();
+			fail();
+			return;
+		}
+
+		worker(num_workers);
+	};
+
+	std::vector<std::thread> threads;
+	threads.emplace_back(parser);
+
+	for (unsigned t = 0; t < num_workers; t++) {
+		threads.emplace_back(worker, t);
+	}
+
+	auto join_all = [&]() {
+		for (std::thread &thread : threads) {
+			thread.join();
+		}
+	};
+
+	// Output stage: rows arrive in any order, and are written in order
+	std::map<seq_count_type, std::vector<score_type>> pending;
+
+	try {
+		for (seq_count_type written = 0, popped = 0; written < num_rows; popped++) {
+			FinishedRow result;
+
+			if (!wait_for(finished_cv, [&]() { return num_finished.load() > popped; })) {
+				break;
+			}
+
+			// the only consumer: a row that's counted has been pushed
+			finished.try_pop(result);
+			pending.emplace(result.row, std::move(result.scores));
+
+			while (!pending.empty() && pending.begin()->first == written) {
+				{
+					PhaseTimer timer(PHASE_FORMAT, pending.begin()->second.size());
+					writer.write_row(written, pending.begin()->second.data(), pending.begin()->second.size());
+				}
+
+				pending.erase(pending.begin());
+				++written;
+				signal(written_cv, [&]() { num_written.store(written, std::memory_order_release); });
+
+				auto t_now = std::chrono::steady_clock::now();
+				std::fprintf(stderr, "%lg... ", std::chrono::duration<double>(t_now - t_begin).count());
+				std::fflush(stderr);
+			}
+		}
+	} catch (...) {
+		fail();
+		join_all();
+		throw;
+	}
+
+	join_all();
+
+	if (failed.load()) {
+		throw std::runtime_error(parse_error);
+	}
+
+	{
+		PhaseTimer timer(PHASE_FORMAT);
+		writer.finish();
+	}
+
+	return num_cells;
+}
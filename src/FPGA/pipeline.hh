@@ -0,0 +1,47 @@
+//
+// pipeline.hh
+//
+// All-vs-all alignment of a text database, with parsing,
+// alignment and output running concurrently
+//
+// Created on 18/10/2026
+//
+
+#ifndef SWPARA_PIPELINE_HH
+#define SWPARA_PIPELINE_HH
+
+#include <cstdint>
+
+#include "align.hh"
+#include "seq_file.hh"
+#include "text_input.hh"
+
+
+// Parses the text input (see parse_text_header()), and hands the rows
+// of the triangle to 'writer' in order. Three kinds of stage run at
+// the same time, on 'num_threads' threads besides the calling one:
+//
+//  - a parser thread fills in the sequence data, with the help of a
+//    quarter of the threads, and publishes how many sequences are
+//    complete; then it becomes a compute thread itself;
+//  - the other threads compute: they claim rows in order, and run align()
+//    on every slice of columns as soon as those sequences are parsed;
+//    on NUMA hosts they are pinned to nodes, and read a replica of the
+//    sequences in the memory of their own node (see numa.hh);
+//  - the calling thread drains finished rows from a bounded lock-free
+//    queue, restores their order and writes them.
+//
+// Threads that wait for another stage block on a condition variable.
+// At most 'max_rows_in_flight' (rounded up to a power of two) rows are
+// claimed but not yet written. Throws if the input is malformed.
+// Returns the number of dynamic programming cells computed.
+std::uint64_t align_pipelined(
+	const TextInput &input,
+	score_type scoring_offset,
+	score_type gap_penalty,
+	unsigned num_threads,
+	RowWriter &writer,
+	std::size_t max_rows_in_flight = 64
+);
+
+#endif // SWPARA_PIPELINE_HH
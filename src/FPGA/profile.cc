@@ -0,0 +1,188 @@
+//
+// profile.cc
+//
+// Lightweight instrumentation of the host-side hot path
+//
+// Created on 18/10/2026
+//
+
+#include <vector>
+#include <utility>
+#include <atomic>
+#include <limits>
+#include <algorithm>
+
+#include "profile.hh"
+
+
+struct PhaseInfo {
+	const char *name;
+	const char *unit; // what the item counter counts
+};
+
+static const PhaseInfo phase_info[NUM_PHASES] = {
+	{ "parse",   "dihedrals" },
+	{ "compute", "cells"     },
+	{ "format",  "scores"    },
+};
+
+static const std::uint64_t no_begin = std::numeric_limits<std::uint64_t>::max();
+
+// Times are in nanoseconds of the steady clock; the span of a phase
+// is [first_begin, last_end), and empty while first_begin > last_end.
+struct PhaseCounters {
+	constexpr PhaseCounters() : nanoseconds(0), first_begin(no_begin), last_end(0), calls(0), items(0) {}
+
+	std::atomic<std::uint64_t> nanoseconds;
+	std::atomic<std::uint64_t> first_begin;
+	std::atomic<std::uint64_t> last_end;
+	std::atomic<std::uint64_t> calls;
+	std::atomic<std::uint64_t> items;
+};
+
+static PhaseCounters counters[NUM_PHASES];
+
+static std::uint64_t to_nanoseconds(std::chrono::steady_clock::time_point t)
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(t.time_since_epoch()).count();
+}
+
+PhaseStats phase_stats(Phase phase)
+{
+	const PhaseCounters &c = counters[phase];
+	std::uint64_t first_begin = c.first_begin.load(std::memory_order_relaxed);
+	std::uint64_t last_end = c.last_end.load(std::memory_order_relaxed);
+
+	return {
+		c.nanoseconds.load(std::memory_order_relaxed) * 1e-9,
+		first_begin < last_end ? (last_end - first_begin) * 1e-9 : 0,
+		c.calls.load(std::memory_order_relaxed),
+		c.items.load(std::memory_order_relaxed),
+	};
+}
+
+void profile_add(
+	Phase phase,
+	std::chrono::steady_clock::time_point begin,
+	std::chrono::steady_clock::time_point end,
+	std::uint64_t items
+)
+{
+	PhaseCounters &c = counters[phase];
+	std::uint64_t begin_ns = to_nanoseconds(begin);
+	std::uint64_t end_ns = to_nanoseconds(end);
+	std::uint64_t first_begin = c.first_begin.load(std::memory_order_relaxed);
+	std::uint64_t last_end = c.last_end.load(std::memory_order_relaxed);
+
+	while (begin_ns < first_begin && !c.first_begin.compare_exchange_weak(first_begin, begin_ns, std::memory_order_relaxed)) {}
+	while (end_ns > last_end && !c.last_end.compare_exchange_weak(last_end, end_ns, std::memory_order_relaxed)) {}
+
+	c.nanoseconds.fetch_add(end_ns - begin_ns, std::memory_order_relaxed);
+	c.calls.fetch_add(1, std::memory_order_relaxed);
+	c.items.fetch_add(items, std::memory_order_relaxed);
+}
+
+void profile_reset()
+{
+	for (PhaseCounters &c : counters) {
+		c.nanoseconds.store(0, std::memory_order_relaxed);
+		c.first_begin.store(no_begin, std::memory_order_relaxed);
+		c.last_end.store(0, std::memory_order_relaxed);
+		c.calls.store(0, std::memory_order_relaxed);
+		c.items.store(0, std::memory_order_relaxed);
+	}
+}
+
+// Wall time outside of the spans of every phase (which may overlap)
+static double other_seconds(double wall_seconds)
+{
+	std::vector<std::pair<std::uint64_t, std::uint64_t>> spans;
+	std::uint64_t covered = 0, covered_end = 0;
+
+	for (const PhaseCounters &c : counters) {
+		std::uint64_t first_begin = c.first_begin.load(std::memory_order_relaxed);
+		std::uint64_t last_end = c.last_end.load(std::memory_order_relaxed);
+
+		if (first_begin < last_end) {
+			spans.emplace_back(first_begin, last_end);
+		}
+	}
+
+	std::sort(spans.begin(), spans.end());
+
+	for (const std::pair<std::uint64_t, std::uint64_t> &span : spans) {
+		std::uint64_t begin = std::max(span.first, covered_end);
+
+		if (span.second > begin) {
+			covered += span.second - begin;
+			covered_end = span.second;
+		}
+	}
+
+	return std::max(wall_seconds - covered * 1e-9, 0.0);
+}
+
+static double percent_of(double seconds, double wall_seconds)
+{
+	return wall_seconds > 0 ? 100 * seconds / wall_seconds : 0;
+}
+
+void profile_print_table(std::FILE *file, double wall_seconds)
+{
+	std::fprintf(
+		file,
+		"\n%-8s %12s %12s %7s %12s %14s %-10s %14s\n",
+		"phase", "thread-s", "span-s", "%", "calls", "items", "unit", "items/s"
+	);
+
+	for (int p = 0; p < NUM_PHASES; p++) {
+		PhaseStats stats = phase_stats(Phase(p));
+		double rate = stats.seconds > 0 ? stats.items / stats.seconds : 0;
+
+		std::fprintf(
+			file,
+			"%-8s %12.6f %12.6f %6.2f%% %12llu %14llu %-10s %14.4g\n",
+			phase_info[p].name,
+			stats.seconds,
+			stats.span_seconds,
+			percent_of(stats.span_seconds, wall_seconds),
+			static_cast<unsigned long long>(stats.calls),
+			static_cast<unsigned long long>(stats.items),
+			phase_info[p].unit,
+			rate
+		);
+	}
+
+	double other = other_seconds(wall_seconds);
+
+	std::fprintf(file, "%-8s %12s %12.6f %6.2f%%\n", "other", "", other, percent_of(other, wall_seconds));
+	std::fprintf(file, "%-8s %12s %12.6f\n\n", "total", "", wall_seconds);
+}
+
+void profile_print_json(std::FILE *file, double wall_seconds)
+{
+	std::fprintf(
+		file,
+		"{\"wall_seconds\": %.9f, \"other_seconds\": %.9f, \"phases\": {",
+		wall_seconds,
+		other_seconds(wall_seconds)
+	);
+
+	for (int p = 0; p < NUM_PHASES; p++) {
+		PhaseStats stats = phase_stats(Phase(p));
+
+		std::fprintf(
+			file,
+			"%s\"%s\": {\"seconds\": %.9f, \"span_seconds\": %.9f, \"calls\": %llu, \"items\": %llu, \"unit\": \"%s\"}",
+			p > 0 ? ", " : "",
+			phase_info[p].name,
+			stats.seconds,
+			stats.span_seconds,
+			static_cast<unsigned long long>(stats.calls),
+			static_cast<unsigned long long>(stats.items),
+			phase_info[p].unit
+		);
+	}
+
+	std::fprintf(file, "}}\n");
+}
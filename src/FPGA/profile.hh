@@ -0,0 +1,80 @@
+//
+// profile.hh
+//
+// Lightweight instrumentation of the host-side hot path:
+// scoped per-phase timers and item counters, reported at the end of a run
+//
+// Created on 18/10/2026
+//
+
+#ifndef SWPARA_PROFILE_HH
+#define SWPARA_PROFILE_HH
+
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+
+
+enum Phase {
+	PHASE_PARSE,   // reading sequences (text or binary)
+	PHASE_COMPUTE, // align() itself
+	PHASE_FORMAT,  // writing scores to the output
+	NUM_PHASES
+};
+
+// Timers of a phase may run on several threads at once, and phases may
+// overlap each other: 'seconds' adds up the time of every timer (i.e. it is
+// in thread-seconds), while 'span_seconds' is the wall-clock time from the
+// start of the first timer to the end of the last one.
+struct PhaseStats {
+	double seconds;
+	double span_seconds;
+	std::uint64_t calls;
+	std::uint64_t items;
+};
+
+// Totals are accumulated atomically, so timers may run on any thread
+PhaseStats phase_stats(Phase phase);
+
+void profile_add(
+	Phase phase,
+	std::chrono::steady_clock::time_point begin,
+	std::chrono::steady_clock::time_point end,
+	std::uint64_t items
+);
+
+void profile_reset();
+
+// Human-readable breakdown; percentages are the spans relative to
+// 'wall_seconds', and "other" is the wall time outside of every span
+void profile_print_table(std::FILE *file, double wall_seconds);
+
+// The same numbers as a single JSON object
+void profile_print_json(std::FILE *file, double wall_seconds);
+
+// Adds the lifetime of the object to 'phase'
+class PhaseTimer {
+public:
+	explicit PhaseTimer(Phase phase, std::uint64_t items = 0) :
+		phase_(phase),
+		items_(items),
+		begin_(std::chrono::steady_clock::now())
+	{}
+
+	~PhaseTimer()
+	{
+		profile_add(phase_, begin_, std::chrono::steady_clock::now(), items_);
+	}
+
+	PhaseTimer(const PhaseTimer &) = delete;
+	PhaseTimer &operator=(const PhaseTimer &) = delete;
+
+	void add_items(std::uint64_t items) { items_ += items; }
+
+private:
+	Phase phase_;
+	std::uint64_t items_;
+	std::chrono::steady_clock::time_point begin_;
+};
+
+#endif // SWPARA_PROFILE_HH
@@ -0,0 +1,53 @@
+//
+// reference.cc
+//
+// Straightforward full-matrix Smith-Waterman scorer
+//
+// Created on 18/10/2026
+//
+
+#include "reference.hh"
+
+
+static std::int64_t angle_distance(angle_type a, angle_type b)
+{
+	std::int64_t d = std::int64_t(a) - std::int64_t(b);
+	d = d < 0 ? -d : d;
+	return std::min(d, 65536 - d);
+}
+
+score_type reference_dihedral_score(Dihedral d1, Dihedral d2, score_type scoring_offset)
+{
+	std::int64_t dphi = angle_distance(d1.phi, d2.phi);
+	std::int64_t dpsi = angle_distance(d1.psi, d2.psi);
+
+	return reference_wrap(scoring_offset - reference_wrap(dphi * dphi + dpsi * dpsi));
+}
+
+score_type reference_score(
+	SeqView seq_ver,
+	SeqView seq_hor,
+	score_type scoring_offset,
+	score_type gap_penalty
+)
+{
+	return reference_matrix_score(seq_ver, seq_hor, gap_penalty, [=](Dihedral d1, Dihedral d2) {
+		return reference_dihedral_score(d1, d2, scoring_offset);
+	});
+}
+
+score_type reference_banded_score(
+	SeqView seq_ver,
+	SeqView seq_hor,
+	score_type scoring_offset,
+	score_type gap_penalty,
+	index_type band_width,
+	bool *touched_edge
+)
+{
+	auto score = [=](Dihedral d1, Dihedral d2) {
+		return reference_dihedral_score(d1, d2, scoring_offset);
+	};
+
+	return reference_matrix_score(seq_ver, seq_hor, gap_penalty, score, band_width, touched_edge);
+}
@@ -0,0 +1,138 @@
+//
+// reference.hh
+//
+// Straightforward full-matrix Smith-Waterman scorer,
+// used as the oracle for differential testing
+//
+// Created on 18/10/2026
+//
+
+#ifndef SWPARA_REFERENCE_HH
+#define SWPARA_REFERENCE_HH
+
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+
+#include "align.hh"
+#include "seq_store.hh"
+
+
+// Score of two residues: the offset minus the squared distance of the
+// dihedral angles, where each angle difference wraps around a full turn
+// (65536 units), exactly like dihedral_score() in the kernel.
+score_type reference_dihedral_score(Dihedral d1, Dihedral d2, score_type scoring_offset);
+
+// Maximum of the full (len_ver + 1) x (len_hor + 1) Smith-Waterman matrix
+score_type reference_score(
+	SeqView seq_ver,
+	SeqView seq_hor,
+	score_type scoring_offset,
+	score_type gap_penalty
+);
+
+// The kernel computes in score_type, so overflow must wrap the same way
+inline score_type reference_wrap(std::int64_t x)
+{
+	return static_cast<score_type>(static_cast<std::uint32_t>(x));
+}
+
+// Score of reference_score() within a band (see FULL_BAND in align.hh),
+// and whether its best cell lies on the edge of the band
+score_type reference_banded_score(
+	SeqView seq_ver,
+	SeqView seq_hor,
+	score_type scoring_offset,
+	score_type gap_penalty,
+	index_type band_width,
+	bool *touched_edge
+);
+
+// Maximum of the full Smith-Waterman matrix, with 'score(d1, d2)'
+// being the substitution score of two residues. With band_width >= 0,
+// cells more than band_width off the main diagonal are zero.
+template<typename ScoreFn>
+score_type reference_matrix_score(
+	SeqView seq_ver,
+	SeqView seq_hor,
+	score_type gap_penalty,
+	ScoreFn score,
+	index_type band_width = FULL_BAND,
+	bool *touched_edge = nullptr
+)
+{
+	const std::size_t rows = seq_ver.length + 1;
+	const std::size_t cols = seq_hor.length + 1;
+
+	// H[i * cols + j]: best score of an alignment ending at (i, j);
+	// row 0 and column 0 are all zeros
+	std::vector<score_type> H(rows * cols, 0);
+	score_type max_score = 0;
+	score_type edge_max_score = 0;
+
+	for (std::size_t i = 1; i < rows; i++) {
+		for (std::size_t j = 1; j < cols; j++) {
+			std::int64_t diag_offset = std::int64_t(j) - std::int64_t(i);
+
+			if (band_width >= 0 && (diag_offset < -band_width || diag_offset > band_width)) {
+				continue;
+			}
+
+			score_type cell = std::max({
+				reference_wrap(std::int64_t(H[i * cols + j - 1]) + gap_penalty),
+				reference_wrap(std::int64_t(H[(i - 1) * cols + j]) + gap_penalty),
+				reference_wrap(std::int64_t(H[(i - 1) * cols + j - 1]) + score(seq_ver[i - 1], seq_hor[j - 1])),
+				score_type(0)
+			});
+
+			H[i * cols + j] = cell;
+			max_score = std::max(max_score, cell);
+
+			if (diag_offset == band_width || diag_offset == -band_width) {
+				edge_max_score = std::max(edge_max_score, cell);
+			}
+		}
+	}
+
+	if (touched_edge != nullptr) {
+		*touched_edge = band_width >= 0 && max_score > 0 && edge_max_score == max_score;
+	}
+
+	return max_score;
+}
+
+// Full-matrix score with one of the scoring policies of scoring.hh.
+// Unlike reference_score(), this shares the residue score with the
+// kernel, so it only checks the recurrence for that policy.
+template<typename ScoringPolicy>
+score_type reference_policy_score(
+	SeqView seq_ver,
+	SeqView seq_hor,
+	score_type scoring_offset,
+	score_type gap_penalty
+)
+{
+	return reference_matrix_score(seq_ver, seq_hor, gap_penalty, [=](Dihedral d1, Dihedral d2) {
+		return ScoringPolicy::score(d1, d2, scoring_offset);
+	});
+}
+
+// reference_policy_score() within a band
+template<typename ScoringPolicy>
+score_type reference_policy_banded_score(
+	SeqView seq_ver,
+	SeqView seq_hor,
+	score_type scoring_offset,
+	score_type gap_penalty,
+	index_type band_width,
+	bool *touched_edge
+)
+{
+	auto score = [=](Dihedral d1, Dihedral d2) {
+		return ScoringPolicy::score(d1, d2, scoring_offset);
+	};
+
+	return reference_matrix_score(seq_ver, seq_hor, gap_penalty, score, band_width, touched_edge);
+}
+
+#endif // SWPARA_REFERENCE_HH
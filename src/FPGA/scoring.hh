@@ -0,0 +1,199 @@
+//
+// scoring.hh
+//
+// Compile-time scoring policies for the substitution score of two residues
+//
+// Created on 18/10/2026
+//
+
+#ifndef SWPARA_SCORING_HH
+#define SWPARA_SCORING_HH
+
+#include <string>
+#include <cstdint>
+#include <ap_fixed.h>
+
+#include "align.hh"
+
+
+// A scoring policy is a type with a static member function
+//
+//     static score_type score(Dihedral angle1, Dihedral angle2, score_type offset);
+//
+// The kernel and the host-side engines take the policy as a template
+// parameter, so the score is inlined into the pipelined inner loop,
+// without a branch or an indirect call per cell. For non-negative offsets,
+// no score may exceed 'offset' (compressed boundaries rely on this, see
+// BOUNDARY_DELTA_BITS in align.hh).
+//
+// The policy synthesized into align() is SCORING_POLICY, which can be
+// overridden from the command line, e.g. -DSCORING_POLICY=CosineScore.
+#ifndef SCORING_POLICY
+#define SCORING_POLICY SquaredDistanceScore
+#endif
+
+static inline unsigned_angle_type angle_abs_diff(angle_type x, angle_type y)
+{
+#pragma HLS INLINE
+	angle_type signed_diff = angle_type(unsigned_angle_type(x) - unsigned_angle_type(y));
+	// An explicit implementation of absolute value is done here inline,
+	// because std::abs<angle_type> compiles to crazy floating-point stuff.
+	return signed_diff < 0 ? -signed_diff : +signed_diff;
+}
+
+// The original score: offset minus the squared distance of the angles
+struct SquaredDistanceScore {
+	static const char *name() { return "squared"; }
+
+	static score_type score(Dihedral angle1, Dihedral angle2, score_type offset)
+	{
+#pragma HLS INLINE
+		score_type dphi = angle_abs_diff(angle1.phi, angle2.phi);
+		score_type dpsi = angle_abs_diff(angle1.psi, angle2.psi);
+		return offset - (dphi * dphi + dpsi * dpsi);
+	}
+};
+
+// The squared distance, with the angle differences converted to 'Diff'
+// before they're squared and summed, to evaluate narrower or cheaper
+// multipliers than the 32-bit ones above. AngleDiffFormat<Diff> converts
+// an absolute angle difference (0...32768, i.e. up to half a turn) to
+// Diff, and the sum of two squares back to score units.
+template<typename Diff>
+struct AngleDiffFormat;
+
+// Just wide enough for the difference of two int16 angles: exact
+template<>
+struct AngleDiffFormat<ap_int<17>> {
+	static std::string name() { return "int17"; }
+
+	static ap_int<17> from(unsigned_angle_type diff) { return diff; }
+
+	static score_type square_sum(ap_int<17> x, ap_int<17> y)
+	{
+#pragma HLS INLINE
+		ap_int<35> sum = x * x + y * y;
+		return score_type(sum);
+	}
+};
+
+// Single precision: the squares are rounded to 24 significant bits
+template<>
+struct AngleDiffFormat<float> {
+	static std::string name() { return "float"; }
+
+	static float from(unsigned_angle_type diff) { return diff; }
+
+	static score_type square_sum(float x, float y)
+	{
+#pragma HLS INLINE
+		return score_type(std::int64_t(x * x + y * y));
+	}
+};
+
+// Fixed point, in half turns: W - 1 fractional bits, so W = 17 is exact
+// (half a turn wraps around to -1, which has the same square)
+template<int W>
+struct AngleDiffFormat<ap_fixed<W, 1>> {
+	static std::string name() { return "fixed" + std::to_string(W); }
+
+	static ap_fixed<W, 1> from(unsigned_angle_type diff)
+	{
+#pragma HLS INLINE
+		return ap_fixed<W, 1>(ap_fixed<33, 17>(diff) >> 15);
+	}
+
+	static score_type square_sum(ap_fixed<W, 1> x, ap_fixed<W, 1> y)
+	{
+#pragma HLS INLINE
+		ap_fixed<2 * W + 1, 3> sum = x * x + y * y;
+		// a half turn squared is 2^30 score units
+		return score_type((ap_fixed<66, 34>(sum) << 30).to_int64());
+	}
+};
+
+template<typename Diff>
+struct SquaredDistanceScoreOf {
+	static const char *name()
+	{
+		static const std::string full_name = "squared-" + AngleDiffFormat<Diff>::name();
+		return full_name.c_str();
+	}
+
+	static score_type score(Dihedral angle1, Dihedral angle2, score_type offset)
+	{
+#pragma HLS INLINE
+		Diff dphi = AngleDiffFormat<Diff>::from(angle_abs_diff(angle1.phi, angle2.phi));
+		Diff dpsi = AngleDiffFormat<Diff>::from(angle_abs_diff(angle1.psi, angle2.psi));
+		return offset - AngleDiffFormat<Diff>::square_sum(dphi, dpsi);
+	}
+};
+
+typedef SquaredDistanceScoreOf<ap_int<17>>     Int17SquaredDistanceScore;
+typedef SquaredDistanceScoreOf<float>          FloatSquaredDistanceScore;
+typedef SquaredDistanceScoreOf<ap_fixed<17, 1>> Fixed17SquaredDistanceScore;
+typedef SquaredDistanceScoreOf<ap_fixed<12, 1>> Fixed12SquaredDistanceScore;
+
+// Squared distance with separate weights for phi and psi, scaled down
+// by 2^Shift so that the weighted sum is at most a squared half turn
+template<int WPhi, int WPsi, int Shift>
+struct WeightedScore {
+	static_assert(WPhi >= 0 && WPsi >= 0 && WPhi + WPsi <= (1 << Shift), "weighted distance must fit into score_type");
+
+	static const char *name() { return "weighted"; }
+
+	static score_type score(Dihedral angle1, Dihedral angle2, score_type offset)
+	{
+#pragma HLS INLINE
+		std::int64_t dphi = angle_abs_diff(angle1.phi, angle2.phi);
+		std::int64_t dpsi = angle_abs_diff(angle1.psi, angle2.psi);
+		return offset - score_type((WPhi * dphi * dphi + WPsi * dpsi * dpsi) >> Shift);
+	}
+};
+
+// phi counts three times as much as psi
+typedef WeightedScore<3, 1, 2> PhiWeightedScore;
+
+// cos(pi * k / 256) in Q15, k = 0...256, i.e. over half a turn in 1/512 turn steps
+extern const std::int16_t cosine_table[257];
+
+// Cosine similarity: offset * (cos(dphi) + cos(dpsi)) / 2, so that
+// identical residues score 'offset' and opposite ones score '-offset'
+struct CosineScore {
+	static const char *name() { return "cosine"; }
+
+	static std::int32_t cosine(unsigned_angle_type diff)
+	{
+#pragma HLS INLINE
+		// diff is at most half a turn (32768), rounded to the nearest entry
+		return cosine_table[(diff + 64) >> 7];
+	}
+
+	static score_type score(Dihedral angle1, Dihedral angle2, score_type offset)
+	{
+#pragma HLS INLINE
+		std::int32_t cos_sum = cosine(angle_abs_diff(angle1.phi, angle2.phi))
+		                     + cosine(angle_abs_diff(angle1.psi, angle2.psi));
+		return score_type((std::int64_t(offset) * cos_sum) >> 16);
+	}
+};
+
+// Penalty of an angle difference, in 1/16 turn steps (k = 0...16 for 0...1/2 turn)
+extern const score_type dihedral_penalty_table[17];
+
+// Table lookup: offset minus the penalties of the rounded angle differences.
+// The default table is a step approximation of half the squared distance;
+// any symmetric penalty can be substituted without touching the kernel.
+struct TableScore {
+	static const char *name() { return "table"; }
+
+	static score_type score(Dihedral angle1, Dihedral angle2, score_type offset)
+	{
+#pragma HLS INLINE
+		unsigned_angle_type dphi = angle_abs_diff(angle1.phi, angle2.phi);
+		unsigned_angle_type dpsi = angle_abs_diff(angle1.psi, angle2.psi);
+		return offset - (dihedral_penalty_table[(dphi + 1024) >> 11] + dihedral_penalty_table[(dpsi + 1024) >> 11]);
+	}
+};
+
+#endif // SWPARA_SCORING_HH
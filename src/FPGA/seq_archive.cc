@@ -0,0 +1,242 @@
+//
+// seq_archive.cc
+//
+// Compressed sequence archives
+//
+// Created on 18/10/2026
+//
+
+#include <string>
+#include <algorithm>
+#include <stdexcept>
+#include <cerrno>
+#include <cstring>
+#include <cstdio>
+
+#include "seq_archive.hh"
+#include "seq_file.hh"
+
+
+static inline std::uint16_t zigzag(angle_type delta)
+{
+	std::uint16_t bits = std::uint16_t(delta);
+	return std::uint16_t((bits << 1) ^ (delta < 0 ? 0xffff : 0));
+}
+
+static inline angle_type unzigzag(std::uint16_t value)
+{
+	return angle_type(std::uint16_t((value >> 1) ^ -(value & 1)));
+}
+
+static inline void put_varint(std::uint16_t value, std::vector<unsigned char> &code)
+{
+	while (value >= 0x80) {
+		code.push_back((value & 0x7f) | 0x80);
+		value >>= 7;
+	}
+
+	code.push_back(value);
+}
+
+// Unless 'Checked', at least 3 bytes must be readable at 'src'.
+// A 16-bit value has at most 3 bytes, the last of which holds 2 bits.
+template<bool Checked>
+static inline bool get_varint(const unsigned char *&src, const unsigned char *end, std::uint16_t &value)
+{
+	if (Checked && src == end) {
+		return false;
+	}
+
+	unsigned b0 = *src++;
+
+	if (b0 < 0x80) {
+		value = b0;
+		return true;
+	}
+
+	if (Checked && src == end) {
+		return false;
+	}
+
+	unsigned b1 = *src++;
+
+	if (b1 < 0x80) {
+		value = (b0 & 0x7f) | b1 << 7;
+		return true;
+	}
+
+	if (Checked && src == end) {
+		return false;
+	}
+
+	unsigned b2 = *src++;
+	value = (b0 & 0x7f) | (b1 & 0x7f) << 7 | b2 << 14;
+
+	return b2 < 4;
+}
+
+template<bool Checked>
+static const unsigned char *decode_residues(
+	const unsigned char *src,
+	const unsigned char *end,
+	index_type begin,
+	index_type length,
+	angle_type *phi,
+	angle_type *psi
+)
+{
+	angle_type prev_phi = begin > 0 ? phi[begin - 1] : 0;
+	angle_type prev_psi = begin > 0 ? psi[begin - 1] : 0;
+
+	for (index_type k = begin; k < length; k++) {
+		std::uint16_t d_phi, d_psi;
+
+		if (!get_varint<Checked>(src, end, d_phi) || !get_varint<Checked>(src, end, d_psi)) {
+			return nullptr;
+		}
+
+		prev_phi = phi[k] = angle_type(std::uint16_t(prev_phi + unzigzag(d_phi)));
+		prev_psi = psi[k] = angle_type(std::uint16_t(prev_psi + unzigzag(d_psi)));
+	}
+
+	return src;
+}
+
+static inline void put_raw(angle_type angle, std::vector<unsigned char> &code)
+{
+	code.push_back(std::uint16_t(angle) & 0xff);
+	code.push_back(std::uint16_t(angle) >> 8);
+}
+
+void encode_sequence(SeqView seq, std::vector<unsigned char> &code)
+{
+	std::size_t begin = code.size();
+	std::size_t raw_size = std::size_t(seq.length) * SEQ_ARCHIVE_RAW_RESIDUE_SIZE;
+	angle_type prev_phi = 0;
+	angle_type prev_psi = 0;
+
+	for (index_type k = 0; k < seq.length && code.size() - begin < raw_size; k++) {
+		put_varint(zigzag(angle_type(std::uint16_t(seq.phi[k] - prev_phi))), code);
+		put_varint(zigzag(angle_type(std::uint16_t(seq.psi[k] - prev_psi))), code);
+		prev_phi = seq.phi[k];
+		prev_psi = seq.psi[k];
+	}
+
+	if (code.size() - begin < raw_size || seq.length == 0) {
+		return;
+	}
+
+	code.resize(begin);
+
+	for (index_type k = 0; k < seq.length; k++) {
+		put_raw(seq.phi[k], code);
+		put_raw(seq.psi[k], code);
+	}
+}
+
+bool decode_sequence(
+	const unsigned char *src,
+	const unsigned char *end,
+	index_type length,
+	angle_type *phi,
+	angle_type *psi
+)
+{
+	std::size_t available = end - src;
+
+	if (available == std::size_t(length) * SEQ_ARCHIVE_RAW_RESIDUE_SIZE && length > 0) {
+		for (index_type k = 0; k < length; k++, src += SEQ_ARCHIVE_RAW_RESIDUE_SIZE) {
+			phi[k] = angle_type(std::uint16_t(src[0] | src[1] << 8));
+			psi[k] = angle_type(std::uint16_t(src[2] | src[3] << 8));
+		}
+
+		return true;
+	}
+
+	// Bounds only need to be checked near the end of the code: every
+	// residue that starts at least a maximal residue size before the end
+	// can be decoded without looking at 'end'.
+	index_type num_unchecked = std::min<std::size_t>(length, available / SEQ_ARCHIVE_MAX_RESIDUE_SIZE);
+
+	src = decode_residues<false>(src, end, 0, num_unchecked, phi, psi);
+
+	if (src == nullptr) {
+		return false;
+	}
+
+	return decode_residues<true>(src, end, num_unchecked, length, phi, psi) == end;
+}
+
+static std::runtime_error archive_error(const char *what, const char *path)
+{
+	return std::runtime_error(std::string(what) + " '" + path + "': " + std::strerror(errno));
+}
+
+std::uint64_t write_seq_archive(SeqFile &seqs, const char *path, std::size_t memory_budget)
+{
+	std::FILE *file = std::fopen(path, "wb");
+
+	if (file == nullptr) {
+		throw archive_error("can't create", path);
+	}
+
+	seq_count_type num_seqs = seqs.size();
+	std::vector<std::uint64_t> offsets(num_seqs + 1, 0);
+	std::vector<unsigned char> code;
+	SequenceStore block;
+
+	try {
+		// The offsets are only known at the end; their place is reserved until then
+		if (
+			std::fwrite(&seq_archive_magic, sizeof seq_archive_magic, 1, file) != 1 ||
+			std::fwrite(&num_seqs, sizeof num_seqs, 1, file) != 1 ||
+			std::fwrite(seqs.lengths().data(), sizeof(index_type), num_seqs, file) != num_seqs ||
+			std::fwrite(offsets.data(), sizeof offsets[0], offsets.size(), file) != offsets.size()
+		) {
+			throw archive_error("can't write", path);
+		}
+
+		for (seq_count_type begin = 0; begin < num_seqs; ) {
+			seq_count_type end = begin + 1;
+			std::size_t size = SequenceStore::bytes_for(seqs.lengths()[begin]);
+
+			while (end < num_seqs && size + SequenceStore::bytes_for(seqs.lengths()[end]) <= memory_budget) {
+				size += SequenceStore::bytes_for(seqs.lengths()[end]);
+				end++;
+			}
+
+			seqs.read(begin, end, block);
+			code.clear();
+
+			for (seq_count_type i = begin; i < end; i++) {
+				encode_sequence(block[i - begin], code);
+				offsets[i + 1] = offsets[begin] + code.size();
+			}
+
+			if (std::fwrite(code.data(), 1, code.size(), file) != code.size()) {
+				throw archive_error("can't write", path);
+			}
+
+			begin = end;
+		}
+
+		long index_offset = sizeof seq_archive_magic + sizeof num_seqs + num_seqs * sizeof(index_type);
+
+		if (
+			std::fseek(file, index_offset, SEEK_SET) != 0 ||
+			std::fwrite(offsets.data(), sizeof offsets[0], offsets.size(), file) != offsets.size()
+		) {
+			throw archive_error("can't write", path);
+		}
+	} catch (...) {
+		std::fclose(file);
+		std::remove(path);
+		throw;
+	}
+
+	if (std::fclose(file) != 0) {
+		throw archive_error("can't write", path);
+	}
+
+	return seq_archive_data_offset(num_seqs) + offsets[num_seqs];
+}
@@ -0,0 +1,78 @@
+//
+// seq_archive.hh
+//
+// Compressed sequence archives. Backbone dihedrals of consecutive
+// residues are strongly correlated, so every angle is stored as the
+// difference from the same angle of the previous residue, zigzag-mapped
+// and coded as a little-endian base-128 varint (1 to 3 bytes).
+//
+// Layout of an archive file:
+//
+//     std::uint32_t  magic               seq_archive_magic
+//     seq_count_type num_seqs
+//     index_type     lengths[num_seqs]
+//     std::uint64_t  offsets[num_seqs + 1]  of the code of each sequence,
+//                                           from the start of the code
+//     code of sequence #0, #1, ...
+//
+// The code of a sequence is phi, psi of residue #0, then of #1, and so on;
+// the "previous residue" of residue #0 has zero angles. Sequences that
+// don't compress (e.g. random angles) are stored raw instead: a code of
+// exactly 4 bytes per residue is the raw little-endian phi, psi pairs,
+// and varint codes are always shorter than that. The offset index
+// makes any sequence decodable on its own. SeqFile reads both archives
+// and raw INPUT.BIN files; the board's loader has its own decoder
+// (src/ARM/seq_archive.c) for the same format.
+//
+// Created on 18/10/2026
+//
+
+#ifndef SWPARA_SEQ_ARCHIVE_HH
+#define SWPARA_SEQ_ARCHIVE_HH
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#include "align.hh"
+#include "seq_store.hh"
+
+
+static const std::uint32_t seq_archive_magic = 0x5a535753; // "SWSZ"
+
+// Maximal number of bytes of varint code per residue
+#define SEQ_ARCHIVE_MAX_RESIDUE_SIZE 6
+
+// Number of bytes of a raw (uncompressed) residue
+#define SEQ_ARCHIVE_RAW_RESIDUE_SIZE 4
+
+// Byte offset of the code in an archive of 'num_seqs' sequences
+inline std::uint64_t seq_archive_data_offset(seq_count_type num_seqs)
+{
+	return sizeof seq_archive_magic
+	     + sizeof num_seqs
+	     + num_seqs * sizeof(index_type)
+	     + (num_seqs + std::uint64_t(1)) * sizeof(std::uint64_t);
+}
+
+// Append the code of 'seq' to 'code'
+void encode_sequence(SeqView seq, std::vector<unsigned char> &code);
+
+// Decode the code of a sequence of 'length' residues, [src, end),
+// into 'phi' and 'psi'. Returns false if it's not a valid code.
+bool decode_sequence(
+	const unsigned char *src,
+	const unsigned char *end,
+	index_type length,
+	angle_type *phi,
+	angle_type *psi
+);
+
+class SeqFile;
+
+// Write all sequences of 'seqs' to a new archive at 'path', reading at most
+// about 'memory_budget' bytes of sequence data at a time.
+// Returns the size of the archive.
+std::uint64_t write_seq_archive(SeqFile &seqs, const char *path, std::size_t memory_budget);
+
+#endif // SWPARA_SEQ_ARCHIVE_HH
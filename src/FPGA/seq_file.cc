@@ -0,0 +1,323 @@
+//
+// seq_file.cc
+//
+// Reading sequences from / writing results to files
+// on the host (C simulation) side
+//
+// Created on 18/10/2026
+//
+
+#include <string>
+#include <stdexcept>
+#include <cerrno>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+
+#include <unistd.h>
+
+#include "seq_file.hh"
+#include "seq_archive.hh"
+
+
+static std::runtime_error file_error(const char *what, const char *path)
+{
+	return std::runtime_error(std::string(what) + " '" + path + "': " + std::strerror(errno));
+}
+
+SeqFile::SeqFile(const char *path) : file_(std::fopen(path, "rb"))
+{
+	if (file_ == nullptr) {
+		throw file_error("can't open", path);
+	}
+
+	try {
+		read_lengths(path);
+	} catch (...) {
+		std::fclose(file_);
+		throw;
+	}
+}
+
+SeqFile::~SeqFile()
+{
+	std::fclose(file_);
+}
+
+void SeqFile::read_lengths(const char *path)
+{
+	// An archive starts with its magic number, a raw file with the count
+	std::uint32_t magic = 0;
+	seq_count_type num_seqs = 0;
+
+	static_assert(sizeof magic == sizeof num_seqs, "magic number must be the size of the sequence count");
+
+	if (std::fread(&magic, sizeof magic, 1, file_) != 1) {
+		throw file_error("can't read sequence count from", path);
+	}
+
+	bool archive = magic == seq_archive_magic;
+
+	if (!archive) {
+		num_seqs = magic;
+	} else if (std::fread(&num_seqs, sizeof num_seqs, 1, file_) != 1) {
+		throw file_error("can't read sequence count from", path);
+	}
+
+	lengths_.resize(num_seqs);
+
+	if (std::fread(lengths_.data(), sizeof lengths_[0], num_seqs, file_) != num_seqs) {
+		throw file_error("can't read sequence lengths from", path);
+	}
+
+	offsets_.resize(num_seqs + 1);
+	offsets_[0] = 0;
+
+	for (seq_count_type i = 0; i < num_seqs; i++) {
+		if (lengths_[i] < 0 || lengths_[i] > MAX_SEQ_SIZE) {
+			throw std::runtime_error(
+				"length of sequence #" + std::to_string(i) + " (" + std::to_string(lengths_[i]) + ") in '" + path + "' "
+				"is out of range [0, " + std::to_string(MAX_SEQ_SIZE) + "]"
+			);
+		}
+
+		offsets_[i + 1] = offsets_[i] + lengths_[i];
+	}
+
+	if (archive) {
+		read_archive_index(path);
+		data_offset_ = seq_archive_data_offset(num_seqs);
+	} else {
+		data_offset_ = sizeof num_seqs + num_seqs * sizeof lengths_[0];
+	}
+}
+
+void SeqFile::read_archive_index(const char *path)
+{
+	seq_count_type num_seqs = size();
+	code_offsets_.resize(num_seqs + 1);
+
+	if (std::fread(code_offsets_.data(), sizeof code_offsets_[0], num_seqs + 1, file_) != num_seqs + 1) {
+		throw file_error("can't read archive index from", path);
+	}
+
+	// Every residue takes at least 2 bytes of code, and raw ones the most
+	bool valid = code_offsets_[0] == 0;
+
+	for (seq_count_type i = 0; valid && i < num_seqs; i++) {
+		std::uint64_t code_size = code_offsets_[i + 1] - code_offsets_[i];
+
+		valid = code_offsets_[i + 1] >= code_offsets_[i]
+		     && code_size >= 2 * std::uint64_t(lengths_[i])
+		     && code_size <= SEQ_ARCHIVE_RAW_RESIDUE_SIZE * std::uint64_t(lengths_[i]);
+	}
+
+	if (!valid) {
+		throw std::runtime_error(std::string("invalid archive index in '") + path + "'");
+	}
+}
+
+std::uint64_t SeqFile::total_length(seq_count_type begin, seq_count_type end) const
+{
+	return offsets_[end] - offsets_[begin];
+}
+
+void SeqFile::read(seq_count_type begin, seq_count_type end, SequenceStore &seqs)
+{
+	seqs.clear();
+	seqs.reserve(end - begin, total_length(begin, end));
+
+	// Sequences are appended first, then filled from the file
+	for (seq_count_type i = begin; i < end; i++) {
+		angle_type *phi, *psi;
+		seqs.append(lengths_[i], phi, psi);
+	}
+
+	if (is_archive()) {
+		read_archive(begin, end, seqs);
+	} else {
+		read_raw(begin, end, seqs);
+	}
+}
+
+void SeqFile::read_raw(seq_count_type begin, seq_count_type end, SequenceStore &seqs)
+{
+	// deinterleaving granularity: large enough to amortize the fread calls
+	static const std::size_t chunk_size = 1 << 16;
+
+	long offset = data_offset_ + long(offsets_[begin] * sizeof(Dihedral));
+
+	if (std::fseek(file_, offset, SEEK_SET) != 0) {
+		throw std::runtime_error("can't read sequence data: " + std::string(std::strerror(errno)));
+	}
+
+	seq_count_type i = 0;  // index within 'seqs'
+	index_type k = 0;      // index within sequence #i
+	std::size_t remaining = total_length(begin, end);
+
+	while (remaining > 0) {
+		std::size_t count = std::min(remaining, chunk_size);
+		buf_.resize(count);
+
+		if (std::fread(buf_.data(), sizeof buf_[0], count, file_) != count) {
+			throw std::runtime_error("can't read sequence data: " + std::string(std::strerror(errno)));
+		}
+
+		for (const Dihedral &d : buf_) {
+			while (k == seqs.lengths()[i]) {
+				i++;
+				k = 0;
+			}
+
+			seqs.phi(i)[k] = d.phi;
+			seqs.psi(i)[k] = d.psi;
+			k++;
+		}
+
+		remaining -= count;
+	}
+}
+
+void SeqFile::read_archive(seq_count_type begin, seq_count_type end, SequenceStore &seqs)
+{
+	// Code is read in chunks of whole sequences, at least one sequence at a time
+	static const std::uint64_t chunk_size = 1 << 18;
+
+	long offset = data_offset_ + long(code_offsets_[begin]);
+
+	if (std::fseek(file_, offset, SEEK_SET) != 0) {
+		throw std::runtime_error("can't read sequence data: " + std::string(std::strerror(errno)));
+	}
+
+	for (seq_count_type first = begin; first < end; ) {
+		seq_count_type last = first + 1;
+
+		while (last < end && code_offsets_[last + 1] - code_offsets_[first] <= chunk_size) {
+			last++;
+		}
+
+		std::size_t size = code_offsets_[last] - code_offsets_[first];
+		code_buf_.resize(size);
+
+		if (std::fread(code_buf_.data(), 1, size, file_) != size) {
+			throw std::runtime_error("can't read sequence data: " + std::string(std::strerror(errno)));
+		}
+
+		for (seq_count_type i = first; i < last; i++) {
+			const unsigned char *code = code_buf_.data() + (code_offsets_[i] - code_offsets_[first]);
+			const unsigned char *code_end = code_buf_.data() + (code_offsets_[i + 1] - code_offsets_[first]);
+
+			if (!decode_sequence(code, code_end, lengths_[i], seqs.phi(i - begin), seqs.psi(i - begin))) {
+				throw std::runtime_error("corrupt code of sequence #" + std::to_string(i) + " in archive");
+			}
+		}
+
+		first = last;
+	}
+}
+
+void TextRowWriter::write_row(seq_count_type row, const score_type *scores, seq_count_type count)
+{
+	std::fprintf(file_, "#%lu.\t", static_cast<unsigned long>(row));
+
+	for (seq_count_type j = 0; j < count; j++) {
+		std::fprintf(file_, " %ld", static_cast<long>(scores[j]));
+	}
+
+	std::fprintf(file_, "\n");
+}
+
+void TextRowWriter::finish()
+{
+	std::fprintf(file_, "\n");
+	std::fflush(file_);
+}
+
+ScoreFileWriter::ScoreFileWriter(const char *path, const void *header, std::size_t header_size, std::uint64_t resume_size) :
+	file_(std::fopen(path, resume_size > 0 ? "r+b" : "wb")),
+	size_(resume_size)
+{
+	if (file_ == nullptr) {
+		throw file_error(resume_size > 0 ? "can't reopen" : "can't create", path);
+	}
+
+	if (resume_size > 0) {
+		// drop anything written after the last checkpoint
+		if (std::fflush(file_) != 0 || ftruncate(fileno(file_), resume_size) != 0 || std::fseek(file_, 0, SEEK_END) != 0) {
+			std::fclose(file_);
+			throw file_error("can't resume", path);
+		}
+
+		return;
+	}
+
+	if (std::fwrite(header, header_size, 1, file_) != 1) {
+		std::fclose(file_);
+		throw file_error("can't write", path);
+	}
+
+	size_ = header_size;
+}
+
+ScoreFileWriter::~ScoreFileWriter()
+{
+	std::fclose(file_);
+}
+
+void ScoreFileWriter::write_row(seq_count_type, const score_type *scores, seq_count_type count)
+{
+	if (std::fwrite(scores, sizeof scores[0], count, file_) != count) {
+		throw std::runtime_error("can't write scores: " + std::string(std::strerror(errno)));
+	}
+
+	size_ += count * sizeof scores[0];
+}
+
+void ScoreFileWriter::finish()
+{
+	if (std::fflush(file_) != 0) {
+		throw std::runtime_error("can't write scores: " + std::string(std::strerror(errno)));
+	}
+}
+
+std::uint64_t ScoreFileWriter::sync()
+{
+	if (std::fflush(file_) != 0 || fsync(fileno(file_)) != 0) {
+		throw std::runtime_error("can't sync scores: " + std::string(std::strerror(errno)));
+	}
+
+	return size_;
+}
+
+BinaryRowWriter::BinaryRowWriter(const char *path, seq_count_type num_seqs, std::uint64_t resume_size) :
+	ScoreFileWriter(path, &num_seqs, sizeof num_seqs, resume_size)
+{}
+
+ShardHeader read_shard_header(std::FILE *file, const char *path)
+{
+	ShardHeader header;
+
+	if (std::fread(&header, sizeof header, 1, file) != 1) {
+		throw file_error("can't read shard header from", path);
+	}
+
+	if (header.magic != shard_magic || header.row_begin > header.row_end || header.row_end >= std::max<seq_count_type>(header.num_seqs, 1)) {
+		throw std::runtime_error(std::string("invalid shard header in '") + path + "'");
+	}
+
+	return header;
+}
+
+ShardRowWriter::ShardRowWriter(
+	const char *path,
+	seq_count_type num_seqs,
+	seq_count_type row_begin,
+	seq_count_type row_end,
+	std::uint64_t resume_size
+) :
+	ShardRowWriter(path, ShardHeader { shard_magic, num_seqs, row_begin, row_end }, resume_size)
+{}
+
+ShardRowWriter::ShardRowWriter(const char *path, const ShardHeader &header, std::uint64_t resume_size) :
+	ScoreFileWriter(path, &header, sizeof header, resume_size)
+{}
@@ -0,0 +1,147 @@
+//
+// seq_file.hh
+//
+// Reading sequences from / writing results to files
+// on the host (C simulation) side
+//
+// Created on 18/10/2026
+//
+
+#ifndef SWPARA_SEQ_FILE_HH
+#define SWPARA_SEQ_FILE_HH
+
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+
+#include "align.hh"
+#include "seq_store.hh"
+
+
+// Random access to the sequences of a binary INPUT.BIN file:
+// a seq_count_type count, the index_type lengths, then the raw
+// Dihedral data of every sequence, contiguously.
+// Compressed archives (see seq_archive.hh) are read just the same.
+// Only the lengths (and the offset index of an archive) are kept
+// in memory; sequence data is read on demand. The constructor throws
+// if a length is out of the range [0, MAX_SEQ_SIZE] of align().
+class SeqFile {
+public:
+	explicit SeqFile(const char *path);
+	~SeqFile();
+
+	SeqFile(const SeqFile &) = delete;
+	SeqFile &operator=(const SeqFile &) = delete;
+
+	seq_count_type size() const { return lengths_.size(); }
+	const std::vector<index_type> &lengths() const { return lengths_; }
+
+	// Number of dihedrals in sequences [begin, end)
+	std::uint64_t total_length(seq_count_type begin, seq_count_type end) const;
+
+	bool is_archive() const { return !code_offsets_.empty(); }
+
+	// Replace the contents of 'seqs' with sequences [begin, end)
+	void read(seq_count_type begin, seq_count_type end, SequenceStore &seqs);
+
+private:
+	void read_lengths(const char *path);
+	void read_archive_index(const char *path);
+	void read_raw(seq_count_type begin, seq_count_type end, SequenceStore &seqs);
+	void read_archive(seq_count_type begin, seq_count_type end, SequenceStore &seqs);
+
+	std::FILE *file_;
+	std::vector<index_type> lengths_;
+	std::vector<std::uint64_t> offsets_;      // offsets_[i]: index of first dihedral of seq. #i
+	std::vector<std::uint64_t> code_offsets_; // archives only: offset of the code of seq. #i
+	long data_offset_;                        // byte offset of the sequence data in the file
+	std::vector<Dihedral> buf_;               // file data is deinterleaved through this
+	std::vector<unsigned char> code_buf_;     // archive code is decoded from this
+};
+
+// Receives finished rows of the upper triangle, in order.
+// Row #i contains the scores of sequence #i against #i+1...n-1.
+class RowWriter {
+public:
+	virtual ~RowWriter() {}
+	virtual void write_row(seq_count_type row, const score_type *scores, seq_count_type count) = 0;
+	virtual void finish() = 0;
+
+	// Whether write_row() may be called from several threads at once, for
+	// different rows in any order; otherwise rows come one at a time, in order
+	virtual bool concurrent() const { return false; }
+};
+
+// Same textual layout as the original testbench dump
+class TextRowWriter : public RowWriter {
+public:
+	explicit TextRowWriter(std::FILE *file) : file_(file) {}
+
+	void write_row(seq_count_type row, const score_type *scores, seq_count_type count) override;
+	void finish() override;
+
+private:
+	std::FILE *file_;
+};
+
+// Binary score files: a fixed header, then the raw scores of consecutive rows.
+// With a non-zero 'resume_size', an existing file is truncated to that many
+// bytes and appended to, instead of being created (see checkpoint.hh).
+class ScoreFileWriter : public RowWriter {
+public:
+	~ScoreFileWriter();
+
+	ScoreFileWriter(const ScoreFileWriter &) = delete;
+	ScoreFileWriter &operator=(const ScoreFileWriter &) = delete;
+
+	void write_row(seq_count_type row, const score_type *scores, seq_count_type count) override;
+	void finish() override;
+
+	// Flush everything written so far to stable storage. Returns the size of the file.
+	std::uint64_t sync();
+
+protected:
+	ScoreFileWriter(const char *path, const void *header, std::size_t header_size, std::uint64_t resume_size);
+
+private:
+	std::FILE *file_;
+	std::uint64_t size_;
+};
+
+// Same binary layout as the OUTPUT.BIN written by the board
+// (without the padding to the SD card's sector size)
+class BinaryRowWriter : public ScoreFileWriter {
+public:
+	BinaryRowWriter(const char *path, seq_count_type num_seqs, std::uint64_t resume_size = 0);
+};
+
+// Scores of a slice of rows [row_begin, row_end) of the triangle,
+// computed by one process of a sharded job.
+// Layout: this header, then the scores of the rows, in row-major order.
+struct ShardHeader {
+	std::uint32_t magic;
+	seq_count_type num_seqs;
+	seq_count_type row_begin;
+	seq_count_type row_end;
+};
+
+static const std::uint32_t shard_magic = 0x48535753; // "SWSH"
+
+// Reads and validates the header; throws if it's not a shard file
+ShardHeader read_shard_header(std::FILE *file, const char *path);
+
+class ShardRowWriter : public ScoreFileWriter {
+public:
+	ShardRowWriter(
+		const char *path,
+		seq_count_type num_seqs,
+		seq_count_type row_begin,
+		seq_count_type row_end,
+		std::uint64_t resume_size = 0
+	);
+
+private:
+	ShardRowWriter(const char *path, const ShardHeader &header, std::uint64_t resume_size);
+};
+
+#endif // SWPARA_SEQ_FILE_HH
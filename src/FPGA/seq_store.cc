@@ -0,0 +1,79 @@
+//
+// seq_store.cc
+//
+// Host-side storage of sequences in structure-of-arrays layout
+//
+// Created on 18/10/2026
+//
+
+#include <algorithm>
+
+#include "seq_store.hh"
+
+
+static std::size_t padded(std::size_t length)
+{
+	return (length + SEQ_STORE_PAD - 1) / SEQ_STORE_PAD * SEQ_STORE_PAD;
+}
+
+void SequenceStore::clear()
+{
+	phi_.clear();
+	psi_.clear();
+	offsets_.assign(1, 0);
+	lengths_.clear();
+}
+
+void SequenceStore::reserve(seq_count_type num_seqs, std::size_t total_length)
+{
+	// upper bound of the padding: a full pad per sequence
+	phi_.reserve(total_length + num_seqs * SEQ_STORE_PAD);
+	psi_.reserve(total_length + num_seqs * SEQ_STORE_PAD);
+	offsets_.reserve(num_seqs + 1);
+	lengths_.reserve(num_seqs);
+}
+
+void SequenceStore::append(index_type length, angle_type *&phi, angle_type *&psi)
+{
+	std::size_t begin = offsets_.back();
+	std::size_t end = begin + padded(length);
+
+	phi_.resize(end, 0);
+	psi_.resize(end, 0);
+	offsets_.push_back(end);
+	lengths_.push_back(length);
+
+	phi = phi_.data() + begin;
+	psi = psi_.data() + begin;
+}
+
+void SequenceStore::append(const Dihedral *seq, index_type length)
+{
+	angle_type *phi, *psi;
+	append(length, phi, psi);
+
+	for (index_type k = 0; k < length; k++) {
+		phi[k] = seq[k].phi;
+		psi[k] = seq[k].psi;
+	}
+}
+
+void SequenceStore::append(SeqView seq)
+{
+	angle_type *phi, *psi;
+	append(seq.length, phi, psi);
+
+	std::copy(seq.phi, seq.phi + seq.length, phi);
+	std::copy(seq.psi, seq.psi + seq.length, psi);
+}
+
+std::size_t SequenceStore::total_length(seq_count_type begin, seq_count_type end) const
+{
+	std::size_t total = 0;
+
+	for (seq_count_type i = begin; i < end; i++) {
+		total += lengths_[i];
+	}
+
+	return total;
+}
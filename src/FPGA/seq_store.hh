@@ -0,0 +1,126 @@
+//
+// seq_store.hh
+//
+// Host-side storage of sequences in structure-of-arrays layout:
+// separate, 64-byte aligned phi and psi arrays, so that vectorized
+// scorers can load either angle of consecutive residues directly.
+//
+// Created on 18/10/2026
+//
+
+#ifndef SWPARA_SEQ_STORE_HH
+#define SWPARA_SEQ_STORE_HH
+
+#include <vector>
+#include <new>
+#include <cstdlib>
+#include <cstddef>
+
+#include "align.hh"
+
+
+// Alignment of every sequence, in bytes (one cache line, or one AVX-512 register)
+#define SEQ_STORE_ALIGN 64
+
+// Every sequence is padded with zero angles to a multiple of this many residues
+#define SEQ_STORE_PAD (SEQ_STORE_ALIGN / sizeof(angle_type))
+
+template<typename T, std::size_t Align>
+struct AlignedAllocator {
+	typedef T value_type;
+
+	template<typename U>
+	struct rebind {
+		typedef AlignedAllocator<U, Align> other;
+	};
+
+	AlignedAllocator() {}
+
+	template<typename U>
+	AlignedAllocator(const AlignedAllocator<U, Align> &) {}
+
+	T *allocate(std::size_t n)
+	{
+		void *ptr = nullptr;
+
+		if (posix_memalign(&ptr, Align, n * sizeof(T)) != 0) {
+			throw std::bad_alloc();
+		}
+
+		return static_cast<T *>(ptr);
+	}
+
+	void deallocate(T *ptr, std::size_t)
+	{
+		std::free(ptr);
+	}
+};
+
+template<typename T, typename U, std::size_t Align>
+bool operator==(const AlignedAllocator<T, Align> &, const AlignedAllocator<U, Align> &) { return true; }
+
+template<typename T, typename U, std::size_t Align>
+bool operator!=(const AlignedAllocator<T, Align> &, const AlignedAllocator<U, Align> &) { return false; }
+
+typedef std::vector<angle_type, AlignedAllocator<angle_type, SEQ_STORE_ALIGN>> AngleArray;
+
+// Non-owning view of one sequence of a store. 'phi' and 'psi' are
+// SEQ_STORE_ALIGN-aligned, and readable (as zeros) up to 'padded_length()'.
+struct SeqView {
+	const angle_type *phi;
+	const angle_type *psi;
+	index_type length;
+
+	Dihedral operator[](index_type k) const { return { phi[k], psi[k] }; }
+
+	std::size_t padded_length() const { return (length + SEQ_STORE_PAD - 1) / SEQ_STORE_PAD * SEQ_STORE_PAD; }
+};
+
+class SequenceStore {
+public:
+	SequenceStore() : offsets_(1, 0) {}
+
+	void clear();
+	void reserve(seq_count_type num_seqs, std::size_t total_length);
+
+	// Append a sequence of 'length' residues, all set to zero,
+	// and return writable pointers to its angles in 'phi' and 'psi'.
+	void append(index_type length, angle_type *&phi, angle_type *&psi);
+
+	void append(const Dihedral *seq, index_type length);
+	void append(SeqView seq);
+
+	seq_count_type size() const { return lengths_.size(); }
+	bool empty() const { return lengths_.empty(); }
+
+	SeqView operator[](seq_count_type i) const
+	{
+		return { phi_.data() + offsets_[i], psi_.data() + offsets_[i], lengths_[i] };
+	}
+
+	// Writable angles of sequence #i
+	angle_type *phi(seq_count_type i) { return phi_.data() + offsets_[i]; }
+	angle_type *psi(seq_count_type i) { return psi_.data() + offsets_[i]; }
+
+	const std::vector<index_type> &lengths() const { return lengths_; }
+
+	// Number of residues (without padding) in sequences [begin, end)
+	std::size_t total_length(seq_count_type begin, seq_count_type end) const;
+
+	// Number of bytes used by the angle arrays
+	std::size_t memory_size() const { return 2 * phi_.size() * sizeof(angle_type); }
+
+	// Number of bytes a sequence of 'length' residues takes up, including padding
+	static std::size_t bytes_for(index_type length)
+	{
+		return 2 * SeqView { nullptr, nullptr, length }.padded_length() * sizeof(angle_type);
+	}
+
+private:
+	AngleArray phi_;
+	AngleArray psi_;
+	std::vector<std::size_t> offsets_; // offsets_[i]: index of the first residue of seq. #i; n + 1 elements
+	std::vector<index_type> lengths_;
+};
+
+#endif // SWPARA_SEQ_STORE_HH
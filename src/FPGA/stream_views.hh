@@ -0,0 +1,113 @@
+//
+// stream_views.hh
+//
+// Stand-ins for the streams of align() in the C simulation. Instead of a
+// copy of the sequences in an hls::stream, the input views read straight
+// out of the sequence store (or the caller's arrays), and instead of
+// queueing the AXI records of a row, the output view writes every score
+// to its place in the caller's row buffer. So setting up the streams of a
+// row costs O(1) and allocates nothing, however long the row is, and no
+// memory is needed for scores beyond the rows that the caller keeps.
+// Only what align() calls is provided.
+//
+// Created on 18/10/2026
+//
+
+#ifndef SWPARA_STREAM_VIEWS_HH
+#define SWPARA_STREAM_VIEWS_HH
+
+#include <cstddef>
+
+#include "align.hh"
+#include "seq_store.hh"
+
+
+// Sequences #first... of a store, or the sequences of an array of views
+class SeqRange {
+public:
+	SeqRange(const SequenceStore &store, seq_count_type first) : store_(&store), views_(nullptr), first_(first) {}
+	SeqRange(const SeqView *views) : store_(nullptr), views_(views), first_(0) {}
+
+	SeqView operator[](seq_count_type j) const { return store_ ? (*store_)[first_ + j] : views_[j]; }
+
+private:
+	const SequenceStore *store_;
+	const SeqView *views_;
+	seq_count_type first_;
+};
+
+// The residues of 'count' sequences of a range, back to back
+class SeqStreamView {
+public:
+	SeqStreamView(SeqRange seqs, seq_count_type count) :
+		seqs_(seqs),
+		count_(count),
+		next_(0),
+		cur_ { nullptr, nullptr, 0 },
+		pos_(0)
+	{}
+
+	explicit SeqStreamView(const SeqView &seq) : SeqStreamView(SeqRange(&seq), 1) {}
+
+	Dihedral read()
+	{
+		// empty sequences have nothing to read
+		while (pos_ == cur_.length && next_ < count_) {
+			cur_ = seqs_[next_++];
+			pos_ = 0;
+		}
+
+		return cur_[pos_++];
+	}
+
+	// Residues left in the sequence being read; unlike hls::stream::size(),
+	// not in the whole stream, which would cost a pass over the lengths
+	std::size_t size() const { return cur_.length - pos_; }
+
+private:
+	SeqRange seqs_;
+	seq_count_type count_;
+	seq_count_type next_; // sequence after the one being read
+	SeqView cur_;
+	index_type pos_;
+};
+
+// The lengths of 'count' sequences of a range
+class LengthStreamView {
+public:
+	LengthStreamView(SeqRange seqs, seq_count_type count) : seqs_(seqs), count_(count), next_(0) {}
+
+	index_type read() { return seqs_[next_++].length; }
+
+	std::size_t size() const { return count_ - next_; }
+
+private:
+	SeqRange seqs_;
+	seq_count_type count_;
+	seq_count_type next_;
+};
+
+// The scores of consecutive pairs, to 'scores[0]', 'scores[1]', ...,
+// and their band edge flags likewise to 'touched_edges' unless it's nullptr
+class ScoreSinkView {
+public:
+	ScoreSinkView(score_type *scores, bool *touched_edges) : scores_(scores), touched_edges_(touched_edges), next_(0) {}
+
+	void write(const axi_out_score_type &axi_score)
+	{
+		scores_[next_] = axi_score.data;
+
+		if (touched_edges_ != nullptr) {
+			touched_edges_[next_] = axi_score.user;
+		}
+
+		next_++;
+	}
+
+private:
+	score_type *scores_;
+	bool *touched_edges_;
+	seq_count_type next_;
+};
+
+#endif // SWPARA_STREAM_VIEWS_HH
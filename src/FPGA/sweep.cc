@@ -0,0 +1,136 @@
+//
+// sweep.cc
+//
+// Scores under several scoring settings in a single pass over the data
+//
+// Created on 18/10/2026
+//
+
+#include <algorithm>
+#include <cstdint>
+
+#include "sweep.hh"
+#include "scoring.hh"
+#include "profile.hh"
+
+
+// The kernel computes in score_type, so overflow must wrap the same way
+static inline score_type wrapping_add(score_type x, score_type y)
+{
+	return static_cast<score_type>(static_cast<std::uint32_t>(x) + static_cast<std::uint32_t>(y));
+}
+
+// One group of SWEEP_LANES settings. Rows of the matrix are stored
+// lane-interleaved, so that the innermost loop runs over the settings
+// of a single cell and vectorizes without shuffles.
+template<typename ScoringPolicy>
+static void sweep_lanes(
+	SeqView seq_ver,
+	SeqView seq_hor,
+	const ScoringParams *lanes,
+	score_type *max_scores,
+	std::vector<score_type> &prev,
+	std::vector<score_type> &cur
+)
+{
+	const std::size_t cols = seq_hor.length + 1;
+
+	score_type offsets[SWEEP_LANES];
+	score_type penalties[SWEEP_LANES];
+	score_type maxima[SWEEP_LANES];
+
+	for (std::size_t k = 0; k < SWEEP_LANES; k++) {
+		offsets[k] = lanes[k].scoring_offset;
+		penalties[k] = lanes[k].gap_penalty;
+		maxima[k] = 0;
+	}
+
+	// column 0 stays all zeros
+	prev.assign(cols * SWEEP_LANES, 0);
+	cur.assign(cols * SWEEP_LANES, 0);
+
+	for (index_type i = 0; i < seq_ver.length; i++) {
+		Dihedral d_ver = seq_ver[i];
+
+		for (std::size_t j = 1; j < cols; j++) {
+			Dihedral d_hor = seq_hor[j - 1];
+
+			const score_type *left = &cur[(j - 1) * SWEEP_LANES];
+			const score_type *top  = &prev[j * SWEEP_LANES];
+			const score_type *diag = &prev[(j - 1) * SWEEP_LANES];
+			score_type *cell = &cur[j * SWEEP_LANES];
+
+			for (std::size_t k = 0; k < SWEEP_LANES; k++) {
+				score_type score = std::max(
+					std::max(wrapping_add(left[k], penalties[k]), wrapping_add(top[k], penalties[k])),
+					std::max(wrapping_add(diag[k], ScoringPolicy::score(d_ver, d_hor, offsets[k])), score_type(0))
+				);
+
+				cell[k] = score;
+				maxima[k] = std::max(maxima[k], score);
+			}
+		}
+
+		std::swap(prev, cur);
+	}
+
+	std::copy(maxima, maxima + SWEEP_LANES, max_scores);
+}
+
+template<typename ScoringPolicy>
+void sweep_score(
+	SeqView seq_ver,
+	SeqView seq_hor,
+	const ScoringParams *settings,
+	std::size_t num_settings,
+	score_type *out
+)
+{
+	static thread_local std::vector<score_type> prev, cur;
+
+	for (std::size_t first = 0; first < num_settings; first += SWEEP_LANES) {
+		std::size_t count = std::min<std::size_t>(num_settings - first, SWEEP_LANES);
+
+		// the last group is padded with copies of its last setting
+		ScoringParams lanes[SWEEP_LANES];
+		score_type max_scores[SWEEP_LANES];
+
+		for (std::size_t k = 0; k < SWEEP_LANES; k++) {
+			lanes[k] = settings[first + std::min(k, count - 1)];
+		}
+
+		sweep_lanes<ScoringPolicy>(seq_ver, seq_hor, lanes, max_scores, prev, cur);
+		std::copy(max_scores, max_scores + count, out + first);
+	}
+}
+
+void sweep_align_row(
+	SeqView seq_ver,
+	const SequenceStore &seqs_hor,
+	seq_count_type first_hor,
+	seq_count_type last_hor,
+	const std::vector<ScoringParams> &settings,
+	score_type *const *out
+)
+{
+	std::vector<score_type> scores(settings.size());
+	std::uint64_t len_hor = seqs_hor.total_length(first_hor, last_hor);
+
+	PhaseTimer timer(PHASE_COMPUTE, seq_ver.length * len_hor * settings.size());
+
+	for (seq_count_type j = first_hor; j < last_hor; j++) {
+		sweep_score<SCORING_POLICY>(seq_ver, seqs_hor[j], settings.data(), settings.size(), scores.data());
+
+		for (std::size_t k = 0; k < settings.size(); k++) {
+			out[k][j - first_hor] = scores[k];
+		}
+	}
+}
+
+#define INSTANTIATE_SWEEP_SCORE(policy) \
+	template void sweep_score<policy>(SeqView, SeqView, const ScoringParams *, std::size_t, score_type *)
+
+INSTANTIATE_SWEEP_SCORE(SquaredDistanceScore);
+INSTANTIATE_SWEEP_SCORE(PhiWeightedScore);
+INSTANTIATE_SWEEP_SCORE(CosineScore);
+INSTANTIATE_SWEEP_SCORE(TableScore);
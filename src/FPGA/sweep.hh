@@ -0,0 +1,52 @@
+//
+// sweep.hh
+//
+// Scores under several scoring settings in a single pass over the data
+//
+// Created on 18/10/2026
+//
+
+#ifndef SWPARA_SWEEP_HH
+#define SWPARA_SWEEP_HH
+
+#include <vector>
+#include <cstddef>
+
+#include "align.hh"
+#include "seq_store.hh"
+
+
+// Settings are evaluated in groups of this many, one per vector lane
+#define SWEEP_LANES 8
+
+struct ScoringParams {
+	score_type scoring_offset;
+	score_type gap_penalty;
+};
+
+// Smith-Waterman score of one pair under every setting: every cell of the
+// matrix holds one accumulator per setting, and the residues of the cell
+// are loaded (and their angle differences computed) only once for all of
+// them. The score under settings[k] goes to out[k].
+// Instantiated for every scoring policy of scoring.hh.
+template<typename ScoringPolicy>
+void sweep_score(
+	SeqView seq_ver,
+	SeqView seq_hor,
+	const ScoringParams *settings,
+	std::size_t num_settings,
+	score_type *out
+);
+
+// sweep_score() with SCORING_POLICY of one vertical sequence against sequences
+// [first_hor, last_hor) of 'seqs_hor'; scores under settings[k] go to out[k][0...).
+void sweep_align_row(
+	SeqView seq_ver,
+	const SequenceStore &seqs_hor,
+	seq_count_type first_hor,
+	seq_count_type last_hor,
+	const std::vector<ScoringParams> &settings,
+	score_type *const *out
+);
+
+#endif // SWPARA_SWEEP_HH
@@ -0,0 +1,495 @@
+//
+// swpara.cc
+//
+// Public API of the alignment library
+//
+// Created on 18/10/2026
+//
+
+#include <vector>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <exception>
+#include <stdexcept>
+#include <type_traits>
+#include <algorithm>
+#include <memory>
+
+#include "swpara.hh"
+#include "align.hh"
+#include "engines.hh"
+#include "seq_store.hh"
+#include "numa.hh"
+#include "triangle.hh"
+
+
+static_assert(std::is_same<swpara::angle_type, ::angle_type>::value, "API angle type must match the kernel");
+static_assert(std::is_same<swpara::index_type, ::index_type>::value, "API length type must match the kernel");
+static_assert(std::is_same<swpara::score_type, ::score_type>::value, "API score type must match the kernel");
+static_assert(std::is_same<swpara::seq_count_type, ::seq_count_type>::value, "API count type must match the kernel");
+static_assert(swpara::full_band == FULL_BAND, "API full band must match the kernel");
+
+// Rows computed but not yet handed to a callback, per worker
+static const std::size_t rows_in_flight_per_thread = 4;
+
+namespace swpara {
+
+// Views of the caller's sequences, without copying any angles.
+// SeqView promises padding up to padded_length(), which caller arrays
+// don't have; but only the engines that don't rely on it are used here.
+// Sequences longer than MAX_SEQ_SIZE are scored without a band only.
+static std::vector<SeqView> make_views(const Sequences &seqs, index_type band_width)
+{
+	std::vector<SeqView> views(seqs.num_seqs);
+	std::size_t offset = 0;
+
+	for (seq_count_type i = 0; i < seqs.num_seqs; i++) {
+		index_type length = seqs.lengths[i];
+
+		if (length < 0) {
+			throw std::invalid_argument("length of sequence #" + std::to_string(i) + " (" + std::to_string(length) + ") is negative");
+		}
+
+		if (length > MAX_SEQ_SIZE && band_width != FULL_BAND) {
+			throw std::invalid_argument(
+				"length of sequence #" + std::to_string(i) + " (" + std::to_string(length) + ") "
+				"is out of range [0, " + std::to_string(MAX_SEQ_SIZE) + "] of banded mode"
+			);
+		}
+
+		views[i] = SeqView { seqs.phi + offset, seqs.psi + offset, length };
+		offset += length;
+	}
+
+	return views;
+}
+
+static void check_params(const Params &params)
+{
+	if (!boundary_deltas_fit(params.scoring_offset, params.gap_penalty)) {
+		throw std::invalid_argument("scoring offset and gap penalty are out of range of the boundary deltas");
+	}
+
+	if (!band_supported(params.band_width)) {
+		throw std::invalid_argument("banded mode is not supported with compressed boundaries");
+	}
+}
+
+// Number of cells of a 'rows' x 'cols' matrix within the band
+static std::uint64_t band_cells(std::uint64_t rows, std::uint64_t cols, index_type band_width)
+{
+	// cells of row r of an m x n matrix right of the band: max(0, k - r), with k = n - band_width - 1
+	auto right_of_band = [=](std::uint64_t m, std::uint64_t n) -> std::uint64_t {
+		if (n <= std::uint64_t(band_width) + 1) {
+			return 0;
+		}
+
+		std::uint64_t k = n - band_width - 1;
+		std::uint64_t t = std::min(m, k);
+		return t * k - t * (t - 1) / 2;
+	};
+
+	if (band_width < 0) {
+		return rows * cols;
+	}
+
+	return rows * cols - right_of_band(rows, cols) - right_of_band(cols, rows);
+}
+
+static unsigned num_threads(const Params &params)
+{
+	return params.num_threads > 0 ? params.num_threads : std::max(1u, std::thread::hardware_concurrency());
+}
+
+static unsigned num_workers(const Params &params, seq_count_type num_rows)
+{
+	return std::max<unsigned>(1, std::min<seq_count_type>(num_threads(params), num_rows));
+}
+
+// Threads of wavefront_score() for every pair longer than MAX_SEQ_SIZE:
+// those that the rows leave idle, since each worker scores its own pairs
+static unsigned pair_threads(const Params &params, const WorkerPlacement &placement)
+{
+	unsigned workers = 0;
+
+	for (unsigned n : placement.workers) {
+		workers += n;
+	}
+
+	return std::max(1u, num_threads(params) / std::max(1u, workers));
+}
+
+// Views of sequences for the workers of every node: on NUMA hosts, a
+// replica in the local memory of each node, made by a thread on that node,
+// since every sequence is read many times; otherwise the caller's arrays.
+struct NodeViews {
+	std::unique_ptr<StoreReplicas> replicas;
+	std::vector<std::vector<SeqView>> views; // per node
+
+	NodeViews(const Sequences &seqs, const WorkerPlacement &placement, index_type band_width) :
+		views(placement.nodes.size(), make_views(seqs, band_width))
+	{
+		if (!placement.is_numa()) {
+			return;
+		}
+
+		replicas.reset(new StoreReplicas(placement, std::vector<index_type>(seqs.lengths, seqs.lengths + seqs.num_seqs)));
+
+		run_on_nodes(placement, [&](std::size_t node) {
+			replicas->sync(node, seqs.num_seqs, views[node]);
+
+			for (seq_count_type i = 0; i < seqs.num_seqs; i++) {
+				views[node][i] = (*replicas)[node][i];
+			}
+		});
+	}
+};
+
+// Row #i of a job: vertical sequence #i against a contiguous range of horizontal ones
+struct RowJob {
+	const NodeViews &ver;
+	const NodeViews &hor;
+	seq_count_type num_rows;
+	seq_count_type (*first_col)(seq_count_type row); // of the row, among 'hor'
+	seq_count_type num_cols;                          // of the whole job
+	score_type scoring_offset;
+	score_type gap_penalty;
+	index_type band_width;
+	unsigned pair_threads; // for pairs longer than MAX_SEQ_SIZE
+
+	seq_count_type row_size(seq_count_type row) const { return num_cols - first_col(row); }
+
+	// on a worker of 'node'
+	void align_row(seq_count_type row, std::size_t node, score_type *out, bool *touched_edges) const
+	{
+		seq_count_type first = first_col(row);
+		const SeqView *hor_views = hor.views[node].data();
+
+		align_row_any_length(
+			ver.views[node][row],
+			hor_views + first,
+			num_cols - first,
+			scoring_offset,
+			gap_penalty,
+			out,
+			band_width,
+			touched_edges,
+			pair_threads
+		);
+	}
+
+	// Cells of rows [0, i) at index i
+	std::vector<std::uint64_t> cumulative_cells() const
+	{
+		const SeqView *ver_views = ver.views[0].data();
+		const SeqView *hor_views = hor.views[0].data();
+		std::vector<std::uint64_t> cumulative(num_rows + 1, 0);
+
+		if (band_width >= 0) {
+			for (seq_count_type row = 0; row < num_rows; row++) {
+				cumulative[row + 1] = cumulative[row];
+
+				for (seq_count_type col = first_col(row); col < num_cols; col++) {
+					cumulative[row + 1] += band_cells(ver_views[row].length, hor_views[col].length, band_width);
+				}
+			}
+
+			return cumulative;
+		}
+
+		// suffix sums of the horizontal lengths
+		std::vector<std::uint64_t> hor_length(num_cols + 1, 0);
+
+		for (seq_count_type j = num_cols; j > 0; j--) {
+			hor_length[j - 1] = hor_length[j] + hor_views[j - 1].length;
+		}
+
+		for (seq_count_type row = 0; row < num_rows; row++) {
+			cumulative[row + 1] = cumulative[row] + ver_views[row].length * hor_length[first_col(row)];
+		}
+
+		return cumulative;
+	}
+
+	std::uint64_t num_cells() const { return cumulative_cells().back(); }
+};
+
+static seq_count_type triangle_first_col(seq_count_type row) { return row + 1; }
+static seq_count_type rectangle_first_col(seq_count_type) { return 0; }
+
+// Every worker claims the next row of its node's share of the job (a
+// contiguous range of rows with cells in proportion to its workers), and
+// writes its scores to 'scores' + 'row_offset(row)', and its band edge
+// flags likewise to 'touched_edges' unless it's nullptr
+template<typename RowOffset>
+static void run_rows(const RowJob &job, const WorkerPlacement &placement, score_type *scores, bool *touched_edges, RowOffset row_offset)
+{
+	std::vector<RowRange> shares(1, RowRange { 0, job.num_rows });
+
+	if (placement.is_numa()) {
+		shares = split_rows(job.cumulative_cells(), placement.workers);
+	}
+
+	std::unique_ptr<std::atomic<seq_count_type>[]> next_row(new std::atomic<seq_count_type>[shares.size()]);
+	std::exception_ptr error;
+	std::mutex error_mutex;
+
+	for (std::size_t node = 0; node < shares.size(); node++) {
+		next_row[node].store(shares[node].begin);
+	}
+
+	auto worker = [&](unsigned index) {
+		std::size_t node = placement.node_of(index);
+
+		try {
+			pin_to_node(placement, node);
+
+			for (seq_count_type row; (row = next_row[node].fetch_add(1)) < shares[node].end; ) {
+				std::uint64_t offset = row_offset(row);
+				job.align_row(row, node, scores + offset, touched_edges ? touched_edges + offset : nullptr);
+			}
+		} catch (...) {
+			std::lock_guard<std::mutex> lock(error_mutex);
+			error = std::current_exception();
+
+			for (std::size_t k = 0; k < shares.size(); k++) {
+				next_row[k].store(shares[k].end);
+			}
+		}
+	};
+
+	std::vector<std::thread> threads;
+	unsigned num_threads = 0;
+
+	for (unsigned workers : placement.workers) {
+		num_threads += workers;
+	}
+
+	// the calling thread isn't pinned on NUMA hosts
+	for (unsigned t = placement.is_numa() ? 0 : 1; t < num_threads; t++) {
+		threads.emplace_back(worker, t);
+	}
+
+	if (!placement.is_numa()) {
+		worker(0);
+	}
+
+	for (std::thread &thread : threads) {
+		thread.join();
+	}
+
+	if (error) {
+		std::rethrow_exception(error);
+	}
+}
+
+// Rows are computed into a ring of slots and handed to 'callback' in order;
+// workers don't claim a row until its slot has been handed over. Rows are
+// claimed in order across nodes too, but workers read their node's views.
+static void run_rows(const RowJob &job, const WorkerPlacement &placement, const RowCallback &callback)
+{
+	unsigned num_threads = 0;
+
+	for (unsigned workers : placement.workers) {
+		num_threads += workers;
+	}
+
+	const seq_count_type window = num_threads * rows_in_flight_per_thread;
+
+	std::vector<std::vector<score_type>> slots(window);
+	std::vector<bool> ready(window, false);
+	seq_count_type next_row = 0;
+	seq_count_type delivered = 0;
+	bool stop = false;
+	std::exception_ptr error;
+	std::mutex mutex;
+	std::condition_variable changed;
+
+	auto worker = [&](unsigned index) {
+		std::size_t node = placement.node_of(index);
+		pin_to_node(placement, node);
+
+		std::unique_lock<std::mutex> lock(mutex);
+
+		for (;;) {
+			changed.wait(lock, [&]() { return stop || next_row >= job.num_rows || next_row < delivered + window; });
+
+			if (stop || next_row >= job.num_rows) {
+				return;
+			}
+
+			seq_count_type row = next_row++;
+			std::vector<score_type> &slot = slots[row % window];
+
+			lock.unlock();
+
+			try {
+				slot.resize(job.row_size(row));
+				job.align_row(row, node, slot.data(), nullptr);
+			} catch (...) {
+				lock.lock();
+				error = std::current_exception();
+				stop = true;
+				changed.notify_all();
+				return;
+			}
+
+			lock.lock();
+			ready[row % window] = true;
+			changed.notify_all();
+		}
+	};
+
+	std::vector<std::thread> threads;
+
+	for (unsigned t = 0; t < num_threads; t++) {
+		threads.emplace_back(worker, t);
+	}
+
+	try {
+		std::unique_lock<std::mutex> lock(mutex);
+
+		while (delivered < job.num_rows) {
+			changed.wait(lock, [&]() { return stop || ready[delivered % window]; });
+
+			if (stop) {
+				break;
+			}
+
+			// The callback runs unlocked; no worker touches a ready slot
+			std::vector<score_type> &slot = slots[delivered % window];
+
+			lock.unlock();
+			callback(delivered, slot.data(), slot.size());
+			lock.lock();
+
+			ready[delivered % window] = false;
+			delivered++;
+			changed.notify_all();
+		}
+	} catch (...) {
+		std::lock_guard<std::mutex> lock(mutex);
+		error = std::current_exception();
+		stop = true;
+		changed.notify_all();
+	}
+
+	for (std::thread &thread : threads) {
+		thread.join();
+	}
+
+	if (error) {
+		std::rethrow_exception(error);
+	}
+}
+
+std::uint64_t triangle_size(seq_count_type num_seqs)
+{
+	return num_seqs > 0 ? std::uint64_t(num_seqs) * (num_seqs - 1) / 2 : 0;
+}
+
+std::uint64_t align_all_vs_all(const Sequences &seqs, const Params &params, score_type *scores, bool *touched_edges)
+{
+	check_params(params);
+
+	seq_count_type n = seqs.num_seqs;
+	WorkerPlacement placement = place_workers(num_workers(params, n > 0 ? n - 1 : 0));
+	NodeViews views(seqs, placement, params.band_width);
+	RowJob job {
+		views, views, n > 0 ? n - 1 : 0, triangle_first_col, n,
+		params.scoring_offset, params.gap_penalty, params.band_width, pair_threads(params, placement)
+	};
+
+	// row #i starts after rows [0, i), which have n - 1, n - 2, ... scores
+	run_rows(job, placement, scores, touched_edges, [&](seq_count_type row) {
+		return triangle_size(n) - triangle_size(n - row);
+	});
+
+	return job.num_cells();
+}
+
+std::uint64_t align_all_vs_all(const Sequences &seqs, const Params &params, const RowCallback &callback)
+{
+	check_params(params);
+
+	seq_count_type n = seqs.num_seqs;
+	WorkerPlacement placement = place_workers(num_workers(params, n > 0 ? n - 1 : 0));
+	NodeViews views(seqs, placement, params.band_width);
+	RowJob job {
+		views, views, n > 0 ? n - 1 : 0, triangle_first_col, n,
+		params.scoring_offset, params.gap_penalty, params.band_width, pair_threads(params, placement)
+	};
+
+	run_rows(job, placement, callback);
+
+	return job.num_cells();
+}
+
+std::uint64_t align_many_vs_many(
+	const Sequences &queries,
+	const Sequences &targets,
+	const Params &params,
+	score_type *scores,
+	bool *touched_edges
+)
+{
+	check_params(params);
+
+	WorkerPlacement placement = place_workers(num_workers(params, queries.num_seqs));
+	NodeViews ver(queries, placement, params.band_width);
+	NodeViews hor(targets, placement, params.band_width);
+	RowJob job {
+		ver, hor, queries.num_seqs, rectangle_first_col, targets.num_seqs,
+		params.scoring_offset, params.gap_penalty, params.band_width, pair_threads(params, placement)
+	};
+
+	run_rows(job, placement, scores, touched_edges, [&](seq_count_type row) {
+		return std::uint64_t(row) * targets.num_seqs;
+	});
+
+	return job.num_cells();
+}
+
+std::uint64_t align_many_vs_many(const Sequences &queries, const Sequences &targets, const Params &params, const RowCallback &callback)
+{
+	check_params(params);
+
+	WorkerPlacement placement = place_workers(num_workers(params, queries.num_seqs));
+	NodeViews ver(queries, placement, params.band_width);
+	NodeViews hor(targets, placement, params.band_width);
+	RowJob job {
+		ver, hor, queries.num_seqs, rectangle_first_col, targets.num_seqs,
+		params.scoring_offset, params.gap_penalty, params.band_width, pair_threads(params, placement)
+	};
+
+	run_rows(job, placement, callback);
+
+	return job.num_cells();
+}
+
+score_type align_pair(
+	const angle_type *phi_ver,
+	const angle_type *psi_ver,
+	index_type length_ver,
+	const angle_type *phi_hor,
+	const angle_type *psi_hor,
+	index_type length_hor,
+	const Params &params,
+	bool *touched_edge
+)
+{
+	check_params(params);
+
+	std::vector<SeqView> ver = make_views(Sequences { phi_ver, psi_ver, &length_ver, 1 }, params.band_width);
+	std::vector<SeqView> hor = make_views(Sequences { phi_hor, psi_hor, &length_hor, 1 }, params.band_width);
+	score_type score = 0;
+
+	align_row_any_length(ver[0], hor.data(), 1, params.scoring_offset, params.gap_penalty, &score, params.band_width, touched_edge, num_threads(params));
+
+	return score;
+}
+
+} // namespace swpara
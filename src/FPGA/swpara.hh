@@ -0,0 +1,101 @@
+//
+// swpara.hh
+//
+// Public API of the alignment library (libswpara.a / libswpara.so):
+// in-process all-vs-all and many-vs-many alignment of sequences that
+// the caller already holds in memory, without any serialization.
+// This header only depends on the standard library.
+//
+// Created on 18/10/2026
+//
+
+#ifndef SWPARA_SWPARA_HH
+#define SWPARA_SWPARA_HH
+
+#include <functional>
+#include <cstdint>
+
+
+namespace swpara {
+
+// The same as the types of align.hh
+typedef std::int16_t  angle_type;
+typedef std::int16_t  index_type;
+typedef std::int32_t  score_type;
+typedef std::uint32_t seq_count_type;
+
+// A caller-owned database in structure-of-arrays layout: sequence #i has
+// lengths[i] residues, and its angles follow those of sequence #i-1 in
+// both 'phi' and 'psi'. The arrays are only read, and need no alignment
+// or padding; they must outlive the call they are passed to.
+struct Sequences {
+	const angle_type *phi;
+	const angle_type *psi;
+	const index_type *lengths;
+	seq_count_type num_seqs;
+};
+
+// Computes the whole matrix of every pair; see Params::band_width
+const index_type full_band = -1;
+
+struct Params {
+	score_type scoring_offset;
+	score_type gap_penalty;
+	unsigned num_threads; // 0: one per hardware thread
+
+	// Banded mode: with band_width >= 0, only alignments that stay within
+	// band_width residues of the main diagonal of a pair are scored, i.e.
+	// cells of row r and column c with |r - c| <= band_width. If the best
+	// cell of a pair lies on the edge of the band, a wider band may score
+	// higher; the entry points below can report that for every pair.
+	index_type band_width = full_band;
+};
+
+// Receives the scores of row #'row', 'count' of them, which are only valid during the call
+typedef std::function<void(seq_count_type row, const score_type *scores, seq_count_type count)> RowCallback;
+
+// Number of scores of the all-vs-all triangle of 'num_seqs' sequences
+std::uint64_t triangle_size(seq_count_type num_seqs);
+
+// Scores every pair i < j of 'seqs'. Row #i (the scores of sequence #i
+// against #i+1...n-1) follows row #i-1 in 'scores', which must hold
+// triangle_size(seqs.num_seqs) scores; or each row is handed to 'callback'
+// in order, on the calling thread, while later rows are being computed.
+// In banded mode, 'touched_edges' (unless it's nullptr) receives whether
+// the best cell of each pair lies on the edge of the band, like 'scores'.
+// Sequences longer than the kernel takes (MAX_SEQ_SIZE of align.hh) are
+// scored pair by pair, each on the threads that the rows leave idle; they
+// have no banded mode. Throws std::invalid_argument if a length or a
+// parameter is out of range. Returns the number of dynamic programming
+// cells computed.
+std::uint64_t align_all_vs_all(const Sequences &seqs, const Params &params, score_type *scores, bool *touched_edges = nullptr);
+std::uint64_t align_all_vs_all(const Sequences &seqs, const Params &params, const RowCallback &callback);
+
+// Scores every query against every target: row #i holds the scores of
+// query #i against all targets, so 'scores' must hold
+// queries.num_seqs * targets.num_seqs scores. Otherwise as above.
+std::uint64_t align_many_vs_many(
+	const Sequences &queries,
+	const Sequences &targets,
+	const Params &params,
+	score_type *scores,
+	bool *touched_edges = nullptr
+);
+std::uint64_t align_many_vs_many(const Sequences &queries, const Sequences &targets, const Params &params, const RowCallback &callback);
+
+// Score of a single pair, on the calling thread; or if a sequence is
+// longer than MAX_SEQ_SIZE, on params.num_threads threads
+score_type align_pair(
+	const angle_type *phi_ver,
+	const angle_type *psi_ver,
+	index_type length_ver,
+	const angle_type *phi_hor,
+	const angle_type *psi_hor,
+	index_type length_hor,
+	const Params &params,
+	bool *touched_edge = nullptr
+);
+
+} // namespace swpara
+
+#endif // SWPARA_SWPARA_HH
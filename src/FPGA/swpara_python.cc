@@ -0,0 +1,355 @@
+//
+// swpara_python.cc
+//
+// Python extension module over the library API (swpara.hh).
+// Angle and length arrays are taken through the buffer protocol
+// without copying, and scores are computed straight into the memory of
+// the NumPy array returned, with the GIL released. Only NumPy's Python
+// interface is used, so no NumPy headers are needed to build this.
+//
+//     import numpy, swpara
+//     scores = swpara.align_all_vs_all(phi, psi, lengths, 65536, -4000)
+//
+// Created on 18/10/2026
+//
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include <string>
+#include <cstring>
+#include <stdexcept>
+
+#include "swpara.hh"
+
+
+// A buffer acquired from a Python object, released when it goes out of scope
+class Buffer {
+public:
+	Buffer() : acquired_(false) {}
+
+	~Buffer()
+	{
+		if (acquired_) {
+			PyBuffer_Release(&view_);
+		}
+	}
+
+	Buffer(const Buffer &) = delete;
+	Buffer &operator=(const Buffer &) = delete;
+
+	bool acquire(PyObject *obj, int flags)
+	{
+		acquired_ = PyObject_GetBuffer(obj, &view_, flags) == 0;
+		return acquired_;
+	}
+
+	const Py_buffer &view() const { return view_; }
+
+private:
+	Py_buffer view_;
+	bool acquired_;
+};
+
+static_assert(sizeof(swpara::score_type) == 4, "scores are returned as int32 arrays");
+static_assert(sizeof(bool) == 1, "band edge flags are returned as NumPy bool arrays");
+
+// struct module format of int16 in explicit native byte order
+#if PY_LITTLE_ENDIAN
+static const char native_int16_format[] = "<h";
+#else
+static const char native_int16_format[] = ">h";
+#endif
+
+static PyObject *numpy_module = nullptr;
+
+// One-dimensional, contiguous array of native int16
+static bool get_int16_array(PyObject *obj, const char *name, Buffer &buf)
+{
+	// anything that can't be read in place is refused, rather than copied
+	if (!buf.acquire(obj, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT)) {
+		PyErr_Clear();
+		PyErr_Format(PyExc_TypeError, "'%s' must be a contiguous one-dimensional int16 array", name);
+		return false;
+	}
+
+	const char *format = buf.view().format;
+	bool is_int16 = std::strcmp(format, "h") == 0
+		|| std::strcmp(format, "=h") == 0
+		|| std::strcmp(format, native_int16_format) == 0;
+
+	if (buf.view().ndim != 1 || buf.view().itemsize != sizeof(swpara::angle_type) || !is_int16) {
+		PyErr_Format(PyExc_TypeError, "'%s' must be a contiguous one-dimensional int16 array", name);
+		return false;
+	}
+
+	return true;
+}
+
+// Sequences over the memory of three arrays; checks that the angle arrays cover the lengths
+static bool get_sequences(PyObject *phi, PyObject *psi, PyObject *lengths, Buffer bufs[3], swpara::Sequences &seqs)
+{
+	if (!get_int16_array(phi, "phi", bufs[0]) || !get_int16_array(psi, "psi", bufs[1]) || !get_int16_array(lengths, "lengths", bufs[2])) {
+		return false;
+	}
+
+	seqs.phi = static_cast<const swpara::angle_type *>(bufs[0].view().buf);
+	seqs.psi = static_cast<const swpara::angle_type *>(bufs[1].view().buf);
+	seqs.lengths = static_cast<const swpara::index_type *>(bufs[2].view().buf);
+	seqs.num_seqs = bufs[2].view().shape[0];
+
+	Py_ssize_t total_length = 0;
+
+	// negative lengths are reported by the library
+	for (swpara::seq_count_type i = 0; i < seqs.num_seqs; i++) {
+		total_length += seqs.lengths[i] > 0 ? seqs.lengths[i] : 0;
+	}
+
+	if (bufs[0].view().shape[0] < total_length || bufs[1].view().shape[0] < total_length) {
+		PyErr_Format(PyExc_ValueError, "the sequences have %zd residues, but there are fewer angles", total_length);
+		return false;
+	}
+
+	return true;
+}
+
+// A new, uninitialized NumPy array of 'shape' and 'dtype', and its writable buffer
+static PyObject *new_array(PyObject *shape, const char *dtype, Buffer &buf)
+{
+	PyObject *array = PyObject_CallMethod(numpy_module, "empty", "Os", shape, dtype);
+
+	if (array == nullptr) {
+		return nullptr;
+	}
+
+	if (!buf.acquire(array, PyBUF_C_CONTIGUOUS | PyBUF_WRITABLE)) {
+		Py_DECREF(array);
+		return nullptr;
+	}
+
+	return array;
+}
+
+// Runs 'align' without the GIL, and turns exceptions into Python ones
+template<typename Align>
+static bool run_unlocked(Align align)
+{
+	std::string error;
+	bool invalid = false;
+
+	Py_BEGIN_ALLOW_THREADS
+
+	try {
+		align();
+	} catch (const std::invalid_argument &ex) {
+		error = ex.what();
+		invalid = true;
+	} catch (const std::exception &ex) {
+		error = ex.what();
+	}
+
+	Py_END_ALLOW_THREADS
+
+	if (!error.empty()) {
+		PyErr_SetString(invalid ? PyExc_ValueError : PyExc_RuntimeError, error.c_str());
+		return false;
+	}
+
+	return true;
+}
+
+static PyObject *py_triangle_size(PyObject *, PyObject *args)
+{
+	unsigned long num_seqs = 0;
+
+	if (!PyArg_ParseTuple(args, "k", &num_seqs)) {
+		return nullptr;
+	}
+
+	return PyLong_FromUnsignedLongLong(swpara::triangle_size(num_seqs));
+}
+
+// The int32 score array of 'shape', and if 'return_edges', the bool array
+// of band edge flags of the same shape; nullptr in results[1] otherwise
+static bool new_results(PyObject *shape, bool return_edges, Buffer &scores_buf, Buffer &edges_buf, PyObject *results[2])
+{
+	results[0] = shape ? new_array(shape, "int32", scores_buf) : nullptr;
+	results[1] = results[0] && return_edges ? new_array(shape, "bool", edges_buf) : nullptr;
+	Py_XDECREF(shape);
+
+	if (results[0] == nullptr || (return_edges && results[1] == nullptr)) {
+		Py_XDECREF(results[0]);
+		return false;
+	}
+
+	return true;
+}
+
+// The scores, or a tuple of the scores and the band edge flags; steals the references
+static PyObject *result_value(PyObject *results[2])
+{
+	return results[1] ? Py_BuildValue("(NN)", results[0], results[1]) : results[0];
+}
+
+static PyObject *py_align_all_vs_all(PyObject *, PyObject *args, PyObject *kwargs)
+{
+	static const char *keywords[] = {
+		"phi", "psi", "lengths", "scoring_offset", "gap_penalty", "threads", "band_width", "return_edges", nullptr
+	};
+
+	PyObject *phi, *psi, *lengths;
+	swpara::Params params = { 0, 0, 0 };
+	int return_edges = 0;
+
+	if (!PyArg_ParseTupleAndKeywords(
+		args, kwargs, "OOOii|Ihp", const_cast<char **>(keywords),
+		&phi, &psi, &lengths, &params.scoring_offset, &params.gap_penalty, &params.num_threads,
+		&params.band_width, &return_edges
+	)) {
+		return nullptr;
+	}
+
+	Buffer bufs[3], out, edges;
+	swpara::Sequences seqs;
+	PyObject *results[2];
+
+	if (!get_sequences(phi, psi, lengths, bufs, seqs)) {
+		return nullptr;
+	}
+
+	PyObject *shape = Py_BuildValue("(K)", static_cast<unsigned long long>(swpara::triangle_size(seqs.num_seqs)));
+
+	if (!new_results(shape, return_edges, out, edges, results)) {
+		return nullptr;
+	}
+
+	auto align = [&]() {
+		swpara::align_all_vs_all(
+			seqs,
+			params,
+			static_cast<swpara::score_type *>(out.view().buf),
+			return_edges ? static_cast<bool *>(edges.view().buf) : nullptr
+		);
+	};
+
+	if (!run_unlocked(align)) {
+		Py_DECREF(results[0]);
+		Py_XDECREF(results[1]);
+		return nullptr;
+	}
+
+	return result_value(results);
+}
+
+static PyObject *py_align_many_vs_many(PyObject *, PyObject *args, PyObject *kwargs)
+{
+	static const char *keywords[] = {
+		"query_phi", "query_psi", "query_lengths",
+		"target_phi", "target_psi", "target_lengths",
+		"scoring_offset", "gap_penalty", "threads", "band_width", "return_edges", nullptr
+	};
+
+	PyObject *q_phi, *q_psi, *q_lengths, *t_phi, *t_psi, *t_lengths;
+	swpara::Params params = { 0, 0, 0 };
+	int return_edges = 0;
+
+	if (!PyArg_ParseTupleAndKeywords(
+		args, kwargs, "OOOOOOii|Ihp", const_cast<char **>(keywords),
+		&q_phi, &q_psi, &q_lengths, &t_phi, &t_psi, &t_lengths,
+		&params.scoring_offset, &params.gap_penalty, &params.num_threads,
+		&params.band_width, &return_edges
+	)) {
+		return nullptr;
+	}
+
+	Buffer q_bufs[3], t_bufs[3], out, edges;
+	swpara::Sequences queries, targets;
+	PyObject *results[2];
+
+	if (!get_sequences(q_phi, q_psi, q_lengths, q_bufs, queries) || !get_sequences(t_phi, t_psi, t_lengths, t_bufs, targets)) {
+		return nullptr;
+	}
+
+	PyObject *shape = Py_BuildValue("(kk)", static_cast<unsigned long>(queries.num_seqs), static_cast<unsigned long>(targets.num_seqs));
+
+	if (!new_results(shape, return_edges, out, edges, results)) {
+		return nullptr;
+	}
+
+	auto align = [&]() {
+		swpara::align_many_vs_many(
+			queries,
+			targets,
+			params,
+			static_cast<swpara::score_type *>(out.view().buf),
+			return_edges ? static_cast<bool *>(edges.view().buf) : nullptr
+		);
+	};
+
+	if (!run_unlocked(align)) {
+		Py_DECREF(results[0]);
+		Py_XDECREF(results[1]);
+		return nullptr;
+	}
+
+	return result_value(results);
+}
+
+static PyMethodDef methods[] = {
+	{
+		"triangle_size",
+		py_triangle_size,
+		METH_VARARGS,
+		"triangle_size(num_seqs)\n\n"
+		"Number of scores of the all-vs-all triangle of num_seqs sequences."
+	},
+	{
+		"align_all_vs_all",
+		reinterpret_cast<PyCFunction>(reinterpret_cast<void (*)()>(py_align_all_vs_all)),
+		METH_VARARGS | METH_KEYWORDS,
+		"align_all_vs_all(phi, psi, lengths, scoring_offset, gap_penalty, threads=0,\n"
+		"                 band_width=-1, return_edges=False)\n\n"
+		"Scores of every pair i < j, as a one-dimensional int32 array: row #i\n"
+		"(sequence #i against #i+1...n-1) follows row #i-1. 'phi' and 'psi' hold\n"
+		"the int16 angles of all sequences back to back, 'lengths' the int16\n"
+		"length of each. threads=0 uses every core; the GIL is released.\n"
+		"With band_width >= 0, only cells within that many residues of the main\n"
+		"diagonal are computed; return_edges=True also returns a bool array of\n"
+		"whether the best cell of each pair lies on the edge of the band."
+	},
+	{
+		"align_many_vs_many",
+		reinterpret_cast<PyCFunction>(reinterpret_cast<void (*)()>(py_align_many_vs_many)),
+		METH_VARARGS | METH_KEYWORDS,
+		"align_many_vs_many(query_phi, query_psi, query_lengths,\n"
+		"                   target_phi, target_psi, target_lengths,\n"
+		"                   scoring_offset, gap_penalty, threads=0,\n"
+		"                   band_width=-1, return_edges=False)\n\n"
+		"Scores of every query against every target, as a two-dimensional\n"
+		"int32 array of shape (number of queries, number of targets)."
+	},
+	{ nullptr, nullptr, 0, nullptr }
+};
+
+static struct PyModuleDef module = {
+	PyModuleDef_HEAD_INIT,
+	"swpara",
+	"Parallel Smith-Waterman alignment of protein backbone dihedral sequences",
+	-1,
+	methods,
+	nullptr,
+	nullptr,
+	nullptr,
+	nullptr
+};
+
+PyMODINIT_FUNC PyInit_swpara()
+{
+	numpy_module = PyImport_ImportModule("numpy");
+
+	if (numpy_module == nullptr) {
+		return nullptr;
+	}
+
+	return PyModule_Create(&module);
+}
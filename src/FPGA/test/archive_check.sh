@@ -0,0 +1,39 @@
+#!/bin/sh
+#
+# Packs databases into compressed archives and checks that aligning
+# an archive gives the same scores as aligning the raw file, both in one
+# block and in small blocks (which decode sequences out of order), and
+# that a damaged archive is rejected. Uncorrelated angles exercise the
+# raw fallback of the archive, random walks the delta coding.
+#
+# usage: test/archive_check.sh [num_seqs]
+# (from src/FPGA, after `make align pack_seqs gen_random_seqs`)
+#
+
+. "$(dirname "$0")/common.sh"
+
+NUM_SEQS=${1:-200}
+
+for STEP in 0 40 2000; do
+	gen_seqs "$TMP/INPUT.BIN" --count "$NUM_SEQS" --seed 43 --max-len 512 --related-frac 0.2 --walk-step "$STEP"
+
+	./pack_seqs "$TMP/INPUT.BIN" "$TMP/INPUT.SWZ"
+
+	align_ref "$TMP/INPUT.BIN" "$TMP/RAW.BIN"
+	align_ref "$TMP/INPUT.SWZ" "$TMP/ARCHIVE.BIN"
+	align_ref "$TMP/INPUT.SWZ" "$TMP/BLOCKED.BIN" --memory-budget 0
+
+	cmp "$TMP/RAW.BIN" "$TMP/ARCHIVE.BIN"
+	cmp "$TMP/RAW.BIN" "$TMP/BLOCKED.BIN"
+
+	# an archive cut short must not be aligned
+	SIZE=$(wc -c < "$TMP/INPUT.SWZ")
+	head -c $((SIZE - 1)) "$TMP/INPUT.SWZ" > "$TMP/TRUNCATED.SWZ"
+
+	if align_ref "$TMP/TRUNCATED.SWZ" "$TMP/TRUNCATED.BIN"; then
+		echo "truncated archive was accepted"
+		exit 1
+	fi
+done
+
+echo "archive check passed ($NUM_SEQS sequences)"
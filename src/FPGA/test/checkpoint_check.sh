@@ -0,0 +1,43 @@
+#!/bin/sh
+#
+# Interrupts a checkpointed run several times with SIGKILL, resumes it
+# until it completes, and checks that the result is byte-identical
+# to an uninterrupted run.
+#
+# usage: test/checkpoint_check.sh [num_seqs]
+# (from src/FPGA, after `make align gen_random_seqs`)
+#
+
+. "$(dirname "$0")/common.sh"
+
+NUM_SEQS=${1:-300}
+
+gen_seqs "$TMP/INPUT.BIN" --count "$NUM_SEQS" --seed 34 --max-len 200 --dup-frac 0.1
+
+align_ref "$TMP/INPUT.BIN" "$TMP/FULL.BIN"
+
+# small memory budget: many row blocks; checkpoint after every row
+RUN="./align 65536 -4000 --input $TMP/INPUT.BIN --output $TMP/OUTPUT.BIN --memory-budget 0
+	--checkpoint $TMP/CHECKPOINT --checkpoint-interval 0"
+
+attempts=0
+until filter_stderr '^(Resuming|Checkpoints)' timeout -s KILL 1 $RUN; do
+	attempts=$((attempts + 1))
+	test -f "$TMP/CHECKPOINT" || test $attempts -lt 3
+	test ! -f "$TMP/CHECKPOINT" || cp "$TMP/CHECKPOINT" "$TMP/STALE"
+done
+
+test ! -f "$TMP/CHECKPOINT"
+
+cmp "$TMP/FULL.BIN" "$TMP/OUTPUT.BIN"
+
+# a checkpoint doesn't resume an input with the same lengths but other dihedrals
+if test -f "$TMP/STALE"; then
+	cp "$TMP/INPUT.BIN" "$TMP/CHANGED.BIN"
+	printf '\177' | dd of="$TMP/CHANGED.BIN" bs=1 seek=$(($(wc -c < "$TMP/INPUT.BIN") - 1)) conv=notrunc 2>/dev/null
+
+	./align 65536 -4000 --input "$TMP/CHANGED.BIN" --output "$TMP/CHANGED.OUT" --checkpoint "$TMP/STALE" 2>"$TMP/ERR" && exit 1
+	grep -q 'belongs to a different run' "$TMP/ERR"
+fi
+
+echo "checkpoint check passed ($attempts interruptions)"
@@ -0,0 +1,46 @@
+#!/bin/sh
+#
+# Clusters a database on the fly and checks the result against
+# clusters computed from the full score matrix.
+#
+# usage: test/cluster_check.sh [num_seqs] [threshold]
+# (from src/FPGA, after `make align gen_random_seqs`)
+#
+
+. "$(dirname "$0")/common.sh"
+
+NUM_SEQS=${1:-150}
+THRESHOLD=${2:-300000}
+
+gen_seqs "$TMP/INPUT.BIN" --count "$NUM_SEQS" --seed 36 --max-len 128 --dup-frac 0.2 --related-frac 0.3
+
+# on one thread, and on several that unite clusters concurrently
+for THREADS in 1 4; do
+	filter_stderr '^Clusters' ./align 65536 -4000 --input "$TMP/INPUT.BIN" --memory-budget 0 --threads "$THREADS" --cluster "$THRESHOLD" --output "$TMP/CLUSTERS.$THREADS.txt"
+done
+
+# the same clustering, from the text dump of the whole triangle
+./align 65536 -4000 --input "$TMP/INPUT.BIN" 2>/dev/null | awk -v n="$NUM_SEQS" -v t="$THRESHOLD" '
+	function find(x) { while (parent[x] != x) x = parent[x]; return x }
+	BEGIN { for (i = 0; i < n; i++) parent[i] = i }
+	/^#/ {
+		i = substr($1, 2) + 0
+		for (k = 2; k <= NF; k++) {
+			if ($k + 0 >= t) {
+				a = find(i); b = find(i + k - 1)
+				if (a < b) parent[b] = a; else parent[a] = b
+			}
+		}
+	}
+	END {
+		for (i = 0; i < n; i++) {
+			r = find(i)
+			if (r == i) id[i] = num_clusters++
+			print i, id[r], r
+		}
+	}
+' > "$TMP/EXPECTED.txt"
+
+cmp "$TMP/EXPECTED.txt" "$TMP/CLUSTERS.1.txt"
+cmp "$TMP/EXPECTED.txt" "$TMP/CLUSTERS.4.txt"
+echo "cluster check passed ($NUM_SEQS sequences, threshold $THRESHOLD)"
@@ -0,0 +1,46 @@
+#
+# common.sh
+#
+# Setup and helpers shared by the checks; sourced by them from src/FPGA.
+# Every check gets a temporary directory $TMP, removed on exit, and the
+# sequence generator, which is built once by `make gen_random_seqs`.
+#
+# Created on 18/10/2026
+#
+
+set -e
+
+GEN=./gen_random_seqs
+TMP=$(mktemp -d)
+trap 'rm -rf "$TMP"' EXIT
+
+if [ ! -x "$GEN" ]; then
+	echo "$GEN not found, run \`make gen_random_seqs\` first" >&2
+	exit 1
+fi
+
+# gen_seqs FILE [genseq options]...
+gen_seqs() {
+	"$GEN" genseq "$@"
+}
+
+# align_ref INPUT OUTPUT [align options]...: the scores that the others
+# are compared against, with the default parameters and no diagnostics
+align_ref() {
+	input=$1
+	output=$2
+	shift 2
+	./align 65536 -4000 --input "$input" --output "$output" "$@" 2>/dev/null
+}
+
+# filter_stderr PATTERN COMMAND [args]...: runs the command with only the
+# lines of its stderr that match the extended regex PATTERN passed on to
+# stdout, and returns its exit status (which a pipe to grep would lose)
+filter_stderr() {
+	pattern=$1
+	shift
+	{
+		status=$({ { "$@" 2>&1 >&3 3>&- 4>&-; echo $? >&4; } | grep -E "$pattern" >&3 || true; } 4>&1)
+	} 3>&1
+	return "$status"
+}
@@ -0,0 +1,239 @@
+//
+// library_check.cc
+//
+// Aligns a binary INPUT.BIN through the public API of libswpara,
+// checks the entry points against each other, and writes the triangle
+// in the OUTPUT.BIN layout for comparison with `align`.
+//
+// usage: library_check INPUT.BIN OUTPUT.BIN
+//
+// Created on 18/10/2026
+//
+
+#include <vector>
+#include <stdexcept>
+#include <algorithm>
+#include <memory>
+#include <cstdio>
+#include <cstdlib>
+
+#include "swpara.hh"
+
+
+using namespace swpara;
+
+struct Database {
+	std::vector<angle_type> phi;
+	std::vector<angle_type> psi;
+	std::vector<index_type> lengths;
+
+	Sequences all() const { return { phi.data(), psi.data(), lengths.data(), seq_count_type(lengths.size()) }; }
+};
+
+static Database read_database(const char *path)
+{
+	std::FILE *file = std::fopen(path, "rb");
+	Database db;
+	seq_count_type num_seqs = 0;
+	std::size_t total_length = 0;
+
+	if (file == nullptr || std::fread(&num_seqs, sizeof num_seqs, 1, file) != 1) {
+		throw std::runtime_error("can't read sequence count");
+	}
+
+	db.lengths.resize(num_seqs);
+
+	if (std::fread(db.lengths.data(), sizeof db.lengths[0], num_seqs, file) != num_seqs) {
+		throw std::runtime_error("can't read sequence lengths");
+	}
+
+	for (index_type length : db.lengths) {
+		total_length += length;
+	}
+
+	// phi, psi pairs on disk
+	std::vector<angle_type> data(2 * total_length);
+
+	if (std::fread(data.data(), sizeof data[0], data.size(), file) != data.size()) {
+		throw std::runtime_error("can't read sequence data");
+	}
+
+	std::fclose(file);
+
+	for (std::size_t k = 0; k < total_length; k++) {
+		db.phi.push_back(data[2 * k]);
+		db.psi.push_back(data[2 * k + 1]);
+	}
+
+	return db;
+}
+
+static void check(bool condition, const char *what)
+{
+	if (!condition) {
+		throw std::runtime_error(what);
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	if (argc != 3) {
+		std::fprintf(stderr, "usage: %s INPUT.BIN OUTPUT.BIN\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	try {
+		Database db = read_database(argv[1]);
+		Sequences seqs = db.all();
+		Params params = { 65536, -4000, 3 };
+
+		// the whole triangle into one buffer
+		std::vector<score_type> triangle(triangle_size(seqs.num_seqs));
+		std::uint64_t num_cells = align_all_vs_all(seqs, params, triangle.data());
+
+		// the same, row by row, written out as OUTPUT.BIN
+		std::FILE *out = std::fopen(argv[2], "wb");
+		std::size_t offset = 0;
+
+		check(out != nullptr && std::fwrite(&seqs.num_seqs, sizeof seqs.num_seqs, 1, out) == 1, "can't write output");
+
+		align_all_vs_all(seqs, params, [&](seq_count_type row, const score_type *scores, seq_count_type count) {
+			check(count == seqs.num_seqs - 1 - row, "wrong row size");
+
+			for (seq_count_type j = 0; j < count; j++) {
+				check(scores[j] == triangle[offset + j], "callback and buffer scores differ");
+			}
+
+			check(std::fwrite(scores, sizeof scores[0], count, out) == count, "can't write output");
+			offset += count;
+		});
+
+		check(std::fclose(out) == 0 && offset == triangle.size(), "can't write output");
+
+		// the first few sequences as queries against the whole database
+		Sequences queries = seqs;
+		queries.num_seqs = std::min<seq_count_type>(seqs.num_seqs, 8);
+
+		std::vector<score_type> rectangle(std::size_t(queries.num_seqs) * seqs.num_seqs);
+		align_many_vs_many(queries, seqs, params, rectangle.data());
+
+		for (seq_count_type i = 0, row_offset = 0; i < queries.num_seqs; row_offset += seqs.num_seqs - 1 - i, i++) {
+			for (seq_count_type j = i + 1; j < seqs.num_seqs; j++) {
+				check(rectangle[std::size_t(i) * seqs.num_seqs + j] == triangle[row_offset + j - i - 1], "many-vs-many and all-vs-all scores differ");
+			}
+		}
+
+		if (seqs.num_seqs >= 2) {
+			score_type score = align_pair(
+				db.phi.data(), db.psi.data(), db.lengths[0],
+				db.phi.data() + db.lengths[0], db.psi.data() + db.lengths[0], db.lengths[1],
+				params
+			);
+
+			check(score == triangle[0], "pair and all-vs-all scores differ");
+		}
+
+		// a band wider than any sequence is the same as the whole matrix
+		Params wide = params;
+		wide.band_width = 512;
+
+		std::vector<score_type> wide_triangle(triangle.size());
+		std::unique_ptr<bool[]> wide_edges(new bool[triangle.size()]);
+		check(align_all_vs_all(seqs, wide, wide_triangle.data(), wide_edges.get()) == num_cells, "wide band cell count differs");
+		check(wide_triangle == triangle, "wide band and full scores differ");
+		check(std::count(wide_edges.get(), wide_edges.get() + triangle.size(), true) == 0, "wide band touched its edge");
+
+		// a narrow band computes fewer cells, and never scores higher
+		Params narrow = params;
+		narrow.band_width = 8;
+
+		std::vector<score_type> narrow_triangle(triangle.size());
+		std::unique_ptr<bool[]> narrow_edges(new bool[triangle.size()]);
+		check(align_all_vs_all(seqs, narrow, narrow_triangle.data(), narrow_edges.get()) < num_cells, "narrow band computed every cell");
+
+		for (std::size_t k = 0; k < triangle.size(); k++) {
+			check(narrow_triangle[k] <= triangle[k], "narrow band scored higher");
+		}
+
+		if (seqs.num_seqs >= 2) {
+			bool touched_edge = false;
+			score_type score = align_pair(
+				db.phi.data(), db.psi.data(), db.lengths[0],
+				db.phi.data() + db.lengths[0], db.psi.data() + db.lengths[0], db.lengths[1],
+				narrow,
+				&touched_edge
+			);
+
+			check(score == narrow_triangle[0] && touched_edge == narrow_edges[0], "banded pair and all-vs-all results differ");
+		}
+
+		// A sequence longer than the kernel takes: the first few back to back,
+		// which scores at least as high against any sequence as its parts do
+		seq_count_type num_parts = 0;
+		index_type long_length = 0;
+		bool rejected = false;
+
+		while (num_parts < seqs.num_seqs && long_length <= 512) {
+			long_length += db.lengths[num_parts++];
+		}
+
+		if (long_length > 512) {
+			Sequences long_seq = { db.phi.data(), db.psi.data(), &long_length, 1 };
+			std::vector<score_type> long_scores(seqs.num_seqs);
+			align_many_vs_many(long_seq, seqs, params, long_scores.data());
+
+			for (seq_count_type j = 0, offset_j = 0; j < seqs.num_seqs; offset_j += db.lengths[j], j++) {
+				for (seq_count_type i = 0; i < num_parts; i++) {
+					seq_count_type a = std::min(i, j), b = std::max(i, j);
+					std::uint64_t k = triangle_size(seqs.num_seqs) - triangle_size(seqs.num_seqs - a) + b - a - 1;
+
+					check(a == b || long_scores[j] >= triangle[k], "long sequence scored lower than its part");
+				}
+
+				// on one thread, and on several
+				Params pair_params = params;
+				pair_params.num_threads = 1 + j % 3;
+
+				score_type score = align_pair(
+					db.phi.data(), db.psi.data(), long_length,
+					db.phi.data() + offset_j, db.psi.data() + offset_j, db.lengths[j],
+					pair_params
+				);
+
+				check(score == long_scores[j], "long pair and many-vs-many scores differ");
+			}
+
+			try {
+				align_many_vs_many(long_seq, seqs, narrow, long_scores.data());
+			} catch (const std::invalid_argument &) {
+				rejected = true;
+			}
+
+			check(rejected, "long sequence was accepted in banded mode");
+		}
+
+		// out-of-range lengths are rejected
+		index_type bad_length = -1;
+		rejected = false;
+
+		try {
+			align_all_vs_all(Sequences { db.phi.data(), db.psi.data(), &bad_length, 1 }, params, triangle.data());
+		} catch (const std::invalid_argument &) {
+			rejected = true;
+		}
+
+		check(rejected, "negative length was accepted");
+
+		std::fprintf(
+			stderr,
+			"%lu sequences, %llu cells\n",
+			static_cast<unsigned long>(seqs.num_seqs),
+			static_cast<unsigned long long>(num_cells)
+		);
+	} catch (const std::exception &ex) {
+		std::fprintf(stderr, "error: %s\n", ex.what());
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
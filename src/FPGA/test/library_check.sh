@@ -0,0 +1,26 @@
+#!/bin/sh
+#
+# Builds a program against the shared library and its public header only,
+# and checks that its scores are identical to those of `align`.
+#
+# usage: test/library_check.sh [num_seqs]
+# (from src/FPGA, after `make align libswpara.so gen_random_seqs`)
+#
+
+. "$(dirname "$0")/common.sh"
+
+NUM_SEQS=${1:-150}
+
+gen_seqs "$TMP/INPUT.BIN" --count "$NUM_SEQS" --seed 44 --max-len 256 --related-frac 0.2
+
+c++ -std=c++17 -O2 -pthread -I. -o "$TMP/library_check" test/library_check.cc -L. -lswpara -Wl,-rpath,"$(pwd)"
+
+align_ref "$TMP/INPUT.BIN" "$TMP/ALIGN.BIN"
+"$TMP/library_check" "$TMP/INPUT.BIN" "$TMP/LIBRARY.BIN"
+
+cmp "$TMP/ALIGN.BIN" "$TMP/LIBRARY.BIN"
+
+# NUMA placement (per-node replicas and shares of the triangle), on any host
+SWPARA_NUMA_NODES=3 "$TMP/library_check" "$TMP/INPUT.BIN" "$TMP/LIBRARY_NUMA.BIN"
+cmp "$TMP/ALIGN.BIN" "$TMP/LIBRARY_NUMA.BIN"
+echo "library check passed ($NUM_SEQS sequences)"
@@ -15,28 +15,201 @@ typedef struct Dihedral {
 } Dihedral;
 
 
-static void generate(FILE *file);
+// Near-duplicates are copies of an earlier sequence with a few point
+// changes; related sequences share ancestry, but diverge much more.
+enum SeqKind {
+    SEQ_RANDOM,
+    SEQ_NEAR_DUP,
+    SEQ_RELATED
+};
+
+enum LengthDist {
+    DIST_UNIFORM, // [min_len, max_len]
+    DIST_FIXED,   // always max_len
+    DIST_NORMAL   // mean_len +/- sd_len, clamped to [min_len, max_len]
+};
+
+typedef struct GenOptions {
+    seq_count_type num_seqs;
+    uint64_t seed;
+    enum LengthDist dist;
+    index_type min_len;
+    index_type max_len;
+    double mean_len;
+    double sd_len;
+    double dup_frac;      // fraction of near-duplicate sequences
+    double related_frac;  // fraction of related sequences
+    double mutation_rate; // per-residue substitution rate of related sequences
+    int walk_step;        // max. angle change between residues of random sequences; 0: independent
+} GenOptions;
+
+// Random stream: splitmix64, so that output only depends on the seed,
+// and not on the platform's C library.
+typedef struct Rng {
+    uint64_t state;
+} Rng;
+
+// Earlier sequences that near-duplicates and related sequences are derived from.
+// A bounded ring of recent sequences keeps memory usage independent of the count.
+#define POOL_SIZE 4096
+
+typedef struct SeqPool {
+    Dihedral *data;          // POOL_SIZE slots of max_len dihedrals each
+    index_type *lengths;
+    size_t max_len;
+    seq_count_type count;    // number of sequences ever added
+} SeqPool;
+
+// Large buffered writes, independent of stdio's buffer size
+#define OUT_BUF_SIZE (4u << 20)
+
+typedef struct OutBuf {
+    FILE *file;
+    unsigned char *data;
+    size_t size;
+    int error;
+} OutBuf;
+
+// Mutation parameters of near-duplicates
+#define DUP_MUTATION_RATE 0.01
+#define DUP_NOISE 256            // max. angle noise (1/65536 turn units), ~1.4 degrees
+#define RELATED_NOISE 2048       // ~11 degrees
+#define INDEL_RATE_RATIO 0.1     // indel rate relative to the substitution rate
+
+
+static int generate(FILE *file, const GenOptions *opts);
 static void dump_seq(FILE *file);
 static void dump_score(FILE *file);
 
 
+static void usage(const char *progname)
+{
+    fprintf(stderr, "usage: %s [genseq | dumpseq | dumpscore] <file>\n", progname);
+    fprintf(stderr, "genseq options:\n");
+    fprintf(stderr, "    --count N            number of sequences (default: 1000)\n");
+    fprintf(stderr, "    --seed N             random seed (default: 1)\n");
+    fprintf(stderr, "    --dist D             uniform, fixed or normal (default: uniform)\n");
+    fprintf(stderr, "    --min-len N          (default: 0)\n");
+    fprintf(stderr, "    --max-len N          (default: 511)\n");
+    fprintf(stderr, "    --mean-len X         for the normal distribution (default: 250)\n");
+    fprintf(stderr, "    --sd-len X           for the normal distribution (default: 80)\n");
+    fprintf(stderr, "    --dup-frac F         fraction of near-duplicates (default: 0)\n");
+    fprintf(stderr, "    --related-frac F     fraction of related sequences (default: 0)\n");
+    fprintf(stderr, "    --mutation-rate R    substitution rate of related sequences (default: 0.3)\n");
+    fprintf(stderr, "    --walk-step N        random sequences are random walks with steps of\n");
+    fprintf(stderr, "                         at most N (1/65536 turn units) (default: 0, uncorrelated)\n");
+}
+
+static int parse_gen_options(int argc, char *argv[], GenOptions *opts)
+{
+    opts->num_seqs = 1000;
+    opts->seed = 1;
+    opts->dist = DIST_UNIFORM;
+    opts->min_len = 0;
+    opts->max_len = 511;
+    opts->mean_len = 250;
+    opts->sd_len = 80;
+    opts->dup_frac = 0;
+    opts->related_frac = 0;
+    opts->mutation_rate = 0.3;
+    opts->walk_step = 0;
+
+    for (int i = 0; i < argc; i += 2) {
+        if (i + 1 >= argc) {
+            return 0;
+        }
+
+        const char *name = argv[i];
+        const char *value = argv[i + 1];
+
+        if (strcmp(name, "--count") == 0) {
+            opts->num_seqs = strtoul(value, NULL, 10);
+        } else if (strcmp(name, "--seed") == 0) {
+            opts->seed = strtoull(value, NULL, 0);
+        } else if (strcmp(name, "--dist") == 0) {
+            if (strcmp(value, "uniform") == 0) {
+                opts->dist = DIST_UNIFORM;
+            } else if (strcmp(value, "fixed") == 0) {
+                opts->dist = DIST_FIXED;
+            } else if (strcmp(value, "normal") == 0) {
+                opts->dist = DIST_NORMAL;
+            } else {
+                return 0;
+            }
+        } else if (strcmp(name, "--min-len") == 0) {
+            opts->min_len = strtol(value, NULL, 10);
+        } else if (strcmp(name, "--max-len") == 0) {
+            opts->max_len = strtol(value, NULL, 10);
+        } else if (strcmp(name, "--mean-len") == 0) {
+            opts->mean_len = strtod(value, NULL);
+        } else if (strcmp(name, "--sd-len") == 0) {
+            opts->sd_len = strtod(value, NULL);
+        } else if (strcmp(name, "--dup-frac") == 0) {
+            opts->dup_frac = strtod(value, NULL);
+        } else if (strcmp(name, "--related-frac") == 0) {
+            opts->related_frac = strtod(value, NULL);
+        } else if (strcmp(name, "--mutation-rate") == 0) {
+            opts->mutation_rate = strtod(value, NULL);
+        } else if (strcmp(name, "--walk-step") == 0) {
+            opts->walk_step = atoi(value);
+        } else {
+            return 0;
+        }
+    }
+
+    return opts->min_len >= 0
+        && opts->min_len <= opts->max_len
+        && opts->dup_frac >= 0
+        && opts->related_frac >= 0
+        && opts->dup_frac + opts->related_frac <= 1;
+}
+
 int main(int argc, char *argv[])
 {
     if (argc < 3) {
-        fprintf(stderr, "usage: %s [genseq | dumpseq | dumpscore] <file>\n", argv[0]);
+        usage(argv[0]);
         return -1;
     }
 
     if (strcmp(argv[1], "genseq") == 0) {
+        GenOptions opts;
+
+        if (!parse_gen_options(argc - 3, argv + 3, &opts)) {
+            usage(argv[0]);
+            return -1;
+        }
+
         FILE *file = fopen(argv[2], "wb");
-        generate(file);
-        fclose(file);
+
+        if (file == NULL) {
+            perror(argv[2]);
+            return -1;
+        }
+
+        int ok = generate(file, &opts);
+
+        if (fclose(file) != 0 || !ok) {
+            fprintf(stderr, "Can't write %s\n", argv[2]);
+            return -1;
+        }
     } else if (strcmp(argv[1], "dumpseq") == 0) {
         FILE *file = fopen(argv[2], "rb");
+
+        if (file == NULL) {
+            perror(argv[2]);
+            return -1;
+        }
+
         dump_seq(file);
         fclose(file);
     } else if (strcmp(argv[1], "dumpscore") == 0) {
         FILE *file = fopen(argv[2], "rb");
+
+        if (file == NULL) {
+            perror(argv[2]);
+            return -1;
+        }
+
         dump_score(file);
         fclose(file);
     } else {
@@ -47,36 +220,269 @@ int main(int argc, char *argv[])
     return 0;
 }
 
-static void generate(FILE *file)
+static uint64_t rng_next(Rng *rng)
 {
-    seq_count_type num_seqs = arc4random_uniform(999) + 2; // 2...1000 sequences
-    index_type seq_lens[num_seqs];
+    uint64_t z = (rng->state += 0x9e3779b97f4a7c15ull);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
 
-    for (seq_count_type i = 0; i < num_seqs; i++) {
-        seq_lens[i] = arc4random_uniform(512); // sequences of maximal length 511
+// Uniform in [0, n), without modulo bias
+static uint64_t rng_uniform(Rng *rng, uint64_t n)
+{
+    uint64_t limit = UINT64_MAX - UINT64_MAX % n;
+    uint64_t x;
+
+    do {
+        x = rng_next(rng);
+    } while (x >= limit);
+
+    return x % n;
+}
+
+// Uniform in [0, 1)
+static double rng_double(Rng *rng)
+{
+    return (rng_next(rng) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// Approximately standard normal (Irwin-Hall), using no libm functions,
+// so that the result is bit-identical on every IEEE-754 platform
+static double rng_normal(Rng *rng)
+{
+    double sum = 0;
+
+    for (int i = 0; i < 12; i++) {
+        sum += rng_double(rng);
+    }
+
+    return sum - 6;
+}
+
+static angle_type random_angle(Rng *rng)
+{
+    return (angle_type)(uint16_t)rng_next(rng); // full turn: -32768...32767
+}
+
+static angle_type perturb_angle(Rng *rng, angle_type angle, int max_noise)
+{
+    int noise = (int)rng_uniform(rng, 2 * max_noise + 1) - max_noise;
+    return (angle_type)(uint16_t)((uint16_t)angle + noise); // wraps around the turn
+}
+
+static index_type random_length(Rng *rng, const GenOptions *opts)
+{
+    switch (opts->dist) {
+    case DIST_FIXED:
+        return opts->max_len;
+    case DIST_NORMAL: {
+        double len = opts->mean_len + opts->sd_len * rng_normal(rng) + 0.5;
+        len = len < opts->min_len ? opts->min_len : len;
+        len = len > opts->max_len ? opts->max_len : len;
+        return (index_type)len;
+    }
+    case DIST_UNIFORM:
+    default:
+        return opts->min_len + (index_type)rng_uniform(rng, opts->max_len - opts->min_len + 1);
+    }
+}
+
+// Copy 'src' into 'dst' with substitutions, small angle noise and indels.
+// Returns the length of the derived sequence, at most 'max_len'.
+static index_type mutate(
+    Rng *rng,
+    const Dihedral *src,
+    index_type src_len,
+    Dihedral *dst,
+    index_type max_len,
+    double rate,
+    int max_noise
+)
+{
+    double indel_rate = rate * INDEL_RATE_RATIO;
+    index_type len = 0;
+
+    for (index_type k = 0; k < src_len && len < max_len; k++) {
+        double r = rng_double(rng);
+
+        if (r < indel_rate / 2) {
+            continue; // deletion
+        }
+
+        if (r < indel_rate) {
+            Dihedral ins = { random_angle(rng), random_angle(rng) };
+            dst[len++] = ins; // insertion before the current residue
+
+            if (len == max_len) {
+                break;
+            }
+        }
+
+        Dihedral d = src[k];
+
+        if (rng_double(rng) < rate) {
+            d.phi = random_angle(rng);
+            d.psi = random_angle(rng);
+        } else {
+            d.phi = perturb_angle(rng, d.phi, max_noise);
+            d.psi = perturb_angle(rng, d.psi, max_noise);
+        }
+
+        dst[len++] = d;
+    }
+
+    return len;
+}
+
+static int out_write(OutBuf *out, const void *buf, size_t size)
+{
+    const unsigned char *bytes = buf;
+
+    while (size > 0 && !out->error) {
+        size_t chunk = OUT_BUF_SIZE - out->size;
+        chunk = chunk < size ? chunk : size;
+
+        memcpy(out->data + out->size, bytes, chunk);
+        out->size += chunk;
+        bytes += chunk;
+        size -= chunk;
+
+        if (out->size == OUT_BUF_SIZE) {
+            out->error = fwrite(out->data, 1, out->size, out->file) != out->size;
+            out->size = 0;
+        }
     }
 
-    fwrite(&num_seqs, sizeof num_seqs, 1, file);
-    fwrite(seq_lens, sizeof seq_lens[0], num_seqs, file);
+    return !out->error;
+}
+
+static int out_flush(OutBuf *out)
+{
+    if (!out->error && out->size > 0) {
+        out->error = fwrite(out->data, 1, out->size, out->file) != out->size;
+        out->size = 0;
+    }
+
+    return !out->error;
+}
+
+static enum SeqKind random_kind(Rng *rng, const GenOptions *opts, const SeqPool *pool)
+{
+    if (pool->count == 0) {
+        return SEQ_RANDOM;
+    }
+
+    double r = rng_double(rng);
+
+    if (r < opts->dup_frac) {
+        return SEQ_NEAR_DUP;
+    }
+
+    if (r < opts->dup_frac + opts->related_frac) {
+        return SEQ_RELATED;
+    }
+
+    return SEQ_RANDOM;
+}
+
+// Generate the next sequence into the next slot of the pool
+static index_type generate_seq(Rng *rng, const GenOptions *opts, SeqPool *pool)
+{
+    enum SeqKind kind = random_kind(rng, opts, pool);
+    size_t slot = pool->count % POOL_SIZE;
+    Dihedral *seq = pool->data + slot * pool->max_len;
+    index_type len = 0;
+
+    if (kind == SEQ_RANDOM) {
+        len = random_length(rng, opts);
+
+        for (index_type k = 0; k < len; k++) {
+            if (opts->walk_step > 0 && k > 0) {
+                // autocorrelated, like the backbone of real chains
+                seq[k].phi = perturb_angle(rng, seq[k - 1].phi, opts->walk_step);
+                seq[k].psi = perturb_angle(rng, seq[k - 1].psi, opts->walk_step);
+            } else {
+                seq[k].phi = random_angle(rng);
+                seq[k].psi = random_angle(rng);
+            }
+        }
+    } else {
+        // any of the most recent sequences, except the one in the slot being overwritten
+        seq_count_type num_sources = pool->count < POOL_SIZE - 1 ? pool->count : POOL_SIZE - 1;
+        size_t src_slot = (pool->count - 1 - rng_uniform(rng, num_sources)) % POOL_SIZE;
+        const Dihedral *src = pool->data + src_slot * pool->max_len;
+        double rate = kind == SEQ_NEAR_DUP ? DUP_MUTATION_RATE : opts->mutation_rate;
+        int noise = kind == SEQ_NEAR_DUP ? DUP_NOISE : RELATED_NOISE;
+
+        len = mutate(rng, src, pool->lengths[src_slot], seq, opts->max_len, rate, noise);
+    }
+
+    pool->lengths[slot] = len;
+    pool->count++;
+
+    return len;
+}
+
+// INPUT.BIN layout: seq_count_type count, index_type lengths, then the data.
+// Lengths are only known after generation, so they are filled in at the end.
+static int generate(FILE *file, const GenOptions *opts)
+{
+    Rng rng = { opts->seed };
+    SeqPool pool = { NULL, NULL, opts->max_len > 0 ? opts->max_len : 1, 0 };
+    OutBuf out = { file, NULL, 0, 0 };
+    seq_count_type num_seqs = opts->num_seqs;
+    index_type *seq_lens = calloc(num_seqs > 0 ? num_seqs : 1, sizeof seq_lens[0]);
+    int ok = 0;
+
+    pool.data = malloc(POOL_SIZE * pool.max_len * sizeof pool.data[0]);
+    pool.lengths = malloc(POOL_SIZE * sizeof pool.lengths[0]);
+    out.data = malloc(OUT_BUF_SIZE);
+
+    if (seq_lens == NULL || pool.data == NULL || pool.lengths == NULL || out.data == NULL) {
+        fprintf(stderr, "Out of memory\n");
+        goto cleanup;
+    }
+
+    out_write(&out, &num_seqs, sizeof num_seqs);
+    out_write(&out, seq_lens, (size_t)num_seqs * sizeof seq_lens[0]);
 
     for (seq_count_type i = 0; i < num_seqs; i++) {
-        for (index_type j = 0; j < seq_lens[i]; j++) {
-            uint32_t tmp = arc4random();
-            angle_type low  = (tmp >>  0) & 0xffff; // -32768...32767
-            angle_type high = (tmp >> 16) & 0xffff; // -32768...32767
-            Dihedral d = { low, high };
-            fwrite(&d, sizeof d, 1, file);
+        seq_lens[i] = generate_seq(&rng, opts, &pool);
+        size_t slot = (pool.count - 1) % POOL_SIZE;
+
+        if (!out_write(&out, pool.data + slot * pool.max_len, seq_lens[i] * sizeof pool.data[0])) {
+            goto cleanup;
         }
     }
+
+    ok = out_flush(&out)
+      && fseek(file, sizeof num_seqs, SEEK_SET) == 0
+      && fwrite(seq_lens, sizeof seq_lens[0], num_seqs, file) == num_seqs;
+
+cleanup:
+    free(out.data);
+    free(pool.lengths);
+    free(pool.data);
+    free(seq_lens);
+
+    return ok;
 }
 
 static void dump_seq(FILE *file)
 {
     seq_count_type num_seqs = 0;
-    fread(&num_seqs, sizeof num_seqs, 1, file);
 
-    index_type seq_lens[num_seqs];
-    fread(seq_lens, sizeof seq_lens[0], num_seqs, file);
+    if (fread(&num_seqs, sizeof num_seqs, 1, file) != 1) {
+        return;
+    }
+
+    index_type *seq_lens = calloc(num_seqs > 0 ? num_seqs : 1, sizeof seq_lens[0]);
+
+    if (seq_lens == NULL || fread(seq_lens, sizeof seq_lens[0], num_seqs, file) != num_seqs) {
+        free(seq_lens);
+        return;
+    }
 
     printf("%lu\n", (unsigned long) num_seqs);
 
@@ -89,25 +495,39 @@ static void dump_seq(FILE *file)
     for (seq_count_type i = 0; i < num_seqs; i++) {
         for (index_type j = 0; j < seq_lens[i]; j++) {
             Dihedral d;
-            fread(&d, sizeof d, 1, file);
+
+            if (fread(&d, sizeof d, 1, file) != 1) {
+                free(seq_lens);
+                return;
+            }
+
             printf("%d %d      ", (int) d.phi, (int) d.psi);
         }
 
         printf("\n");
     }
+
+    free(seq_lens);
 }
 
 static void dump_score(FILE *file)
 {
     seq_count_type num_seqs = 0;
-    fread(&num_seqs, sizeof num_seqs, 1, file);
+
+    if (fread(&num_seqs, sizeof num_seqs, 1, file) != 1 || num_seqs < 2) {
+        return;
+    }
 
     for (seq_count_type i = 0; i < num_seqs - 1; i++) {
         printf("#%lu.\t", (unsigned long) i);
 
         for (seq_count_type j = i + 1; j < num_seqs; j++) {
             score_type next_score;
-            fread(&next_score, sizeof next_score, 1, file);
+
+            if (fread(&next_score, sizeof next_score, 1, file) != 1) {
+                return;
+            }
+
             printf(" %ld", (long) next_score);
         }
 
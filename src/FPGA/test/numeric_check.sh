@@ -0,0 +1,29 @@
+#!/bin/sh
+#
+# Runs the precision report on a small dataset, and checks that the
+# variants that are exact by construction score every pair exactly
+# like the int16/int32 kernel.
+#
+# usage: test/numeric_check.sh [num_seqs]
+# (from src/FPGA, after `make numeric_report`)
+#
+
+set -e
+
+NUM_SEQS=${1:-32}
+TMP=$(mktemp -d)
+trap 'rm -rf "$TMP"' EXIT
+
+./numeric_report --count "$NUM_SEQS" --max-len 128 --seed 47 \
+	--variant int17/int32 --variant fixed17/int32 --variant int16/int26 --variant int16/int64 \
+	> "$TMP/report.json"
+
+for VARIANT in int17/int32 fixed17/int32 int16/int26 int16/int64; do
+	if ! grep "\"name\": \"$VARIANT\"" "$TMP/report.json" | grep -q '"differing_pairs": 0,'; then
+		echo "$VARIANT deviates from the int16/int32 kernel:" >&2
+		cat "$TMP/report.json" >&2
+		exit 1
+	fi
+done
+
+echo "numeric check passed ($NUM_SEQS sequences)"
@@ -0,0 +1,43 @@
+#!/bin/sh
+#
+# Profiles a run on several threads, through the text pipeline and out of
+# core, and checks that the phase breakdown stays within the wall time:
+# every percentage is at most 100, though the phases overlap and the
+# compute timers of the threads add up to more.
+#
+# usage: test/profile_check.sh [num_seqs]
+# (from src/FPGA, after `make align gen_random_seqs`)
+#
+
+. "$(dirname "$0")/common.sh"
+
+NUM_SEQS=${1:-100}
+
+gen_seqs "$TMP/INPUT.BIN" --count "$NUM_SEQS" --seed 30 --max-len 256
+"$GEN" dumpseq "$TMP/INPUT.BIN" > "$TMP/INPUT.txt"
+
+./align 65536 -4000 --threads 4 --profile "$TMP/TEXT.json" < "$TMP/INPUT.txt" 2> "$TMP/TEXT.err" > /dev/null
+./align 65536 -4000 --threads 4 --profile "$TMP/BLOCKED.json" --input "$TMP/INPUT.BIN" --memory-budget 0 2> "$TMP/BLOCKED.err" > /dev/null
+
+for RUN in TEXT BLOCKED; do
+	# the rows of the table from "phase" to "total"
+	if ! awk '
+		/^phase / { table = 1; next }
+		table && /^total / { done = 1; exit }
+		table {
+			for (k = 1; k <= NF; k++) {
+				if ($k ~ /%$/) {
+					found++
+					if (substr($k, 1, length($k) - 1) + 0 > 100) over = 1
+				}
+			}
+		}
+		END { exit !(done && found == 4 && !over) }
+	' "$TMP/$RUN.err"; then
+		echo "the profile of the $RUN run exceeds the wall time:" >&2
+		cat "$TMP/$RUN.err" "$TMP/$RUN.json" >&2
+		exit 1
+	fi
+done
+
+echo "profile check passed ($NUM_SEQS sequences)"
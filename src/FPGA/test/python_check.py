@@ -0,0 +1,90 @@
+#!/usr/bin/env python3
+#
+# Aligns a binary INPUT.BIN through the Python module, checks the
+# entry points against each other and that the GIL is released,
+# and writes the triangle in the OUTPUT.BIN layout for comparison
+# with `align`.
+#
+# usage: python_check.py INPUT.BIN OUTPUT.BIN
+# (with the directory of the swpara module on PYTHONPATH)
+#
+# Created on 18/10/2026
+#
+
+import sys
+import threading
+import time
+import numpy
+import swpara
+
+
+def read_database(path):
+    with open(path, 'rb') as f:
+        num_seqs = int(numpy.fromfile(f, dtype=numpy.uint32, count=1)[0])
+        lengths = numpy.fromfile(f, dtype=numpy.int16, count=num_seqs)
+        data = numpy.fromfile(f, dtype=numpy.int16, count=2 * int(lengths.sum(dtype=numpy.int64)))
+
+    # phi, psi pairs on disk
+    return numpy.ascontiguousarray(data[0::2]), numpy.ascontiguousarray(data[1::2]), lengths
+
+
+def main():
+    phi, psi, lengths = read_database(sys.argv[1])
+    n = len(lengths)
+
+    scores = swpara.align_all_vs_all(phi, psi, lengths, 65536, -4000)
+    assert scores.dtype == numpy.int32 and scores.shape == (swpara.triangle_size(n),)
+
+    with open(sys.argv[2], 'wb') as f:
+        numpy.array([n], dtype=numpy.uint32).tofile(f)
+        scores.tofile(f)
+
+    # the first few sequences as queries against the whole database
+    q = min(n, 8)
+    q_len = int(lengths[:q].sum())
+    rect = swpara.align_many_vs_many(phi[:q_len], psi[:q_len], lengths[:q], phi, psi, lengths, 65536, -4000, threads=2)
+    assert rect.shape == (q, n)
+
+    offset = 0
+    for i in range(q):
+        assert (rect[i, i + 1:] == scores[offset:offset + n - 1 - i]).all(), "many-vs-many and all-vs-all scores differ"
+        offset += n - 1 - i
+
+    # banded mode: a band wider than any sequence is the whole matrix
+    wide, edges = swpara.align_all_vs_all(phi, psi, lengths, 65536, -4000, band_width=512, return_edges=True)
+    assert (wide == scores).all() and edges.dtype == numpy.bool_ and edges.shape == scores.shape and not edges.any()
+
+    narrow = swpara.align_all_vs_all(phi, psi, lengths, 65536, -4000, band_width=8)
+    assert (narrow <= scores).all(), "narrow band scored higher"
+
+    # arrays that would need a copy are refused
+    for bad in (phi[::2], phi.astype(numpy.int32)):
+        try:
+            swpara.align_all_vs_all(bad, psi, lengths, 65536, -4000)
+            raise AssertionError("array that needs a copy was accepted")
+        except TypeError:
+            pass
+
+    try:
+        swpara.align_all_vs_all(phi[:-1], psi, lengths, 65536, -4000)
+        raise AssertionError("short angle array was accepted")
+    except ValueError:
+        pass
+
+    # Python keeps running while the alignment does
+    ticks = 0
+    worker = threading.Thread(target=swpara.align_all_vs_all, args=(phi, psi, lengths, 65536, -4000))
+    worker.start()
+
+    while worker.is_alive():
+        ticks += 1
+        time.sleep(0.001)
+
+    worker.join()
+    assert ticks > 1, "the GIL was held during the alignment"
+
+    print("%d sequences, %d scores" % (n, len(scores)), file=sys.stderr)
+
+
+if __name__ == '__main__':
+    main()
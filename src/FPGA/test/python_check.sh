@@ -0,0 +1,26 @@
+#!/bin/sh
+#
+# Checks that the Python module gives the same scores as `align`.
+# Skipped if NumPy is not installed.
+#
+# usage: test/python_check.sh [num_seqs]
+# (from src/FPGA, after `make align python gen_random_seqs`)
+#
+
+. "$(dirname "$0")/common.sh"
+
+NUM_SEQS=${1:-150}
+PYTHON=${PYTHON:-python3}
+
+if ! "$PYTHON" -c 'import numpy' 2>/dev/null; then
+	echo "python check skipped (no NumPy)"
+	exit 0
+fi
+
+gen_seqs "$TMP/INPUT.BIN" --count "$NUM_SEQS" --seed 45 --max-len 256 --related-frac 0.2
+
+align_ref "$TMP/INPUT.BIN" "$TMP/ALIGN.BIN"
+PYTHONPATH=. "$PYTHON" test/python_check.py "$TMP/INPUT.BIN" "$TMP/PYTHON.BIN"
+
+cmp "$TMP/ALIGN.BIN" "$TMP/PYTHON.BIN"
+echo "python check passed ($NUM_SEQS sequences)"
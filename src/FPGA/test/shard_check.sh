@@ -0,0 +1,35 @@
+#!/bin/sh
+#
+# Runs a sharded job as several local processes, merges the shards
+# and checks that the result is identical to an unsharded run.
+#
+# usage: test/shard_check.sh [num_shards] [num_seqs]
+# (from src/FPGA, after `make align merge_shards gen_random_seqs`)
+#
+
+. "$(dirname "$0")/common.sh"
+
+NUM_SHARDS=${1:-4}
+NUM_SEQS=${2:-200}
+
+gen_seqs "$TMP/INPUT.BIN" --count "$NUM_SEQS" --seed 33 --max-len 128 --related-frac 0.2
+
+align_ref "$TMP/INPUT.BIN" "$TMP/FULL.BIN"
+
+PIDS=""
+k=0
+while [ $k -lt "$NUM_SHARDS" ]; do
+	filter_stderr '^Shard' ./align 65536 -4000 --input "$TMP/INPUT.BIN" --shard "$k/$NUM_SHARDS" --output "$TMP/SHARD_$k.BIN" &
+	PIDS="$PIDS $!"
+	k=$((k + 1))
+done
+
+for pid in $PIDS; do
+	wait "$pid"
+done
+
+# shards in reverse order, to check that the merge tool sorts them
+./merge_shards "$TMP/OUTPUT.BIN" $(ls "$TMP"/SHARD_*.BIN | sort -r)
+
+cmp "$TMP/FULL.BIN" "$TMP/OUTPUT.BIN"
+echo "shard check passed ($NUM_SHARDS shards, $NUM_SEQS sequences)"
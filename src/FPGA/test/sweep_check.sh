@@ -0,0 +1,28 @@
+#!/bin/sh
+#
+# Runs a parameter sweep in a single pass and checks that the score
+# matrix of every setting is identical to a separate run with it.
+#
+# usage: test/sweep_check.sh [num_seqs]
+# (from src/FPGA, after `make align gen_random_seqs`)
+#
+
+. "$(dirname "$0")/common.sh"
+
+NUM_SEQS=${1:-100}
+
+gen_seqs "$TMP/INPUT.BIN" --count "$NUM_SEQS" --seed 35 --max-len 128 --related-frac 0.3
+
+# ten settings: a full group of vector lanes plus a padded one
+SWEEP="65536:-1000,65536:-8000,100000:-4000,32768:-4000,1000000:-100,100:-50,0:-1,1048576:0,4096:-4096"
+
+filter_stderr '^Setting' ./align 65536 -4000 --input "$TMP/INPUT.BIN" --output "$TMP/SWEEP.BIN" --sweep "$SWEEP"
+
+k=0
+for setting in 65536:-4000 $(echo "$SWEEP" | tr ',' ' '); do
+	./align "${setting%%:*}" "${setting##*:}" --input "$TMP/INPUT.BIN" --output "$TMP/SINGLE.BIN" 2>/dev/null
+	cmp "$TMP/SINGLE.BIN" "$TMP/SWEEP.BIN.$k"
+	k=$((k + 1))
+done
+
+echo "sweep check passed ($k settings, $NUM_SEQS sequences)"
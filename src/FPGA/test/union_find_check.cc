@@ -0,0 +1,128 @@
+//
+// union_find_check.cc
+//
+// Unites random pairs of a ConcurrentUnionFind from several threads at
+// once, while they also look up random elements, and checks that the sets
+// and their representatives are those of a sequential union-find.
+//
+// usage: union_find_check [num_threads] [num_rounds]
+//
+// Created on 18/10/2026
+//
+
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <random>
+#include <utility>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+
+#include "cluster.hh"
+
+
+static const seq_count_type num_elements = 20000;
+static const std::size_t num_pairs = 15000;
+
+// Sets represented by their smallest element, like ConcurrentUnionFind
+static std::vector<seq_count_type> sequential_sets(const std::vector<std::pair<seq_count_type, seq_count_type>> &pairs)
+{
+	std::vector<seq_count_type> parent(num_elements);
+
+	for (seq_count_type x = 0; x < num_elements; x++) {
+		parent[x] = x;
+	}
+
+	auto find = [&](seq_count_type x) {
+		while (parent[x] != x) {
+			x = parent[x];
+		}
+
+		return x;
+	};
+
+	for (const std::pair<seq_count_type, seq_count_type> &pair : pairs) {
+		seq_count_type a = find(pair.first), b = find(pair.second);
+
+		if (a < b) {
+			parent[b] = a;
+		} else {
+			parent[a] = b;
+		}
+	}
+
+	for (seq_count_type x = 0; x < num_elements; x++) {
+		parent[x] = find(x);
+	}
+
+	return parent;
+}
+
+int main(int argc, char *argv[])
+{
+	unsigned num_threads = argc > 1 ? std::max(1ul, std::strtoul(argv[1], nullptr, 10)) : 4;
+	unsigned num_rounds = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 20;
+
+	for (unsigned round = 0; round < num_rounds; round++) {
+		std::mt19937_64 rng(round);
+		std::vector<std::pair<seq_count_type, seq_count_type>> pairs(num_pairs);
+
+		// a few large sets, so that threads often unite the same ones
+		for (std::pair<seq_count_type, seq_count_type> &pair : pairs) {
+			pair.first = rng() % num_elements;
+			pair.second = rng() % 8 == 0 ? rng() % 64 : rng() % num_elements;
+		}
+
+		ConcurrentUnionFind sets(num_elements);
+		std::atomic<unsigned> ready(0);
+		std::vector<std::thread> threads;
+
+		// thread #t unites every num_threads-th pair, in reverse on odd threads
+		for (unsigned t = 0; t < num_threads; t++) {
+			threads.emplace_back([&, t]() {
+				std::mt19937_64 lookups(round * num_threads + t);
+
+				// all at once
+				ready++;
+
+				while (ready.load() < num_threads) {
+					std::this_thread::yield();
+				}
+
+				std::size_t count = (num_pairs - t + num_threads - 1) / num_threads;
+
+				for (std::size_t n = 0; n < count; n++) {
+					const std::pair<seq_count_type, seq_count_type> &pair = pairs[t + num_threads * (t % 2 == 0 ? n : count - 1 - n)];
+
+					sets.unite(pair.first, pair.second);
+					sets.find(lookups() % num_elements);
+				}
+			});
+		}
+
+		for (std::thread &thread : threads) {
+			thread.join();
+		}
+
+		std::vector<seq_count_type> expected = sequential_sets(pairs);
+
+		for (seq_count_type x = 0; x < num_elements; x++) {
+			if (sets.find(x) != expected[x]) {
+				std::fprintf(
+					stderr,
+					"round %u: element %lu is in the set of %lu instead of %lu\n",
+					round,
+					static_cast<unsigned long>(x),
+					static_cast<unsigned long>(sets.find(x)),
+					static_cast<unsigned long>(expected[x])
+				);
+				return EXIT_FAILURE;
+			}
+		}
+	}
+
+	std::printf("union-find check passed (%u threads, %u rounds)\n", num_threads, num_rounds);
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,344 @@
+//
+// text_input.cc
+//
+// Parallel parser of the text input format
+//
+// Created on 18/10/2026
+//
+
+#include <charconv>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <exception>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <cstdint>
+
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "text_input.hh"
+
+
+// Chunks are at least this large; they end at the next whitespace
+static const std::size_t chunk_size = 1 << 20;
+
+static bool is_space(char c)
+{
+	return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+TextInput::TextInput(int fd) : data_(nullptr), size_(0), mapped_(false)
+{
+	struct stat st;
+
+	if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+		void *addr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+		if (addr != MAP_FAILED) {
+			madvise(addr, st.st_size, MADV_SEQUENTIAL);
+			data_ = static_cast<const char *>(addr);
+			size_ = st.st_size;
+			mapped_ = true;
+			return;
+		}
+	}
+
+	// not mappable: read it all
+	for (;;) {
+		std::size_t old_size = buf_.size();
+		buf_.resize(std::max<std::size_t>(old_size * 2, chunk_size));
+
+		ssize_t count = read(fd, buf_.data() + old_size, buf_.size() - old_size);
+
+		if (count < 0 && errno == EINTR) {
+			buf_.resize(old_size);
+			continue;
+		}
+
+		if (count < 0) {
+			throw std::runtime_error(std::string("can't read input: ") + std::strerror(errno));
+		}
+
+		buf_.resize(old_size + count);
+
+		if (count == 0) {
+			break;
+		}
+	}
+
+	data_ = buf_.data();
+	size_ = buf_.size();
+}
+
+TextInput::~TextInput()
+{
+	if (mapped_) {
+		munmap(const_cast<char *>(data_), size_);
+	}
+}
+
+ParseError::ParseError(std::size_t offset, const std::string &what) :
+	std::runtime_error("at byte " + std::to_string(offset) + ": " + what),
+	offset_(offset)
+{
+}
+
+// Parses the integer token at text[begin, end) into 'value'.
+// Returns an error message, or nullptr on success.
+template<typename T>
+static const char *parse_token(const char *begin, const char *end, T &value)
+{
+	std::from_chars_result result = std::from_chars(begin, end, value);
+
+	if (result.ec == std::errc::result_out_of_range) {
+		return "number out of range";
+	}
+
+	if (result.ec != std::errc() || result.ptr != end) {
+		return "malformed number";
+	}
+
+	return nullptr;
+}
+
+std::vector<index_type> parse_text_header(const char *text, std::size_t size, std::size_t &data_offset)
+{
+	const char *end = text + size;
+
+	// throw away explicit number of sequences
+	const char *line = std::find(text, end, '\n');
+
+	if (line == end) {
+		throw ParseError(size, "missing line of sequence lengths");
+	}
+
+	const char *ptr = line + 1;
+	const char *line_end = std::find(ptr, end, '\n');
+	std::vector<index_type> lengths;
+
+	for (;;) {
+		while (ptr < line_end && is_space(*ptr)) {
+			ptr++;
+		}
+
+		if (ptr == line_end) {
+			break;
+		}
+
+		const char *token_end = std::find_if(ptr, line_end, is_space);
+		index_type length = 0;
+		const char *error = parse_token(ptr, token_end, length);
+
+		if (error == nullptr && length < 0) {
+			error = "negative sequence length";
+		}
+
+		if (error != nullptr) {
+			throw ParseError(ptr - text, error);
+		}
+
+		if (length > MAX_SEQ_SIZE) {
+			throw ParseError(ptr - text, "sequence length " + std::to_string(length) + " is out of range [0, " + std::to_string(MAX_SEQ_SIZE) + "]");
+		}
+
+		lengths.push_back(length);
+		ptr = token_end;
+	}
+
+	data_offset = line_end - text;
+
+	return lengths;
+}
+
+namespace {
+
+// Angles of one chunk, before they are known to belong to which sequences
+struct Chunk {
+	std::vector<angle_type> values;
+	std::size_t error_offset = 0;   // of the token after 'values', if that's malformed
+	const char *error = nullptr;    // nullptr if the whole chunk is fine
+	bool parsed = false;
+};
+
+}
+
+static void parse_chunk(const char *text, std::size_t begin, std::size_t end, Chunk &chunk)
+{
+	const char *ptr = text + begin;
+	const char *chunk_end = text + end;
+
+	// about the shortest possible token, plus a separator
+	chunk.values.resize((end - begin) / 2 + 1);
+
+	angle_type *out = chunk.values.data();
+
+	for (;;) {
+		while (ptr < chunk_end && is_space(*ptr)) {
+			ptr++;
+		}
+
+		if (ptr == chunk_end) {
+			break;
+		}
+
+		// a token must end at whitespace, or at the end of the chunk
+		std::from_chars_result result = std::from_chars(ptr, chunk_end, *out);
+
+		if (result.ec != std::errc() || (result.ptr < chunk_end && !is_space(*result.ptr))) {
+			// only an error if the token is part of the sequence data,
+			// which turns out only when the chunk is placed
+			chunk.error = result.ec == std::errc::result_out_of_range ? "number out of range" : "malformed number";
+			chunk.error_offset = ptr - text;
+			break;
+		}
+
+		out++;
+		ptr = result.ptr;
+	}
+
+	chunk.values.resize(out - chunk.values.data());
+}
+
+void parse_text_angles(
+	const char *text,
+	std::size_t data_offset,
+	std::size_t size,
+	SequenceStore &seqs,
+	unsigned num_threads,
+	const std::function<void(seq_count_type)> &progress
+)
+{
+	const seq_count_type num_seqs = seqs.size();
+
+	// Chunk #c is text[bounds[c], bounds[c + 1]); every bound but the
+	// first one and the last one is a whitespace character
+	std::vector<std::size_t> bounds(1, data_offset);
+
+	while (bounds.back() < size) {
+		std::size_t end = std::min(bounds.back() + chunk_size, size);
+
+		while (end < size && !is_space(text[end])) {
+			end++;
+		}
+
+		bounds.push_back(end);
+	}
+
+	const std::size_t num_chunks = bounds.size() - 1;
+	std::vector<Chunk> chunks(num_chunks);
+
+	// Parsed chunks are placed in order, under 'place_mutex': their values
+	// are copied into the sequences, from residue #next_residue of
+	// sequence #next_seq on, phi and psi alternating.
+	std::mutex place_mutex;
+	std::size_t num_placed = 0;
+	seq_count_type next_seq = 0;
+	index_type next_residue = 0;
+	bool next_is_psi = false;
+	seq_count_type num_reported = 0;
+
+	std::atomic<std::size_t> next_chunk(0);
+	std::atomic<bool> failed(false);
+	std::exception_ptr error;
+
+	// move on from complete sequences, including empty ones
+	auto skip_complete = [&]() {
+		while (next_seq < num_seqs && next_residue == seqs.lengths()[next_seq]) {
+			next_seq++;
+			next_residue = 0;
+		}
+	};
+
+	auto report = [&]() {
+		if (next_seq > num_reported) {
+			num_reported = next_seq;
+			progress(num_reported);
+		}
+	};
+
+	auto place = [&](const Chunk &chunk) {
+		for (angle_type value : chunk.values) {
+			skip_complete();
+
+			if (next_seq == num_seqs) {
+				return;
+			}
+
+			if (next_is_psi) {
+				seqs.psi(next_seq)[next_residue++] = value;
+			} else {
+				seqs.phi(next_seq)[next_residue] = value;
+			}
+
+			next_is_psi = !next_is_psi;
+		}
+
+		skip_complete();
+
+		if (chunk.error != nullptr && next_seq < num_seqs) {
+			throw ParseError(chunk.error_offset, chunk.error);
+		}
+	};
+
+	auto worker = [&]() {
+		try {
+			for (;;) {
+				std::size_t c = next_chunk.fetch_add(1);
+
+				if (c >= num_chunks || failed.load()) {
+					return;
+				}
+
+				parse_chunk(text, bounds[c], bounds[c + 1], chunks[c]);
+
+				std::lock_guard<std::mutex> lock(place_mutex);
+				chunks[c].parsed = true;
+
+				// place every chunk that can be placed now
+				while (num_placed < num_chunks && chunks[num_placed].parsed) {
+					place(chunks[num_placed]);
+					std::vector<angle_type>().swap(chunks[num_placed].values);
+					num_placed++;
+				}
+
+				report();
+			}
+		} catch (...) {
+			std::lock_guard<std::mutex> lock(place_mutex);
+
+			if (!failed.exchange(true)) {
+				error = std::current_exception();
+			}
+		}
+	};
+
+	std::vector<std::thread> threads;
+
+	for (unsigned t = 1; t < std::max(num_threads, 1u); t++) {
+		threads.emplace_back(worker);
+	}
+
+	worker();
+
+	for (std::thread &thread : threads) {
+		thread.join();
+	}
+
+	if (error) {
+		std::rethrow_exception(error);
+	}
+
+	// trailing empty sequences need no data
+	skip_complete();
+
+	if (next_seq < num_seqs) {
+		throw ParseError(size, "unexpected end of sequence data");
+	}
+
+	report();
+}
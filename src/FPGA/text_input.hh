@@ -0,0 +1,74 @@
+//
+// text_input.hh
+//
+// Parallel parser of the text input format
+//
+// Created on 18/10/2026
+//
+
+#ifndef SWPARA_TEXT_INPUT_HH
+#define SWPARA_TEXT_INPUT_HH
+
+#include <vector>
+#include <string>
+#include <functional>
+#include <stdexcept>
+#include <cstddef>
+
+#include "align.hh"
+#include "seq_store.hh"
+
+
+// The whole text input in memory: memory-mapped if 'fd' is a regular
+// file, read into a buffer otherwise (e.g. if it's a pipe).
+class TextInput {
+public:
+	explicit TextInput(int fd);
+	~TextInput();
+
+	TextInput(const TextInput &) = delete;
+	TextInput &operator=(const TextInput &) = delete;
+
+	const char *data() const { return data_; }
+	std::size_t size() const { return size_; }
+
+private:
+	const char *data_;
+	std::size_t size_;
+	bool mapped_;
+	std::vector<char> buf_;
+};
+
+// Malformed input, at byte 'offset' of the text
+class ParseError : public std::runtime_error {
+public:
+	ParseError(std::size_t offset, const std::string &what);
+
+	std::size_t offset() const { return offset_; }
+
+private:
+	std::size_t offset_;
+};
+
+// Text input: number of sequences (ignored), then the lengths on one line,
+// then whitespace-separated (phi, psi) pairs of all sequences; anything
+// after the last pair is ignored. Returns the lengths, and sets 'data_offset'
+// to the byte offset of the angles. Throws ParseError at the offending token
+// if a length is malformed, or out of the range [0, MAX_SEQ_SIZE] of align().
+std::vector<index_type> parse_text_header(const char *text, std::size_t size, std::size_t &data_offset);
+
+// Parses the angles of text[data_offset, size) into 'seqs', which must already
+// hold every sequence (e.g. zero-filled by SequenceStore::append()).
+// The text is cut into chunks at whitespace, and the chunks are parsed by
+// 'num_threads' threads with std::from_chars(). Whenever sequences [0, n)
+// are complete, progress(n) is called; calls are serialized, and n increases.
+void parse_text_angles(
+	const char *text,
+	std::size_t data_offset,
+	std::size_t size,
+	SequenceStore &seqs,
+	unsigned num_threads,
+	const std::function<void(seq_count_type)> &progress
+);
+
+#endif // SWPARA_TEXT_INPUT_HH
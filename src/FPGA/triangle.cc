@@ -0,0 +1,75 @@
+//
+// triangle.cc
+//
+// Work accounting over the upper triangle of the all-vs-all score matrix
+//
+// Created on 18/10/2026
+//
+
+#include <algorithm>
+
+#include "triangle.hh"
+
+
+std::vector<std::uint64_t> cumulative_row_cells(const std::vector<index_type> &lengths)
+{
+	seq_count_type num_rows = lengths.empty() ? 0 : lengths.size() - 1;
+	std::vector<std::uint64_t> cumulative(num_rows + 1, 0);
+	std::uint64_t len_hor = 0;
+
+	for (index_type length : lengths) {
+		len_hor += length;
+	}
+
+	for (seq_count_type i = 0; i < num_rows; i++) {
+		len_hor -= lengths[i];
+		cumulative[i + 1] = cumulative[i] + lengths[i] * len_hor;
+	}
+
+	return cumulative;
+}
+
+// First row at which the cumulative cell count reaches k/count of the total
+static seq_count_type shard_boundary(const std::vector<std::uint64_t> &cumulative, std::uint64_t k, std::uint64_t count)
+{
+	std::uint64_t total = cumulative.back();
+
+	// k * total / count, without overflowing
+	std::uint64_t target = k * (total / count) + k * (total % count) / count;
+
+	return std::lower_bound(cumulative.begin(), cumulative.end(), target) - cumulative.begin();
+}
+
+RowRange shard_rows(const std::vector<index_type> &lengths, seq_count_type shard_index, seq_count_type shard_count)
+{
+	std::vector<std::uint64_t> cumulative = cumulative_row_cells(lengths);
+	seq_count_type num_rows = cumulative.size() - 1;
+
+	RowRange range;
+	range.begin = shard_index == 0 ? 0 : shard_boundary(cumulative, shard_index, shard_count);
+	range.end = shard_index + 1 == shard_count ? num_rows : shard_boundary(cumulative, shard_index + 1, shard_count);
+	range.end = std::max(range.begin, range.end);
+
+	return range;
+}
+
+std::vector<RowRange> split_rows(const std::vector<std::uint64_t> &cumulative, const std::vector<unsigned> &weights)
+{
+	seq_count_type num_rows = cumulative.size() - 1;
+	std::vector<RowRange> ranges(weights.size());
+	std::uint64_t total_weight = 0;
+	std::uint64_t weight_before = 0;
+
+	for (unsigned weight : weights) {
+		total_weight += weight;
+	}
+
+	for (std::size_t k = 0; k < weights.size(); k++) {
+		ranges[k].begin = k == 0 ? 0 : ranges[k - 1].end;
+		weight_before += weights[k];
+		ranges[k].end = k + 1 == weights.size() ? num_rows : shard_boundary(cumulative, weight_before, total_weight);
+		ranges[k].end = std::max(ranges[k].begin, ranges[k].end);
+	}
+
+	return ranges;
+}
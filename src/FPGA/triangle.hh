@@ -0,0 +1,39 @@
+//
+// triangle.hh
+//
+// Work accounting over the upper triangle of the all-vs-all score matrix
+//
+// Created on 18/10/2026
+//
+
+#ifndef SWPARA_TRIANGLE_HH
+#define SWPARA_TRIANGLE_HH
+
+#include <vector>
+#include <cstdint>
+
+#include "align.hh"
+
+
+// Rows [begin, end) of the triangle. Row #i holds the scores of
+// sequence #i against sequences #i+1...n-1, so there are n - 1 rows.
+struct RowRange {
+	seq_count_type begin;
+	seq_count_type end;
+};
+
+// Number of dynamic programming cells in the rows, as a prefix sum:
+// rows [0, i) have 'result[i]' cells, so 'result' has n elements.
+std::vector<std::uint64_t> cumulative_row_cells(const std::vector<index_type> &lengths);
+
+// The contiguous slice of rows assigned to shard #'shard_index' out of
+// 'shard_count', such that every shard has about the same number of cells.
+// Rows are never split; shards are in row order and cover the triangle.
+RowRange shard_rows(const std::vector<index_type> &lengths, seq_count_type shard_index, seq_count_type shard_count);
+
+// Rows [0, cumulative.size() - 1) split into contiguous ranges, range #k
+// having a share of the cells in proportion to 'weights[k]'; 'cumulative'
+// is a prefix sum of cells as above. Ranges are in row order.
+std::vector<RowRange> split_rows(const std::vector<std::uint64_t> &cumulative, const std::vector<unsigned> &weights);
+
+#endif // SWPARA_TRIANGLE_HH
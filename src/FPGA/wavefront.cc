@@ -0,0 +1,206 @@
+//
+// wavefront.cc
+//
+// Multithreaded Smith-Waterman score of a single, very long pair
+//
+// Created on 18/10/2026
+//
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <algorithm>
+#include <cstdint>
+
+#include "wavefront.hh"
+#include "scoring.hh"
+
+
+// The kernel computes in score_type, so overflow must wrap the same way
+static score_type wrap(std::int64_t x)
+{
+	return static_cast<score_type>(static_cast<std::uint32_t>(x));
+}
+
+// Threads wait here for each other after every anti-diagonal of tiles
+class Barrier {
+public:
+	explicit Barrier(unsigned count) : count_(count), waiting_(0), generation_(0) {}
+
+	void wait()
+	{
+		std::unique_lock<std::mutex> lock(mutex_);
+		unsigned generation = generation_;
+
+		if (++waiting_ == count_) {
+			waiting_ = 0;
+			generation_++;
+			cond_.notify_all();
+		} else {
+			cond_.wait(lock, [&] { return generation != generation_; });
+		}
+	}
+
+private:
+	std::mutex mutex_;
+	std::condition_variable cond_;
+	unsigned count_;
+	unsigned waiting_;
+	unsigned generation_;
+};
+
+// Boundaries between tiles, with 1-based row and column indices
+// (row 0 and column 0 being the zero border of the matrix)
+struct Boundaries {
+	// last row computed so far in every column, i.e. the bottom rows
+	// of the tiles of the latest anti-diagonal
+	std::vector<score_type> row;
+	// last column computed so far in every row
+	std::vector<score_type> col;
+	// corners[ti]: the cell diagonally above and left of the next tile in
+	// tile row #ti. Its tile to the left saves it before overwriting 'row'.
+	std::vector<score_type> corners;
+};
+
+template<typename ScoringPolicy>
+static score_type compute_tile(
+	SeqView seq_ver,
+	SeqView seq_hor,
+	score_type scoring_offset,
+	score_type gap_penalty,
+	std::size_t tile_size,
+	std::size_t ti,
+	std::size_t tj,
+	Boundaries &bounds,
+	std::vector<score_type> &prev,
+	std::vector<score_type> &cur
+)
+{
+	const std::size_t r0 = ti * tile_size, r1 = std::min<std::size_t>(r0 + tile_size, seq_ver.length);
+	const std::size_t c0 = tj * tile_size, c1 = std::min<std::size_t>(c0 + tile_size, seq_hor.length);
+	const std::size_t width = c1 - c0;
+
+	score_type max_score = 0;
+
+	// prev[k]: cell (r - 1, c0 + k); cur[k]: cell (r, c0 + k)
+	// (r0, c0) belongs to the tile column to the left, which may already
+	// be overwriting it on the current anti-diagonal, hence the corners
+	prev.resize(width + 1);
+	cur.resize(width + 1);
+
+	prev[0] = tj == 0 ? 0 : bounds.corners[ti];
+	std::copy(bounds.row.begin() + c0 + 1, bounds.row.begin() + c1 + 1, prev.begin() + 1);
+	bounds.corners[ti] = prev[width];
+
+	for (std::size_t r = r0 + 1; r <= r1; r++) {
+		Dihedral d_ver = seq_ver[r - 1];
+
+		cur[0] = bounds.col[r];
+
+		for (std::size_t k = 1; k <= width; k++) {
+			score_type cell = std::max({
+				wrap(std::int64_t(cur[k - 1]) + gap_penalty),
+				wrap(std::int64_t(prev[k]) + gap_penalty),
+				wrap(std::int64_t(prev[k - 1]) + ScoringPolicy::score(d_ver, seq_hor[c0 + k - 1], scoring_offset)),
+				score_type(0)
+			});
+
+			cur[k] = cell;
+			max_score = std::max(max_score, cell);
+		}
+
+		bounds.col[r] = cur[width];
+		std::swap(prev, cur);
+	}
+
+	std::copy(prev.begin() + 1, prev.end(), bounds.row.begin() + c0 + 1);
+
+	return max_score;
+}
+
+template<typename ScoringPolicy>
+score_type wavefront_score(
+	SeqView seq_ver,
+	SeqView seq_hor,
+	score_type scoring_offset,
+	score_type gap_penalty,
+	unsigned num_threads,
+	std::size_t tile_size
+)
+{
+	if (seq_ver.length <= 0 || seq_hor.length <= 0) {
+		return 0;
+	}
+
+	tile_size = std::max<std::size_t>(tile_size, 1);
+
+	const std::size_t tile_rows = (seq_ver.length + tile_size - 1) / tile_size;
+	const std::size_t tile_cols = (seq_hor.length + tile_size - 1) / tile_size;
+	const std::size_t num_diags = tile_rows + tile_cols - 1;
+
+	// no anti-diagonal has more tiles than this
+	num_threads = std::max(1u, std::min<unsigned>(num_threads, std::min(tile_rows, tile_cols)));
+
+	Boundaries bounds;
+	bounds.row.assign(seq_hor.length + 1, 0);
+	bounds.col.assign(seq_ver.length + 1, 0);
+	bounds.corners.assign(tile_rows, 0);
+
+	std::vector<score_type> max_scores(num_threads, 0);
+	Barrier barrier(num_threads);
+
+	// Thread #t computes every num_threads-th tile of each anti-diagonal
+	auto worker = [&](unsigned t) {
+		std::vector<score_type> prev, cur;
+		score_type max_score = 0;
+
+		for (std::size_t d = 0; d < num_diags; d++) {
+			std::size_t ti_begin = d < tile_cols ? 0 : d - tile_cols + 1;
+			std::size_t ti_end = std::min(d + 1, tile_rows);
+
+			for (std::size_t ti = ti_begin + t; ti < ti_end; ti += num_threads) {
+				score_type tile_max = compute_tile<ScoringPolicy>(
+					seq_ver,
+					seq_hor,
+					scoring_offset,
+					gap_penalty,
+					tile_size,
+					ti,
+					d - ti,
+					bounds,
+					prev,
+					cur
+				);
+
+				max_score = std::max(max_score, tile_max);
+			}
+
+			barrier.wait();
+		}
+
+		max_scores[t] = max_score;
+	};
+
+	std::vector<std::thread> threads;
+
+	for (unsigned t = 1; t < num_threads; t++) {
+		threads.emplace_back(worker, t);
+	}
+
+	worker(0);
+
+	for (std::thread &thread : threads) {
+		thread.join();
+	}
+
+	return *std::max_element(max_scores.begin(), max_scores.end());
+}
+
+#define INSTANTIATE_WAVEFRONT_SCORE(policy) \
+	template score_type wavefront_score<policy>(SeqView, SeqView, score_type, score_type, unsigned, std::size_t)
+
+INSTANTIATE_WAVEFRONT_SCORE(SquaredDistanceScore);
+INSTANTIATE_WAVEFRONT_SCORE(PhiWeightedScore);
+INSTANTIATE_WAVEFRONT_SCORE(CosineScore);
+INSTANTIATE_WAVEFRONT_SCORE(TableScore);
@@ -0,0 +1,36 @@
+//
+// wavefront.hh
+//
+// Multithreaded Smith-Waterman score of a single, very long pair
+//
+// Created on 18/10/2026
+//
+
+#ifndef SWPARA_WAVEFRONT_HH
+#define SWPARA_WAVEFRONT_HH
+
+#include <cstddef>
+
+#include "align.hh"
+#include "seq_store.hh"
+
+
+// Default edge length of a tile, in residues
+#define WAVEFRONT_TILE_SIZE 64
+
+// The matrix is cut into tile_size x tile_size tiles, and the tiles of each
+// anti-diagonal are computed concurrently on 'num_threads' threads. Much like
+// hor_prop_buf between the windows of align_one(), a tile hands its bottom
+// row and right column to the tiles below and to the right of it.
+// Instantiated for every scoring policy of scoring.hh.
+template<typename ScoringPolicy>
+score_type wavefront_score(
+	SeqView seq_ver,
+	SeqView seq_hor,
+	score_type scoring_offset,
+	score_type gap_penalty,
+	unsigned num_threads,
+	std::size_t tile_size = WAVEFRONT_TILE_SIZE
+);
+
+#endif // SWPARA_WAVEFRONT_HH